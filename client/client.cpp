@@ -116,7 +116,7 @@ void Client::socketDisconnected()
 
 void Client::messageReceived(const Message &msg)
 {
-    m_statModel->addMessage(msg.address(), msg.type(), msg.size());
+    m_statModel->addMessage(msg.address(), msg.type(), msg.size(), msg.transferSize());
     // server version must be the very first message we get
     if (!(m_initState & VersionChecked)) {
         if (msg.address() != endpointAddress() || msg.type() != Protocol::ServerVersion) {
@@ -196,6 +196,8 @@ void Client::messageReceived(const Message &msg)
             quint8 version;
             msg >> version;
             Message::setNegotiatedDataVersion(version);
+            setMessageBatchingEnabled(true);
+            setStreamCompressionEnabled(true);
 
             m_initState |= ServerDataVersionNegotiated;
             break;
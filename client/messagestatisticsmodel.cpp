@@ -65,7 +65,8 @@ static const MetaEnum::Value<Protocol::MessageType> message_type_table[] = {
     M(ServerInfo),
     M(ProbeSettings),
     M(ServerAddress),
-    M(ServerLaunchError)
+    M(ServerLaunchError),
+    M(MessageBatch)
 };
 #undef M
 Q_STATIC_ASSERT(Protocol::MESSAGE_TYPE_COUNT - 1 == (sizeof(message_type_table) / sizeof(MetaEnum::Value<Protocol::MessageType>)));
@@ -74,6 +75,15 @@ MessageStatisticsModel::Info::Info()
 {
     messageCount.resize(Protocol::MESSAGE_TYPE_COUNT);
     messageSize.resize(Protocol::MESSAGE_TYPE_COUNT);
+    compressibleSize.resize(Protocol::MESSAGE_TYPE_COUNT);
+    transferSize.resize(Protocol::MESSAGE_TYPE_COUNT);
+}
+
+static QString compressionRatio(quint64 compressibleSize, quint64 transferSize)
+{
+    if (compressibleSize == 0)
+        return MessageStatisticsModel::tr("n/a");
+    return MessageStatisticsModel::tr("%1%").arg(100.0 * ( double )transferSize / ( double )compressibleSize, 0, 'f', 1);
 }
 
 int MessageStatisticsModel::Info::totalCount() const
@@ -118,7 +128,7 @@ void MessageStatisticsModel::addObject(Protocol::ObjectAddress addr, const QStri
     }
 }
 
-void MessageStatisticsModel::addMessage(Protocol::ObjectAddress addr, Protocol::MessageType msgType, int size)
+void MessageStatisticsModel::addMessage(Protocol::ObjectAddress addr, Protocol::MessageType msgType, int size, int transferSize)
 {
     addr -= 1;
     msgType -= 1;
@@ -126,17 +136,24 @@ void MessageStatisticsModel::addMessage(Protocol::ObjectAddress addr, Protocol::
     ++m_totalCount;
     m_totalSize += size;
 
-    if (addr < m_data.size()) {
-        m_data[addr].messageCount[msgType]++;
-        m_data[addr].messageSize[msgType] += size;
-        emit dataChanged(index(addr, msgType + 1), index(addr, msgType + 1));
-    } else {
+    const bool newRow = addr >= m_data.size();
+    if (newRow) {
         beginInsertRows(QModelIndex(), m_data.size(), addr);
         m_data.resize(addr + 1);
-        m_data[addr].messageCount[msgType] = 1;
-        m_data[addr].messageSize[msgType] = size;
-        endInsertRows();
     }
+
+    auto &info = m_data[addr];
+    info.messageCount[msgType]++;
+    info.messageSize[msgType] += size;
+    if (transferSize >= 0) {
+        info.compressibleSize[msgType] += size;
+        info.transferSize[msgType] += transferSize;
+    }
+
+    if (newRow)
+        endInsertRows();
+    else
+        emit dataChanged(index(addr, msgType + 1), index(addr, msgType + 1));
 }
 
 int MessageStatisticsModel::columnCount(const QModelIndex &parent) const
@@ -193,7 +210,7 @@ QVariant MessageStatisticsModel::data(const QModelIndex &index, int role) const
 
     if (role == Qt::ToolTipRole) {
         return tr( // clazy:exclude=qstring-arg
-                   "Object: %1\nMessage Type: %2\nMessage Count: %3 of %4 (%5%)\nMessage Size: %6 of %7 (%8%)")
+                   "Object: %1\nMessage Type: %2\nMessage Count: %3 of %4 (%5%)\nMessage Size: %6 of %7 (%8%)\nCompression Ratio: %9")
             .arg(info.name) // clazy:exclude=qstring-arg
             .arg(MetaEnum::enumToString(static_cast<Protocol::MessageType>(index.column() + 1), message_type_table))
             .arg(info.messageCount[msgType])
@@ -201,7 +218,8 @@ QVariant MessageStatisticsModel::data(const QModelIndex &index, int role) const
             .arg(100.0 * ( double )info.messageCount[msgType] / ( double )m_totalCount, 0, 'f', 2)
             .arg(info.messageSize[msgType])
             .arg(m_totalSize)
-            .arg(100.0 * ( double )info.messageSize[msgType] / ( double )m_totalSize, 0, 'f', 2);
+            .arg(100.0 * ( double )info.messageSize[msgType] / ( double )m_totalSize, 0, 'f', 2)
+            .arg(compressionRatio(info.compressibleSize[msgType], info.transferSize[msgType]));
     }
 
     return QVariant();
@@ -225,7 +243,7 @@ QVariant MessageStatisticsModel::headerData(int section, Qt::Orientation orienta
         if (role == Qt::ToolTipRole) {
             const auto count = countPerType(section);
             const auto size = sizePerType(section);
-            return tr("Message Count: %1 of %2 (%3%)\nMessage Size: %4 of %5 (%6%)").arg(count).arg(m_totalCount).arg(100.0 * ( double )count / ( double )m_totalCount, 0, 'f', 2).arg(size).arg(m_totalSize).arg(100.0 * ( double )size / ( double )m_totalSize, 0, 'f', 2);
+            return tr("Message Count: %1 of %2 (%3%)\nMessage Size: %4 of %5 (%6%)\nCompression Ratio: %7").arg(count).arg(m_totalCount).arg(100.0 * ( double )count / ( double )m_totalCount, 0, 'f', 2).arg(size).arg(m_totalSize).arg(100.0 * ( double )size / ( double )m_totalSize, 0, 'f', 2).arg(compressionRatioPerType(section));
         }
     } else if (orientation == Qt::Vertical) {
         const auto &info = m_data.at(section);
@@ -267,3 +285,14 @@ quint64 MessageStatisticsModel::sizePerType(int msgType) const
     }
     return c;
 }
+
+QString MessageStatisticsModel::compressionRatioPerType(int msgType) const
+{
+    quint64 compressible = 0;
+    quint64 transferred = 0;
+    for (const auto &info : m_data) {
+        compressible += info.compressibleSize.at(msgType);
+        transferred += info.transferSize.at(msgType);
+    }
+    return compressionRatio(compressible, transferred);
+}
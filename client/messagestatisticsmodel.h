@@ -31,7 +31,8 @@ public:
 
     void clear();
     void addObject(Protocol::ObjectAddress addr, const QString &name);
-    void addMessage(Protocol::ObjectAddress addr, Protocol::MessageType msgType, int size);
+    /*! @p transferSize is the size on the wire, after compression, or -1 if unknown. */
+    void addMessage(Protocol::ObjectAddress addr, Protocol::MessageType msgType, int size, int transferSize = -1);
 
     int columnCount(const QModelIndex &parent) const override;
     int rowCount(const QModelIndex &parent) const override;
@@ -41,6 +42,7 @@ public:
 private:
     int countPerType(int msgType) const;
     quint64 sizePerType(int msgType) const;
+    QString compressionRatioPerType(int msgType) const;
 
     struct Info
     {
@@ -51,6 +53,9 @@ private:
         QString name;
         QVector<int> messageCount;
         QVector<quint64> messageSize;
+        // uncompressed and transfer size of the messages we know the transfer size of
+        QVector<quint64> compressibleSize;
+        QVector<quint64> transferSize;
     };
     QVector<Info> m_data;
     int m_totalCount;
@@ -34,18 +34,27 @@ void (*RemoteModel::s_registerClientCallback)() = nullptr;
 RemoteModel::Node::~Node()
 {
     qDeleteAll(children);
+    if (usageList)
+        usageList->remove(this);
 }
 
 void RemoteModel::Node::clearChildrenData()
 {
     foreach (auto child, children) {
         child->clearChildrenStructure();
-        child->data.clear();
-        child->flags.clear();
-        child->state.clear();
+        child->clearColumnData();
     }
 }
 
+void RemoteModel::Node::clearColumnData()
+{
+    if (usageList)
+        usageList->remove(this);
+    data.clear();
+    flags.clear();
+    state.clear();
+}
+
 void RemoteModel::Node::clearChildrenStructure()
 {
     qDeleteAll(children);
@@ -75,12 +84,51 @@ bool RemoteModel::Node::hasColumnData() const
     return data.size() == parent->columnCount && parent->columnCount > 0;
 }
 
+RemoteModel::UsageList::UsageList()
+{
+    head.prevUsed = &head;
+    head.nextUsed = &head;
+}
+
+void RemoteModel::UsageList::touch(Node *node)
+{
+    if (node->usageList) {
+        Q_ASSERT(node->usageList == this);
+        if (head.nextUsed == node)
+            return;
+        node->prevUsed->nextUsed = node->nextUsed;
+        node->nextUsed->prevUsed = node->prevUsed;
+    } else {
+        node->usageList = this;
+        ++size;
+    }
+    node->prevUsed = &head;
+    node->nextUsed = head.nextUsed;
+    head.nextUsed->prevUsed = node;
+    head.nextUsed = node;
+}
+
+void RemoteModel::UsageList::remove(Node *node)
+{
+    Q_ASSERT(node->usageList == this);
+    node->prevUsed->nextUsed = node->nextUsed;
+    node->nextUsed->prevUsed = node->prevUsed;
+    node->prevUsed = nullptr;
+    node->nextUsed = nullptr;
+    node->usageList = nullptr;
+    --size;
+}
+
 QVariant RemoteModel::s_emptyDisplayValue;
 QVariant RemoteModel::s_emptySizeHintValue;
 
 RemoteModel::RemoteModel(const QString &serverObject, QObject *parent)
     : QAbstractItemModel(parent)
     , m_pendingRequestsTimer(new QTimer(this))
+    , m_cacheCapacity(qEnvironmentVariableIsSet("GAMMARAY_REMOTE_MODEL_CACHE_SIZE") ? qEnvironmentVariableIntValue("GAMMARAY_REMOTE_MODEL_CACHE_SIZE") : 10000)
+    , m_prefetchRows(64)
+    , m_lastRequestFirst(-1)
+    , m_lastRequestLast(-1)
     , m_serverObject(serverObject)
     , m_myAddress(Protocol::InvalidObjectAddress)
     , m_currentSyncBarrier(0)
@@ -186,6 +234,8 @@ QVariant RemoteModel::data(const QModelIndex &index, int role) const
     const auto state = stateForColumn(node, index.column());
     if (role == RemoteModelRole::LoadingState)
         return QVariant::fromValue(state);
+    if (node->usageList)
+        m_usedRows.touch(node);
 
     // for size hint we don't want to trigger loading, as that's largely used for item view layouting
     if (state & RemoteModelNodeState::Empty) {
@@ -242,8 +292,10 @@ QVariant RemoteModel::requestCreationDeclarationLocation(const QModelIndex &inde
 
     disconnect(conn);
     auto node = nodeForIndex(index);
-    node->data[0].insert(ObjectModel::DeclarationLocationRole, declarationLoc);
-    node->data[0].insert(ObjectModel::CreationLocationRole, creationLoc);
+    if (node->hasColumnData()) { // might have been evicted meanwhile
+        node->data[0].insert(ObjectModel::DeclarationLocationRole, declarationLoc);
+        node->data[0].insert(ObjectModel::CreationLocationRole, creationLoc);
+    }
 
     if (role == ObjectModel::CreationLocationRole)
         return creationLoc;
@@ -295,6 +347,66 @@ QVariant RemoteModel::headerData(int section, Qt::Orientation orientation, int r
     return headers.at(section).value(role);
 }
 
+int RemoteModel::cacheCapacity() const
+{
+    return m_cacheCapacity;
+}
+
+void RemoteModel::setCacheCapacity(int rows)
+{
+    m_cacheCapacity = rows;
+    evictRows();
+}
+
+int RemoteModel::prefetchRows() const
+{
+    return m_prefetchRows;
+}
+
+void RemoteModel::setPrefetchRows(int rows)
+{
+    m_prefetchRows = rows;
+}
+
+QVector<QVector<int>> RemoteModel::requestedRoles() const
+{
+    return m_requestedRoles;
+}
+
+// returns whether content fetched for @p have contains everything needed for @p want
+static bool containsRoles(const QVector<int> &have, const QVector<int> &want)
+{
+    if (have.isEmpty())
+        return true;
+    if (want.isEmpty())
+        return false;
+    return std::includes(have.begin(), have.end(), want.begin(), want.end());
+}
+
+void RemoteModel::setRequestedRoles(const QVector<QVector<int>> &roles)
+{
+    auto newRoles = roles;
+    for (auto &columnRoles : newRoles) {
+        std::sort(columnRoles.begin(), columnRoles.end());
+        columnRoles.erase(std::unique(columnRoles.begin(), columnRoles.end()), columnRoles.end());
+    }
+    if (newRoles == m_requestedRoles)
+        return;
+
+    // narrowing down the roles doesn't invalidate what we have already
+    bool covered = true;
+    const auto columns = std::max(newRoles.size(), m_requestedRoles.size());
+    for (int column = 0; column < columns && covered; ++column) {
+        const auto have = m_requestedRoles.isEmpty() ? QVector<int>() : m_requestedRoles.value(column, m_requestedRoles.last());
+        const auto want = newRoles.isEmpty() ? QVector<int>() : newRoles.value(column, newRoles.last());
+        covered = containsRoles(have, want);
+    }
+
+    m_requestedRoles = std::move(newRoles);
+    if (!covered)
+        markOutdated(m_root);
+}
+
 void RemoteModel::sort(int column, Qt::SortOrder order)
 {
     Message msg(m_myAddress, Protocol::ModelSortRequest);
@@ -313,10 +425,12 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
         msg >> size;
         Q_ASSERT(size > 0);
 
+        Protocol::ModelIndexDecoder decoder;
         for (quint32 i = 0; i < size; ++i) {
             // We now need to read the complete entries because of the break -> continue change
-            Protocol::ModelIndex index;
-            msg >> index;
+            Protocol::RelativeModelIndex relativeIndex;
+            msg >> relativeIndex;
+            const auto index = decoder.decode(relativeIndex);
             qint32 rowCount, columnCount;
             msg >> rowCount >> columnCount;
 
@@ -374,43 +488,75 @@ void RemoteModel::newMessage(const GammaRay::Message &msg)
     }
 
     case Protocol::ModelContentReply: {
-        quint32 size;
-        msg >> size;
-        Q_ASSERT(size > 0);
+        quint32 groupCount;
+        msg >> groupCount;
+        Q_ASSERT(groupCount > 0);
 
         QHash<QModelIndex, QVector<QModelIndex>> dataChangedIndexes;
-        for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
-            msg >> index;
-            if (index.isEmpty()) {
-                Q_ASSERT(false);
-                qWarning() << "Unexpected empty index, probably some type failed to deserialize" << Q_FUNC_INFO;
-                continue;
+        Protocol::ModelIndexDecoder decoder;
+        for (quint32 group = 0; group < groupCount; ++group) {
+            // columnar layout: indexes, flags, and then the values of all cells per role
+            quint32 size;
+            msg >> size;
+            QVector<Node *> nodes(size, nullptr);
+            QVector<int> columns(size, -1);
+            for (quint32 i = 0; i < size; ++i) {
+                Protocol::RelativeModelIndex relativeIndex;
+                msg >> relativeIndex;
+                const auto index = decoder.decode(relativeIndex);
+                if (index.isEmpty()) {
+                    Q_ASSERT(false);
+                    qWarning() << "Unexpected empty index" << Q_FUNC_INFO;
+                    continue;
+                }
+                Node *node = nodeForIndex(index);
+                const auto column = index.last().column;
+                const auto state = node ? stateForColumn(node, column) : RemoteModelNodeState::NoState;
+                if ((state & RemoteModelNodeState::Loading) == 0)
+                    continue; // we didn't ask for this, probably outdated response for a moved cell
+                nodes[i] = node;
+                columns[i] = column;
             }
-            quint32 indexEndPos = msg.pos();
 
-            Node *node = nodeForIndex(index);
-            const auto column = index.last().column;
-            const auto state = node ? stateForColumn(node, column) : RemoteModelNodeState::NoState;
-            typedef QHash<int, QVariant> ItemData;
-            ItemData itemData;
-            qint32 flags;
-            // read item data
-            msg >> itemData;
-            // skip the marker and reset if itemData was invalid/unreadable
-            msg.findAndSkipCString(GammaRay::REMOTE_MODEL_MARKER, indexEndPos);
-            msg >> flags;
-            if ((state & RemoteModelNodeState::Loading) == 0)
-                continue; // we didn't ask for this, probably outdated response for a moved cell
-
-            if (node) {
+            QVector<qint32> flags(size);
+            for (quint32 i = 0; i < size; ++i)
+                msg >> flags[i];
+
+            QVector<QHash<int, QVariant>> itemData(size);
+            quint32 roleCount;
+            msg >> roleCount;
+            for (quint32 r = 0; r < roleCount; ++r) {
+                const quint32 roleStartPos = msg.pos();
+                qint32 role;
+                QVector<QVariant> values;
+                msg >> role >> values;
+                // skip the marker and reset if values were invalid/unreadable
+                msg.findAndSkipCString(GammaRay::REMOTE_MODEL_MARKER, roleStartPos);
+                if (values.size() != int(size)) {
+                    qWarning() << "Failed to deserialize values for role" << role << Q_FUNC_INFO;
+                    continue;
+                }
+                for (quint32 i = 0; i < size; ++i) {
+                    if (values.at(i).isValid())
+                        itemData[i].insert(role, std::move(values[i]));
+                }
+            }
+
+            for (quint32 i = 0; i < size; ++i) {
+                Node *node = nodes.at(i);
+                if (!node)
+                    continue;
+                const auto column = columns.at(i);
+                const auto state = stateForColumn(node, column);
+
                 node->allocateColumns();
                 Q_ASSERT(node->data.size() > column);
-                node->data[column] = std::move(itemData);
-                node->flags[column] = static_cast<Qt::ItemFlags>(flags);
-                node->state[column] = state & ~(RemoteModelNodeState::Loading | RemoteModelNodeState::Empty | RemoteModelNodeState::Outdated);
+                node->data[column] = std::move(itemData[i]);
+                node->flags[column] = static_cast<Qt::ItemFlags>(flags.at(i));
+                // keeps Outdated if the content changed or the requested roles were widened in the meantime
+                node->state[column] = state & ~(RemoteModelNodeState::Loading | RemoteModelNodeState::Empty);
 
-                if ((flags & Qt::ItemNeverHasChildren) && column == 0) {
+                if ((flags.at(i) & Qt::ItemNeverHasChildren) && column == 0) {
                     node->rowCount = 0;
                     node->columnCount = node->data.size();
                 }
@@ -815,8 +961,10 @@ void RemoteModel::requestDataAndFlags(const QModelIndex &index) const
     Q_ASSERT((state & RemoteModelNodeState::Loading) == 0);
 
     node->allocateColumns();
+    m_usedRows.touch(node);
     Q_ASSERT(( int )node->state.size() > index.column());
-    node->state[index.column()] = state | RemoteModelNodeState::Loading; // mark pending request
+    // the cell is outdated again if anything invalidates it while the request is pending
+    node->state[index.column()] = (state & ~RemoteModelNodeState::Outdated) | RemoteModelNodeState::Loading; // mark pending request
 
     auto &indexes = m_pendingRequests[DataAndFlags];
     indexes.push_back(Protocol::fromQModelIndex(index));
@@ -836,23 +984,26 @@ void RemoteModel::doRequests() const
         it.next();
 
         Q_ASSERT(!it.value().isEmpty());
-        const auto &indexes = it.value();
+        auto &indexes = it.value();
 
         switch (it.key()) {
         case RowColumnCount: {
             Message msg(m_myAddress, Protocol::ModelRowColumnCountRequest);
             msg << quint32(indexes.size());
+            Protocol::ModelIndexEncoder encoder;
             for (const auto &index : indexes)
-                msg << index;
+                msg << encoder.encode(index);
             sendMessage(msg);
             break;
         }
 
         case DataAndFlags: {
+            addPrefetchRequests(indexes);
             Message msg(m_myAddress, Protocol::ModelContentRequest);
-            msg << quint32(indexes.size());
+            msg << m_requestedRoles << quint32(indexes.size());
+            Protocol::ModelIndexEncoder encoder;
             for (const auto &index : indexes)
-                msg << index;
+                msg << encoder.encode(index);
             sendMessage(msg);
             break;
         }
@@ -860,6 +1011,86 @@ void RemoteModel::doRequests() const
 
         it.remove();
     }
+
+    evictRows();
+}
+
+void RemoteModel::addPrefetchRequests(QVector<Protocol::ModelIndex> &indexes) const
+{
+    if (m_prefetchRows <= 0 || indexes.isEmpty())
+        return;
+
+    // the rows a view requests below a parent in one go are what became visible in it
+    const auto &firstIndex = indexes.first();
+    const auto parentIndex = firstIndex.mid(0, firstIndex.size() - 1);
+    int first = std::numeric_limits<int>::max();
+    int last = -1;
+    QVector<int> columns;
+    for (const auto &index : std::as_const(indexes)) {
+        if (index.size() != parentIndex.size() + 1 || !std::equal(parentIndex.begin(), parentIndex.end(), index.begin()))
+            continue;
+        first = std::min(first, index.last().row);
+        last = std::max(last, index.last().row);
+        if (!columns.contains(index.last().column))
+            columns.push_back(index.last().column);
+    }
+
+    const bool sameParent = m_lastRequestFirst >= 0 && parentIndex == m_lastRequestParent;
+    const bool scrollingDown = sameParent && first > m_lastRequestFirst && last > m_lastRequestLast;
+    const bool scrollingUp = sameParent && first < m_lastRequestFirst && last < m_lastRequestLast;
+    m_lastRequestParent = parentIndex;
+    m_lastRequestFirst = first;
+    m_lastRequestLast = last;
+    if (!scrollingDown && !scrollingUp)
+        return;
+
+    Node *parentNode = nodeForIndex(parentIndex);
+    if (!parentNode || parentNode->rowCount <= 0)
+        return;
+
+    const int begin = scrollingDown ? last + 1 : std::max(0, first - m_prefetchRows);
+    const int end = scrollingDown ? std::min(parentNode->rowCount, last + 1 + m_prefetchRows) : first;
+    for (int row = begin; row < end; ++row) {
+        Node *node = parentNode->children.at(row);
+        for (int column : std::as_const(columns)) {
+            if (column >= parentNode->columnCount)
+                continue;
+            const auto state = stateForColumn(node, column);
+            if ((state & RemoteModelNodeState::Outdated) == 0 || (state & RemoteModelNodeState::Loading))
+                continue;
+
+            node->allocateColumns();
+            node->state[column] = (state & ~RemoteModelNodeState::Outdated) | RemoteModelNodeState::Loading;
+            m_usedRows.touch(node);
+
+            auto index = parentIndex;
+            index.push_back(Protocol::ModelIndexData(row, column));
+            indexes.push_back(index);
+        }
+    }
+}
+
+void RemoteModel::evictRows() const
+{
+    // allow for some slack, so we evict in batches rather than on every new row
+    if (m_cacheCapacity <= 0 || m_usedRows.size <= m_cacheCapacity + m_cacheCapacity / 4)
+        return;
+
+    // least recently used first
+    int evictCount = m_usedRows.size - m_cacheCapacity;
+    Node *node = m_usedRows.head.prevUsed;
+    while (evictCount > 0 && node != &m_usedRows.head) {
+        Node *prev = node->prevUsed;
+        // rows with pending requests can't be evicted, the reply would be discarded otherwise
+        const auto loading = std::any_of(node->state.begin(), node->state.end(), [](RemoteModelNodeState::NodeStates state) {
+            return state & RemoteModelNodeState::Loading;
+        });
+        if (!loading) {
+            node->clearColumnData();
+            --evictCount;
+        }
+        node = prev;
+    }
 }
 
 void RemoteModel::requestHeaderData(Qt::Orientation orientation, int section) const
@@ -889,6 +1120,9 @@ void RemoteModel::clear()
     m_root = new Node;
     m_horizontalHeaders.clear();
     m_verticalHeaders.clear();
+    m_lastRequestParent.clear();
+    m_lastRequestFirst = -1;
+    m_lastRequestLast = -1;
     endResetModel();
 }
 
@@ -911,6 +1145,24 @@ bool RemoteModel::checkSyncBarrier(const Message &msg)
     return m_currentSyncBarrier == m_targetSyncBarrier;
 }
 
+void RemoteModel::markOutdated(RemoteModel::Node *node)
+{
+    if (node->children.isEmpty())
+        return;
+
+    for (Node *child : std::as_const(node->children)) {
+        for (auto &state : child->state)
+            state |= RemoteModelNodeState::Outdated;
+        markOutdated(child);
+    }
+
+    // views only ask again for what they were told changed
+    if (node->columnCount <= 0)
+        return;
+    const auto first = modelIndexForNode(node->children.first(), 0);
+    emit dataChanged(first, first.sibling(node->children.size() - 1, node->columnCount - 1));
+}
+
 void RemoteModel::resetLoadingState(RemoteModel::Node *node, int startRow) const
 {
     if (node->rowCount < 0) {
@@ -923,7 +1175,7 @@ void RemoteModel::resetLoadingState(RemoteModel::Node *node, int startRow) const
         Node *child = node->children.at(row);
         for (auto it = child->state.begin(); it != child->state.end(); ++it) {
             if ((*it) & RemoteModelNodeState::Loading)
-                (*it) = (*it) & ~RemoteModelNodeState::Loading;
+                (*it) = ((*it) & ~RemoteModelNodeState::Loading) | RemoteModelNodeState::Outdated;
         }
         resetLoadingState(child, 0);
     }
@@ -40,6 +40,8 @@ class GAMMARAY_CLIENT_EXPORT RemoteModel : public QAbstractItemModel
         int filterKeyColumn READ proxyFilterKeyColumn WRITE setProxyFilterKeyColumn NOTIFY proxyFilterKeyColumnChanged)
     Q_PROPERTY(
         QRegularExpression filterRegularExpression READ proxyFilterRegExp WRITE setProxyFilterRegExp NOTIFY proxyFilterRegExpChanged)
+    Q_PROPERTY(
+        QVector<QVector<int>> requestedRoles READ requestedRoles WRITE setRequestedRoles)
 
 public:
     explicit RemoteModel(const QString &serverObject, QObject *parent = nullptr);
@@ -60,6 +62,31 @@ public:
                         int role = Qt::DisplayRole) const override;
     void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
+    /** Maximum number of rows whose content is kept in the local cache.
+     *  Beyond that, the least recently used rows are evicted, and requested again once needed.
+     *  Defaults to the @c GAMMARAY_REMOTE_MODEL_CACHE_SIZE environment variable, or 10000.
+     *  0 disables eviction.
+     *  @since 3.4
+     */
+    int cacheCapacity() const;
+    void setCacheCapacity(int rows);
+
+    /** Number of rows requested ahead of the scroll direction, when the rows requested by a view
+     *  move consistently up or down. 0 disables prefetching.
+     *  @since 3.4
+     */
+    int prefetchRows() const;
+    void setPrefetchRows(int rows);
+
+    /** Roles to fetch from the server, per column. An empty entry requests all roles,
+     *  columns beyond the last entry use the last entry. Defaults to all roles for all columns.
+     *  Restricting this to the roles a view actually uses avoids transferring the rest.
+     *  Settable via QObject::setProperty() on the client side model.
+     *  @since 3.4
+     */
+    QVector<QVector<int>> requestedRoles() const;
+    void setRequestedRoles(const QVector<QVector<int>> &roles);
+
 public slots:
     void newMessage(const GammaRay::Message &msg);
     void serverRegistered(const QString &objectName, Protocol::ObjectAddress objectAddress);
@@ -74,6 +101,8 @@ signals:
     void declarationCreationLocationsReceived(const QVariant &v, const QVariant &v2);
 
 private:
+    struct UsageList;
+
     struct Node
     { // represents one row
         Node() = default;
@@ -84,6 +113,8 @@ private:
         // forget everything we know about our children, including row/column counts
         void clearChildrenStructure();
 
+        // delete the cached data of this row, turning it back into the empty state
+        void clearColumnData();
         // resize the initialize the column vectors
         void allocateColumns();
         // returns whether columns are allocated
@@ -98,6 +129,24 @@ private:
         std::vector<RemoteModelNodeState::NodeStates> state; // column -> state (cache outdated, waiting for data, etc)
 
         int rowHint = -1; // for internal use by modelIndexForNode
+
+        // position in the usage list while column data is allocated
+        UsageList *usageList = nullptr;
+        Node *prevUsed = nullptr;
+        Node *nextUsed = nullptr;
+    };
+
+    // intrusive list of the rows with column data, most recently used first
+    struct UsageList
+    {
+        UsageList();
+        Q_DISABLE_COPY(UsageList)
+        // links @p node at the front, or moves it there if already linked
+        void touch(Node *node);
+        void remove(Node *node);
+
+        Node head; // sentinel, head.nextUsed is the most and head.prevUsed the least recently used row
+        int size = 0;
     };
 
     void clear();
@@ -117,6 +166,12 @@ private:
     void requestRowColumnCount(const QModelIndex &index) const;
     void requestDataAndFlags(const QModelIndex &index) const;
     void requestHeaderData(Qt::Orientation orientation, int section) const;
+    /// Adds requests for the rows following the ones requested in @p indexes in scroll direction.
+    void addPrefetchRequests(QVector<Protocol::ModelIndex> &indexes) const;
+    /// Drops the content of the least recently used rows, if we exceed the cache capacity.
+    void evictRows() const;
+    /// Marks all cached cells below @p node as outdated, so they are fetched again on next access.
+    void markOutdated(Node *node);
     /// Reset the loading state for all rows at @p startRow or later.
     /// This is needed when rows have been added or removed before @p startRow, since
     /// pending replies might have a wrong index.
@@ -165,6 +220,18 @@ private:
     mutable QMap<RequestType, QVector<Protocol::ModelIndex>> m_pendingRequests;
     QTimer *m_pendingRequestsTimer;
 
+    // content cache bookkeeping
+    int m_cacheCapacity;
+    mutable UsageList m_usedRows;
+
+    // scroll direction detection for prefetching
+    int m_prefetchRows;
+    mutable Protocol::ModelIndex m_lastRequestParent;
+    mutable int m_lastRequestFirst;
+    mutable int m_lastRequestLast;
+
+    QVector<QVector<int>> m_requestedRoles; // column -> sorted roles, empty for all
+
     QString m_serverObject;
     Protocol::ObjectAddress m_myAddress;
 
@@ -66,6 +66,11 @@ void RemoteViewClient::sendUserViewport(const QRectF &userViewport)
     Endpoint::instance()->invokeObject(name(), "sendUserViewport", QVariantList() << userViewport);
 }
 
+void RemoteViewClient::sendUserScale(double scale)
+{
+    Endpoint::instance()->invokeObject(name(), "sendUserScale", QVariantList() << scale);
+}
+
 void RemoteViewClient::clientViewUpdated()
 {
     Endpoint::instance()->invokeObject(name(), "clientViewUpdated");
@@ -75,3 +80,13 @@ void RemoteViewClient::requestCompleteFrame()
 {
     Endpoint::instance()->invokeObject(name(), "requestCompleteFrame");
 }
+
+void RemoteViewClient::setFrameCodec(GammaRay::RemoteViewInterface::FrameCodec codec)
+{
+    Endpoint::instance()->invokeObject(name(), "setFrameCodec", QVariantList() << QVariant::fromValue(codec));
+}
+
+void RemoteViewClient::requestKeyFrame()
+{
+    Endpoint::instance()->invokeObject(name(), "requestKeyFrame");
+}
@@ -36,8 +36,11 @@ public:
                         const QList<QTouchEvent::TouchPoint> &touchPoints) override;
     void setViewActive(bool active) override;
     void sendUserViewport(const QRectF &userViewport) override;
+    void sendUserScale(double scale) override;
     void clientViewUpdated() override;
     void requestCompleteFrame() override;
+    void setFrameCodec(GammaRay::RemoteViewInterface::FrameCodec codec) override;
+    void requestKeyFrame() override;
 };
 }
 
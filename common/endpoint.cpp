@@ -23,6 +23,9 @@
 // we use qCWarning, which we turn off by default, but which is not compiled out in releasebuilds
 Q_LOGGING_CATEGORY(networkstatistics, "gammaray.network.statistics", QtMsgType::QtCriticalMsg)
 
+// batches exceeding this are sent right away, rather than waiting for the next event loop iteration
+static const int maximumBatchSize = 64 * 1024;
+
 using namespace GammaRay;
 using namespace std;
 
@@ -35,6 +38,8 @@ Endpoint::Endpoint(QObject *parent)
     , m_myAddress(Protocol::InvalidObjectAddress + 1)
     , m_bytesRead(0)
     , m_bytesWritten(0)
+    , m_sendStream(new MessageStream)
+    , m_receiveStream(new MessageStream)
     , m_pid(-1)
 {
     if (s_instance) {
@@ -55,6 +60,11 @@ Endpoint::Endpoint(QObject *parent)
     connect(m_bandwidthMeasurementTimer, &QTimer::timeout, this, &Endpoint::doLogTransmissionRate);
     m_bandwidthMeasurementTimer->start(1000);
 
+    m_messageBatchTimer = new QTimer(this);
+    m_messageBatchTimer->setSingleShot(true);
+    m_messageBatchTimer->setInterval(0);
+    connect(m_messageBatchTimer, &QTimer::timeout, this, &Endpoint::flushMessageBatch);
+
     connect(m_propertySyncer, &PropertySyncer::message, this,
             &Endpoint::sendMessage);
 }
@@ -94,12 +104,59 @@ void Endpoint::sendMessage(const Message &msg)
 void Endpoint::doSendMessage(const GammaRay::Message &msg)
 {
     Q_ASSERT(msg.address() != Protocol::InvalidObjectAddress);
-    msg.write(m_socket);
     m_bytesWritten += msg.size();
+
+    auto stream = m_streamCompressionEnabled ? m_sendStream.get() : nullptr;
+    if (!m_messageBatchingEnabled) {
+        msg.write(m_socket, stream);
+        return;
+    }
+
+    // no point in copying large messages, they compress well enough on their own
+    if (msg.size() >= maximumBatchSize) {
+        flushMessageBatch();
+        msg.write(m_socket, stream);
+        return;
+    }
+
+    if (!m_messageBatch) {
+        m_messageBatch.reset(new Message(m_myAddress, Protocol::MessageBatch));
+        m_messageBatchTimer->start();
+    }
+    msg.appendTo(*m_messageBatch);
+    if (m_messageBatch->size() >= maximumBatchSize)
+        flushMessageBatch();
+}
+
+void Endpoint::flushMessageBatch()
+{
+    m_messageBatchTimer->stop();
+    if (!m_messageBatch)
+        return;
+    if (m_socket)
+        m_messageBatch->write(m_socket, m_streamCompressionEnabled ? m_sendStream.get() : nullptr);
+    m_messageBatch.reset();
+}
+
+void Endpoint::setMessageBatchingEnabled(bool enabled)
+{
+    static const bool batchingAllowed = qEnvironmentVariableIntValue("GAMMARAY_DISABLE_MESSAGE_BATCHING") != 1;
+    if (!enabled)
+        flushMessageBatch();
+    m_messageBatchingEnabled = enabled && batchingAllowed;
+}
+
+void Endpoint::setStreamCompressionEnabled(bool enabled)
+{
+    static const bool streamingRequested = qEnvironmentVariableIntValue("GAMMARAY_LZ4_STREAMING") == 1;
+    // anything still batched belongs to the previous mode
+    flushMessageBatch();
+    m_streamCompressionEnabled = enabled && streamingRequested;
 }
 
 void Endpoint::waitForMessagesWritten()
 {
+    flushMessageBatch();
     m_socket->waitForBytesWritten(-1);
 }
 
@@ -138,6 +195,8 @@ void Endpoint::setDevice(QIODevice *device)
     Q_ASSERT(!m_socket);
     Q_ASSERT(device);
     m_socket = device;
+    m_sendStream->reset();
+    m_receiveStream->reset();
     connect(m_socket.data(), &QIODevice::readyRead, this, &Endpoint::readyRead);
     // FIXME Use proper type for m_socket, instead of relying on runtime-connect
     // to a slot which doesn't exist in QIODevice
@@ -154,7 +213,18 @@ Protocol::ObjectAddress Endpoint::endpointAddress() const
 void Endpoint::readyRead()
 {
     while (Message::canReadMessage(m_socket.data())) {
-        const auto msg = Message::readMessage(m_socket.data());
+        const auto msg = Message::readMessage(m_socket.data(), m_receiveStream.get());
+        if (msg.type() == Protocol::MessageBatch && msg.address() == m_myAddress) {
+            while (msg.canReadBatchedMessage()) {
+                const auto batchedMsg = msg.readBatchedMessage();
+                m_bytesRead += batchedMsg.size();
+                messageReceived(batchedMsg);
+                // messageReceived() might have ended up in disconnecting
+                if (!m_socket)
+                    return;
+            }
+            continue;
+        }
         m_bytesRead += msg.size();
         messageReceived(msg);
     }
@@ -162,6 +232,10 @@ void Endpoint::readyRead()
 
 void Endpoint::connectionClosed()
 {
+    m_messageBatchingEnabled = false;
+    m_streamCompressionEnabled = false;
+    m_messageBatchTimer->stop();
+    m_messageBatch.reset();
     disconnect(m_socket.data(), &QIODevice::readyRead, this, &Endpoint::readyRead);
     disconnect(m_socket.data(), SIGNAL(disconnected()), this, SLOT(connectionClosed()));
     m_socket = nullptr;
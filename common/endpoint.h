@@ -23,6 +23,8 @@
 #include <QTimer>
 
 #include <QLoggingCategory>
+
+#include <memory>
 Q_DECLARE_LOGGING_CATEGORY(networkstatistics)
 
 QT_BEGIN_NAMESPACE
@@ -32,6 +34,7 @@ QT_END_NAMESPACE
 
 namespace GammaRay {
 class Message;
+class MessageStream;
 class PropertySyncer;
 
 /*! Network protocol endpoint.
@@ -185,6 +188,20 @@ protected:
     /*! Sends a given message. */
     virtual void doSendMessage(const Message &msg);
 
+    /*! Enables collecting outgoing messages into batches, which are sent once per event
+     *  loop iteration, or once they exceed a certain size. Only call this once the other
+     *  endpoint is known to understand Protocol::MessageBatch, ie. after the protocol
+     *  version check and data version negotiation.
+     */
+    void setMessageBatchingEnabled(bool enabled);
+
+    /*! Enables LZ4 stream compression for outgoing messages, if requested by setting
+     *  the GAMMARAY_LZ4_STREAMING environment variable to 1. Same restrictions as for
+     *  setMessageBatchingEnabled() apply. Incoming stream compressed messages are always
+     *  understood.
+     */
+    void setStreamCompressionEnabled(bool enabled);
+
     /*! All current object name/address pairs. */
     QVector<QPair<Protocol::ObjectAddress, QString>> objectAddresses() const;
 
@@ -203,6 +220,7 @@ protected:
 
 private slots:
     void readyRead();
+    void flushMessageBatch();
     void doLogTransmissionRate();
     void connectionClosed();
     void slotHandlerDestroyed(QObject *obj);
@@ -238,6 +256,14 @@ private:
 
     QPointer<QIODevice> m_socket;
     Protocol::ObjectAddress m_myAddress;
+    // outgoing messages not written yet, if batching is enabled
+    std::unique_ptr<Message> m_messageBatch;
+    QTimer *m_messageBatchTimer;
+    bool m_messageBatchingEnabled = false;
+    // compression history of each direction
+    std::unique_ptr<MessageStream> m_sendStream;
+    std::unique_ptr<MessageStream> m_receiveStream;
+    bool m_streamCompressionEnabled = false;
     quint64 m_bytesRead;
     quint64 m_bytesWritten;
     QTimer *m_bandwidthMeasurementTimer;
@@ -19,50 +19,162 @@
 #include <QBuffer>
 #include <QDebug>
 #include <qendian.h>
+#include <private/qiodevice_p.h>
 
-inline void compress(const QByteArray &src, QByteArray &dst)
+#include <cstring>
+
+// compresses @p src into @p dst starting at @p offset, returns the size of the compressed data
+// including the size prefix, or 0 if compression failed
+inline int compress(const QByteArray &src, QByteArray &dst, int offset)
 {
     const qint32 srcSz = src.size();
+    const int bound = LZ4_compressBound(srcSz);
 
-    dst.resize(LZ4_compressBound(srcSz + sizeof(srcSz)));
-    *( qint32 * )dst.data() = srcSz; // save the source size
+    dst.resize(offset + int(sizeof(srcSz)) + bound);
+    memcpy(dst.data() + offset, &srcSz, sizeof(srcSz)); // save the source size
 
-    const int sz = LZ4_compress_default(src.constData(), dst.data() + sizeof(int), srcSz, dst.size());
-    dst.resize(sz + sizeof(srcSz));
+    const int sz = LZ4_compress_default(src.constData(), dst.data() + offset + sizeof(srcSz), srcSz, bound);
+    if (sz <= 0)
+        return 0;
+    dst.resize(offset + sz + int(sizeof(srcSz)));
+    return sz + sizeof(srcSz);
 }
 
-inline void uncompress(const QByteArray &src, QByteArray &dst)
+inline void uncompress(const char *src, int srcSize, QByteArray &dst)
 {
-    const qint32 dstSz = *( const qint32 * )src.constData(); // get the dest size
+    const qint32 dstSz = *( const qint32 * )src; // get the dest size
     dst.resize(dstSz);
-    const int sz = LZ4_decompress_safe(src.constData() + sizeof(dstSz), dst.data(),
-                                       src.size() - sizeof(dstSz), dstSz);
+    const int sz = LZ4_decompress_safe(src + sizeof(dstSz), dst.data(),
+                                       srcSize - sizeof(dstSz), dstSz);
     if (sz <= 0)
         dst.resize(0);
     else
         dst.resize(sz);
 }
 
+namespace GammaRay {
+// uses the ring buffer approach from the LZ4 examples, encoder and decoder wrap at the same points
+class MessageStreamPrivate
+{
+public:
+    // larger messages are compressed independently, they compress well enough on their own
+    static const int maximumBlockSize = 256 * 1024;
+    // a new block must never overwrite the 64 kB of history preceding it, also when wrapping
+    static const int ringBufferSize = 64 * 1024 + 2 * maximumBlockSize;
+
+    MessageStreamPrivate()
+        : encoder(LZ4_createStream())
+    {
+        ringBuffer.resize(ringBufferSize);
+        LZ4_setStreamDecode(&decoder, nullptr, 0);
+    }
+    ~MessageStreamPrivate()
+    {
+        LZ4_freeStream(encoder);
+    }
+
+    // returns the position in the ring buffer for the next block of @p size bytes
+    char *nextBlock(int size)
+    {
+        if (offset + size > ringBufferSize)
+            offset = 0;
+        char *block = ringBuffer.data() + offset;
+        offset += size;
+        return block;
+    }
+
+    LZ4_stream_t *encoder;
+    LZ4_streamDecode_t decoder;
+    QByteArray ringBuffer;
+    int offset = 0;
+};
+}
+
+GammaRay::MessageStream::MessageStream()
+    : d(new MessageStreamPrivate)
+{
+}
+
+GammaRay::MessageStream::~MessageStream() = default;
+
+void GammaRay::MessageStream::reset()
+{
+    LZ4_resetStream_fast(d->encoder);
+    LZ4_setStreamDecode(&d->decoder, nullptr, 0);
+    d->offset = 0;
+}
+
+// same as compress(), but with the history of @p stream
+// the source size is stored negated, to tell the receiver this needs the stream state for decompression
+inline int compressStreamed(const QByteArray &src, QByteArray &dst, int offset, GammaRay::MessageStreamPrivate *stream)
+{
+    const qint32 srcSz = src.size();
+    const int bound = LZ4_compressBound(srcSz);
+
+    dst.resize(offset + int(sizeof(srcSz)) + bound);
+    const qint32 streamedSz = -srcSz;
+    memcpy(dst.data() + offset, &streamedSz, sizeof(streamedSz));
+
+    // the history needs to stay in place, so we compress from the ring buffer
+    char *block = stream->nextBlock(srcSz);
+    memcpy(block, src.constData(), srcSz);
+    const int sz = LZ4_compress_fast_continue(stream->encoder, block, dst.data() + offset + sizeof(srcSz), srcSz, bound, 1);
+    Q_ASSERT(sz > 0); // can't fail with a large enough output buffer, and we would be out of sync otherwise
+    dst.resize(offset + sz + int(sizeof(srcSz)));
+    return sz + sizeof(srcSz);
+}
+
+inline void uncompressStreamed(const char *src, int srcSize, QByteArray &dst, GammaRay::MessageStreamPrivate *stream)
+{
+    const qint32 dstSz = -*( const qint32 * )src;
+    if (!stream || dstSz <= 0 || dstSz > GammaRay::MessageStreamPrivate::maximumBlockSize) {
+        qWarning("Received a stream compressed message without stream compression state.");
+        dst.resize(0);
+        return;
+    }
+
+    char *block = stream->nextBlock(dstSz);
+    const int sz = LZ4_decompress_safe_continue(&stream->decoder, src + sizeof(dstSz), block,
+                                                srcSize - sizeof(dstSz), dstSz);
+    if (sz <= 0) {
+        dst.resize(0);
+        return;
+    }
+    dst.resize(sz);
+    memcpy(dst.data(), block, sz);
+}
+
+// returns the next @p size bytes of @p device without consuming them, if they are available in one
+// piece without copying, i.e. in the memory of a QBuffer or in the first chunk of the read buffer
+static const char *peekContiguous(QIODevice *device, int size)
+{
+    if (auto buffer = qobject_cast<QBuffer *>(device)) {
+        const auto &data = buffer->data();
+        return buffer->pos() + size <= data.size() ? data.constData() + buffer->pos() : nullptr;
+    }
+    const auto d = static_cast<QIODevicePrivate *>(QObjectPrivate::get(device));
+    return d->buffer.nextDataBlockSize() >= size ? d->buffer.readPointer() : nullptr;
+}
+
 static quint8 s_streamVersion = GammaRay::Message::lowestSupportedDataVersion();
 static const int minimumUncompressedSize = 32;
+static const int headerSize = sizeof(GammaRay::Protocol::PayloadSize) + sizeof(GammaRay::Protocol::ObjectAddress)
+    + sizeof(GammaRay::Protocol::MessageType);
+// uncompressed payloads larger than this are written separately from the header, rather than copied behind it
+static const int maximumCopiedPayloadSize = 64 * 1024;
 
 template<typename T>
-static T readNumber(QIODevice *device)
+static char *writeNumber(char *dst, T value)
 {
-    T buffer;
-    const int readSize = device->read(( char * )&buffer, sizeof(T));
-    Q_UNUSED(readSize);
-    Q_ASSERT(readSize == sizeof(T));
-    return qFromBigEndian(buffer);
+    qToBigEndian(value, dst);
+    return dst + sizeof(T);
 }
 
 template<typename T>
-static void writeNumber(QIODevice *device, T value)
+static const char *readNumber(const char *src, T &value)
 {
-    value = qToBigEndian(value);
-    const int writeSize = device->write(( char * )&value, sizeof(T));
-    Q_UNUSED(writeSize);
-    Q_ASSERT(writeSize == sizeof(T));
+    value = qFromBigEndian<T>(src);
+    return src + sizeof(T);
 }
 
 using namespace GammaRay;
@@ -123,6 +235,7 @@ Message::Message(Protocol::ObjectAddress objectAddress, Protocol::MessageType ty
 Message::Message(Message &&other) Q_DECL_NOEXCEPT
     : m_objectAddress(other.m_objectAddress),
       m_messageType(other.m_messageType),
+      m_transferSize(other.m_transferSize),
       m_buffer(std::move(other.m_buffer))
 {
 }
@@ -149,8 +262,7 @@ bool Message::canReadMessage(QIODevice *device)
     if (!device)
         return false;
 
-    static const int minimumSize = sizeof(Protocol::PayloadSize) + sizeof(Protocol::ObjectAddress)
-        + sizeof(Protocol::MessageType);
+    static const int minimumSize = headerSize;
     if (device->bytesAvailable() < minimumSize)
         return false;
 
@@ -167,27 +279,56 @@ bool Message::canReadMessage(QIODevice *device)
 }
 
 Message Message::readMessage(QIODevice *device)
+{
+    return readMessage(device, nullptr);
+}
+
+Message Message::readMessage(QIODevice *device, MessageStream *stream)
 {
     Message msg;
 
-    Protocol::PayloadSize payloadSize = readNumber<qint32>(device);
+    char header[headerSize];
+    const int headerReadSize = device->read(header, headerSize);
+    Q_UNUSED(headerReadSize);
+    Q_ASSERT(headerReadSize == headerSize);
 
-    msg.m_objectAddress = readNumber<Protocol::ObjectAddress>(device);
-    msg.m_messageType = readNumber<Protocol::MessageType>(device);
+    Protocol::PayloadSize payloadSize;
+    auto it = readNumber(header, payloadSize);
+    it = readNumber(it, msg.m_objectAddress);
+    readNumber(it, msg.m_messageType);
     Q_ASSERT(msg.m_messageType != Protocol::InvalidMessageType);
     Q_ASSERT(msg.m_objectAddress != Protocol::InvalidObjectAddress);
+    msg.m_transferSize = headerSize + abs(payloadSize);
+
+    // read straight into the pooled buffers, QIODevice::read(qint64) would allocate a new one each time
     if (payloadSize < 0) {
         payloadSize = abs(payloadSize);
-        auto &uncompressedData = msg.m_buffer->scratchSpace;
-        uncompressedData.resize(payloadSize);
-        device->read(uncompressedData.data(), payloadSize);
-        uncompress(uncompressedData, msg.m_buffer->data.buffer());
-        Q_ASSERT(payloadSize == uncompressedData.size());
-    } else {
-        if (payloadSize > 0) {
-            msg.m_buffer->data.buffer() = device->read(payloadSize);
-            Q_ASSERT(payloadSize == msg.m_buffer->data.size());
+        // decompress in place if possible, and only copy compressed data split across buffer chunks
+        const char *compressedData = peekContiguous(device, payloadSize);
+        const bool inPlace = compressedData;
+        if (!inPlace) {
+            auto &scratchSpace = msg.m_buffer->scratchSpace;
+            scratchSpace.resize(payloadSize);
+            const int readSize = device->read(scratchSpace.data(), payloadSize);
+            Q_UNUSED(readSize);
+            Q_ASSERT(payloadSize == readSize);
+            compressedData = scratchSpace.constData();
         }
+        if (*( const qint32 * )compressedData < 0)
+            uncompressStreamed(compressedData, payloadSize, msg.m_buffer->data.buffer(), stream ? stream->d.get() : nullptr);
+        else
+            uncompress(compressedData, payloadSize, msg.m_buffer->data.buffer());
+        if (inPlace) {
+            const auto skipSize = device->skip(payloadSize);
+            Q_UNUSED(skipSize);
+            Q_ASSERT(payloadSize == skipSize);
+        }
+    } else if (payloadSize > 0) {
+        auto &data = msg.m_buffer->data.buffer();
+        data.resize(payloadSize);
+        const int readSize = device->read(data.data(), payloadSize);
+        Q_UNUSED(readSize);
+        Q_ASSERT(payloadSize == readSize);
     }
 
     msg.m_buffer->resetStatus();
@@ -221,35 +362,81 @@ void Message::resetNegotiatedDataVersion()
 }
 
 void Message::write(QIODevice *device) const
+{
+    write(device, nullptr);
+}
+
+void Message::write(QIODevice *device, MessageStream *stream) const
 {
     Q_ASSERT(m_objectAddress != Protocol::InvalidObjectAddress);
     Q_ASSERT(m_messageType != Protocol::InvalidMessageType);
     static const bool compressionEnabled = qEnvironmentVariableIntValue("GAMMARAY_DISABLE_LZ4") != 1;
-    const int buffSize = m_buffer->data.size();
-    auto &compressedData = m_buffer->scratchSpace;
-    if (buffSize > minimumUncompressedSize && compressionEnabled)
-        compress(m_buffer->data.buffer(), compressedData);
-
-    const bool isCompressed = compressedData.size() && compressedData.size() < buffSize;
-    if (isCompressed)
-        writeNumber<Protocol::PayloadSize>(device, -compressedData.size()); // send compressed Buffer
-    else
-        writeNumber<Protocol::PayloadSize>(device, buffSize); // send uncompressed Buffer
-
-    writeNumber(device, m_objectAddress);
-    writeNumber(device, m_messageType);
-
-    if (buffSize) {
-        if (isCompressed) {
-            const int s = device->write(compressedData);
-            Q_ASSERT(s == compressedData.size());
-            Q_UNUSED(s);
-        } else {
-            const int s = device->write(m_buffer->data.buffer());
-            Q_ASSERT(s == m_buffer->data.size());
-            Q_UNUSED(s);
-        }
+    const auto &payload = m_buffer->data.buffer();
+    const int buffSize = payload.size();
+
+    // the entire frame is assembled in the pooled scratch buffer, so it goes out with a single write
+    // the payload is compressed right behind the header there, so there is no need to copy it again
+    auto &frame = m_buffer->scratchSpace;
+    int compressedSize = 0;
+    // with the stream history, even small messages usually compress well
+    const bool isStreamed = stream && buffSize > 0 && buffSize <= MessageStreamPrivate::maximumBlockSize && compressionEnabled;
+    if (isStreamed)
+        compressedSize = compressStreamed(payload, frame, headerSize, stream->d.get());
+    else if (buffSize > minimumUncompressedSize && compressionEnabled)
+        compressedSize = compress(payload, frame, headerSize);
+
+    // streamed messages are part of the history now, so they have to be sent compressed in any case
+    const bool isCompressed = compressedSize > 0 && (isStreamed || compressedSize < buffSize);
+    const bool isCopied = !isCompressed && buffSize <= maximumCopiedPayloadSize;
+    if (isCompressed) {
+        Q_ASSERT(frame.size() == headerSize + compressedSize);
+    } else if (isCopied) {
+        frame.resize(headerSize + buffSize);
+        memcpy(frame.data() + headerSize, payload.constData(), buffSize);
+    } else {
+        frame.resize(headerSize);
     }
+
+    auto it = writeNumber<Protocol::PayloadSize>(frame.data(), isCompressed ? -compressedSize : buffSize);
+    it = writeNumber(it, m_objectAddress);
+    writeNumber(it, m_messageType);
+
+    int s = device->write(frame.constData(), frame.size());
+    Q_ASSERT(s == frame.size());
+    if (!isCompressed && !isCopied) {
+        s = device->write(payload);
+        Q_ASSERT(s == buffSize);
+    }
+    Q_UNUSED(s);
+}
+
+void Message::appendTo(Message &batch) const
+{
+    Q_ASSERT(m_objectAddress != Protocol::InvalidObjectAddress);
+    Q_ASSERT(m_messageType != Protocol::InvalidMessageType);
+    const auto &payload = m_buffer->data.buffer();
+
+    char header[headerSize];
+    auto it = writeNumber<Protocol::PayloadSize>(header, payload.size());
+    it = writeNumber(it, m_objectAddress);
+    writeNumber(it, m_messageType);
+
+    auto &stream = batch.payload();
+    stream.writeRawData(header, headerSize);
+    stream.writeRawData(payload.constData(), payload.size());
+}
+
+bool Message::canReadBatchedMessage() const
+{
+    return canReadMessage(payload().device());
+}
+
+Message Message::readBatchedMessage() const
+{
+    auto msg = readMessage(payload().device());
+    // attribute the batch's transfer size proportionally
+    msg.m_transferSize = qint64(m_transferSize) * msg.m_transferSize / qMax(1, size());
+    return msg;
 }
 
 int Message::size() const
@@ -257,6 +444,11 @@ int Message::size() const
     return m_buffer->data.size();
 }
 
+int Message::transferSize() const
+{
+    return m_transferSize;
+}
+
 int Message::pos() const
 {
     return payload().device()->pos();
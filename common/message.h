@@ -26,6 +26,33 @@
 class MessageBuffer;
 
 namespace GammaRay {
+class MessageStreamPrivate;
+
+/**
+ * LZ4 stream compression state for one direction of a connection.
+ *
+ * Messages compressed with this can refer back to the content of previously sent
+ * messages, which helps a lot with the class, property and object names repeated
+ * all over the protocol. This requires the receiver to decompress the messages in
+ * the same order they were compressed in, using its own MessageStream instance.
+ *
+ * @since 3.4
+ */
+class GAMMARAY_COMMON_EXPORT MessageStream
+{
+public:
+    MessageStream();
+    ~MessageStream();
+
+    /** Forget about all previous messages, call this when starting a new connection. */
+    void reset();
+
+private:
+    Q_DISABLE_COPY(MessageStream)
+    friend class Message;
+    std::unique_ptr<MessageStreamPrivate> d;
+};
+
 /**
  * Single message send between client and server.
  * Binary format:
@@ -94,6 +121,10 @@ public:
     static bool canReadMessage(QIODevice *device);
     /** Read the next message from @p device. */
     static Message readMessage(QIODevice *device);
+    /** Read the next message from @p device, using @p stream to decompress stream compressed messages.
+     *  @since 3.4
+     */
+    static Message readMessage(QIODevice *device, MessageStream *stream);
 
     static quint8 lowestSupportedDataVersion();
     static quint8 highestSupportedDataVersion();
@@ -104,10 +135,31 @@ public:
 
     /** Write this message to @p device. */
     void write(QIODevice *device) const;
+    /** Write this message to @p device, compressed using @p stream if that is not @c nullptr.
+     *  @since 3.4
+     */
+    void write(QIODevice *device, MessageStream *stream) const;
+
+    /** Appends this message uncompressed to the payload of @p batch.
+     *  The batch is compressed as a whole when written.
+     *  @since 3.4
+     */
+    void appendTo(Message &batch) const;
+    /** Checks if there is another message in the payload of this batch message. */
+    bool canReadBatchedMessage() const;
+    /** Read the next message from the payload of this batch message. */
+    Message readBatchedMessage() const;
 
     /** Size of the uncompressed message payload. */
     int size() const;
 
+    /** Number of bytes this message took up on the wire, including the header.
+     *  For messages received as part of a batch, this is their share of the batch.
+     *  Only available for received messages.
+     *  @since 3.4
+     */
+    int transferSize() const;
+
     /** Current position of the stream */
     int pos() const;
 
@@ -141,6 +193,7 @@ private:
 
     Protocol::ObjectAddress m_objectAddress;
     Protocol::MessageType m_messageType;
+    int m_transferSize = 0;
 
     std::unique_ptr<MessageBuffer, std::function<void(MessageBuffer *)>> m_buffer;
 };
@@ -21,3 +21,29 @@ ProbeControllerInterface::ProbeControllerInterface(QObject *parent)
 }
 
 ProbeControllerInterface::~ProbeControllerInterface() = default;
+
+bool ProbeControllerInterface::objectDiscoveryRunning() const
+{
+    return m_objectDiscoveryRunning;
+}
+
+void ProbeControllerInterface::setObjectDiscoveryRunning(bool running)
+{
+    if (m_objectDiscoveryRunning == running)
+        return;
+    m_objectDiscoveryRunning = running;
+    emit objectDiscoveryRunningChanged(running);
+}
+
+int ProbeControllerInterface::discoveredObjectCount() const
+{
+    return m_discoveredObjectCount;
+}
+
+void ProbeControllerInterface::setDiscoveredObjectCount(int count)
+{
+    if (m_discoveredObjectCount == count)
+        return;
+    m_discoveredObjectCount = count;
+    emit discoveredObjectCountChanged(count);
+}
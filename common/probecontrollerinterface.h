@@ -25,6 +25,8 @@ namespace GammaRay {
 class ProbeControllerInterface : public QObject
 {
     Q_OBJECT
+    Q_PROPERTY(bool objectDiscoveryRunning READ objectDiscoveryRunning WRITE setObjectDiscoveryRunning NOTIFY objectDiscoveryRunningChanged)
+    Q_PROPERTY(int discoveredObjectCount READ discoveredObjectCount WRITE setDiscoveredObjectCount NOTIFY discoveredObjectCountChanged)
 
 public:
     explicit ProbeControllerInterface(QObject *parent = nullptr);
@@ -36,8 +38,22 @@ public:
     /*! Detach GammaRay but keep host application running. */
     virtual void detachProbe() = 0;
 
+    /*! @c true while objects of the host application are still being discovered incrementally after attaching. */
+    bool objectDiscoveryRunning() const;
+    void setObjectDiscoveryRunning(bool running);
+
+    /*! Number of objects found so far by the incremental object discovery. */
+    int discoveredObjectCount() const;
+    void setDiscoveredObjectCount(int count);
+
+signals:
+    void objectDiscoveryRunningChanged(bool running);
+    void discoveredObjectCountChanged(int count);
+
 private:
     Q_DISABLE_COPY(ProbeControllerInterface)
+    bool m_objectDiscoveryRunning = false;
+    int m_discoveredObjectCount = 0;
 };
 }
 
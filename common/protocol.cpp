@@ -13,6 +13,8 @@
 
 #include "protocol.h"
 
+#include <algorithm>
+
 namespace GammaRay {
 namespace Protocol {
 Protocol::ModelIndex fromQModelIndex(const QModelIndex &index)
@@ -37,9 +39,31 @@ QModelIndex toQModelIndex(const QAbstractItemModel *model, const Protocol::Model
     return qmi;
 }
 
+RelativeModelIndex ModelIndexEncoder::encode(const ModelIndex &index)
+{
+    const int maxPrefix = std::min<int>({ int(index.size()), int(m_previous.size()), std::numeric_limits<quint16>::max() });
+    int prefix = 0;
+    while (prefix < maxPrefix && index.at(prefix) == m_previous.at(prefix))
+        ++prefix;
+
+    RelativeModelIndex result;
+    result.commonPrefix = prefix;
+    result.suffix = index.mid(prefix);
+    m_previous = index;
+    return result;
+}
+
+ModelIndex ModelIndexDecoder::decode(const RelativeModelIndex &index)
+{
+    Q_ASSERT(index.commonPrefix <= m_previous.size());
+    m_previous.resize(std::min<int>(index.commonPrefix, m_previous.size()));
+    m_previous += index.suffix;
+    return m_previous;
+}
+
 qint32 version()
 {
-    return 38;
+    return 42;
 }
 
 qint32 broadcastFormatVersion()
@@ -19,6 +19,7 @@
 #include <QAbstractItemModel>
 #include <QDataStream>
 #include <QDebug>
+#include <QHashFunctions>
 #include <QVector>
 #include <QModelIndex>
 
@@ -100,6 +101,9 @@ enum BuildInMessageType
     ServerAddress,
     ServerLaunchError,
 
+    // server <-> client, after data version negotiation
+    MessageBatch,
+
     MESSAGE_TYPE_COUNT // NOTE when changing this enum, also update MessageStatisticsModel!
 };
 
@@ -117,6 +121,18 @@ public:
     qint32 row;
     qint32 column;
 };
+inline bool operator==(ModelIndexData lhs, ModelIndexData rhs)
+{
+    return lhs.row == rhs.row && lhs.column == rhs.column;
+}
+inline bool operator!=(ModelIndexData lhs, ModelIndexData rhs)
+{
+    return !(lhs == rhs);
+}
+inline size_t qHash(ModelIndexData data, size_t seed = 0)
+{
+    return qHashMulti(seed, data.row, data.column);
+}
 /*! Transport protocol representation of a QModelIndex. */
 using ModelIndex = QVector<ModelIndexData>;
 
@@ -135,6 +151,39 @@ GAMMARAY_COMMON_EXPORT ModelIndex fromQModelIndex(const QModelIndex &index);
 /*! Deserializes a QModelIndex. */
 GAMMARAY_COMMON_EXPORT QModelIndex toQModelIndex(const QAbstractItemModel *model,
                                                  const ModelIndex &index);
+
+/*! Transport protocol representation of a model index within a sequence of indexes,
+ *  relative to its predecessor in that sequence.
+ *  @see ModelIndexEncoder, ModelIndexDecoder
+ */
+struct RelativeModelIndex
+{
+    quint16 commonPrefix = 0; // number of leading path elements shared with the previous index
+    ModelIndex suffix; // the remaining path elements
+};
+
+/*! Encodes a sequence of model indexes sent in a single message.
+ *  Each index only carries the part of its path it does not share with the previous index,
+ *  which for batched requests or replies of sibling cells in deep trees is a single element.
+ */
+class GAMMARAY_COMMON_EXPORT ModelIndexEncoder
+{
+public:
+    RelativeModelIndex encode(const ModelIndex &index);
+
+private:
+    ModelIndex m_previous;
+};
+
+/*! Decodes a sequence of model indexes encoded with ModelIndexEncoder. */
+class GAMMARAY_COMMON_EXPORT ModelIndexDecoder
+{
+public:
+    ModelIndex decode(const RelativeModelIndex &index);
+
+private:
+    ModelIndex m_previous;
+};
 ///@endcond
 
 /*! Protocol version, must match exactly between client and server. */
@@ -158,6 +207,24 @@ inline QDataStream &operator<<(QDataStream &s, const GammaRay::Protocol::ModelIn
     return s;
 }
 
+inline QDataStream &operator>>(QDataStream &s, GammaRay::Protocol::RelativeModelIndex &index)
+{
+    quint16 size;
+    s >> index.commonPrefix >> size;
+    index.suffix.resize(size);
+    for (auto &data : index.suffix)
+        s >> data;
+    return s;
+}
+inline QDataStream &operator<<(QDataStream &s, const GammaRay::Protocol::RelativeModelIndex &index)
+{
+    Q_ASSERT(index.suffix.size() <= std::numeric_limits<quint16>::max());
+    s << index.commonPrefix << quint16(index.suffix.size());
+    for (const auto &data : index.suffix)
+        s << data;
+    return s;
+}
+
 inline QDebug &operator<<(QDebug &s, const GammaRay::Protocol::ModelIndexData &data)
 {
     s << '(' << data.row << ',' << data.column << ')';
@@ -12,10 +12,71 @@
 */
 
 #include "remoteviewframe.h"
+#include "remoteviewframecodec.h"
 
 #include <QDataStream>
 
+#include <algorithm>
+#include <vector>
+
 namespace GammaRay {
+static const int MaximumDownscaleFactor = 16; // keeps the column sums of 8 bit channels within 16 bit
+
+// averages blocks of factor x factor pixels, for formats with four 8 bit channels
+// both passes are plain loops over bytes, which the compiler can vectorize
+static QImage boxDownscaled(const QImage &image, int factor)
+{
+    const int width = (image.width() + factor - 1) / factor;
+    const int height = (image.height() + factor - 1) / factor;
+    const auto devicePixelRatio = image.devicePixelRatio() / factor;
+
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        break;
+    default: {
+        auto scaled = image.scaled(width, height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        scaled.setDevicePixelRatio(devicePixelRatio);
+        return scaled;
+    }
+    }
+
+    QImage result(width, height, image.format());
+    const int lineSize = image.width() * 4;
+    std::vector<quint16> columnSums(lineSize);
+    for (int y = 0; y < height; ++y) {
+        const int firstRow = y * factor;
+        const int rows = std::min(factor, image.height() - firstRow);
+
+        std::fill(columnSums.begin(), columnSums.end(), 0);
+        for (int row = firstRow; row < firstRow + rows; ++row) {
+            const auto in = image.constScanLine(row);
+            for (int i = 0; i < lineSize; ++i)
+                columnSums[i] += in[i];
+        }
+
+        auto out = result.scanLine(y);
+        for (int x = 0; x < width; ++x) {
+            const int columns = std::min(factor, image.width() - x * factor);
+            const quint32 count = columns * rows;
+            const auto block = columnSums.data() + x * factor * 4;
+            for (int channel = 0; channel < 4; ++channel) {
+                quint32 sum = 0;
+                for (int column = 0; column < columns; ++column)
+                    sum += block[column * 4 + channel];
+                out[x * 4 + channel] = (sum + count / 2) / count;
+            }
+        }
+    }
+
+    result.setDevicePixelRatio(devicePixelRatio);
+    return result;
+}
+
 bool RemoteViewFrame::isValid() const
 {
     return !m_image.image().isNull();
@@ -68,6 +129,38 @@ void RemoteViewFrame::setImage(const QImage &image, const QTransform &transform)
     m_image.setTransform(transform);
 }
 
+void RemoteViewFrame::downscaleImage(int factor)
+{
+    factor = std::min(factor, MaximumDownscaleFactor);
+    if (factor < 2 || m_image.image().isNull())
+        return;
+    m_image.setImage(boxDownscaled(m_image.image(), factor));
+}
+
+bool RemoteViewFrame::isEncoded() const
+{
+    return !m_image.encodedImage().isEmpty();
+}
+
+void RemoteViewFrame::encodeImage(RemoteViewFrameEncoder *encoder)
+{
+    const auto data = encoder->encode(m_image.image());
+    if (data.isEmpty())
+        return;
+    m_image.setImage(QImage());
+    m_image.setEncodedImage(data);
+}
+
+bool RemoteViewFrame::decodeImage(RemoteViewFrameDecoder *decoder)
+{
+    const auto image = decoder->decode(m_image.encodedImage());
+    if (image.isNull())
+        return false;
+    m_image.setImage(image);
+    m_image.setEncodedImage(QByteArray());
+    return true;
+}
+
 QDataStream &operator<<(QDataStream &stream, const RemoteViewFrame &frame)
 {
     stream << frame.m_image << frame.data << frame.m_viewRect << frame.m_sceneRect;
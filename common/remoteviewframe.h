@@ -24,6 +24,8 @@
 
 namespace GammaRay {
 class RemoteViewFrame;
+class RemoteViewFrameDecoder;
+class RemoteViewFrameEncoder;
 
 GAMMARAY_COMMON_EXPORT QDataStream &operator<<(QDataStream &stream, const GammaRay::RemoteViewFrame &frame);
 GAMMARAY_COMMON_EXPORT QDataStream &operator>>(QDataStream &stream, GammaRay::RemoteViewFrame &frame);
@@ -46,6 +48,16 @@ public:
     void setImage(const QImage &image);
     void setImage(const QImage &image, const QTransform &transform);
 
+    /// reduces the image resolution by @p factor (at most 16) in both directions, keeping its logical size
+    void downscaleImage(int factor);
+
+    /// the image is transferred encoded, and needs to be decoded before use
+    bool isEncoded() const;
+    /// replaces the image by its encoding, if @p encoder supports the image format
+    void encodeImage(RemoteViewFrameEncoder *encoder);
+    /// replaces the encoding by the decoded image, returns @c false if that failed
+    bool decodeImage(RemoteViewFrameDecoder *decoder);
+
     /// tool specific frame data
     QVariant data;
 
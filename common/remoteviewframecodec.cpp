@@ -0,0 +1,198 @@
+/*
+  remoteviewframecodec.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "remoteviewframecodec.h"
+
+#include "lz4/lz4.h" // 3rdparty
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QVector>
+
+#include <cstring>
+
+using namespace GammaRay;
+
+namespace {
+enum Flag : quint8
+{
+    KeyFrame = 1
+};
+
+// large enough to keep the per tile overhead low, small enough to not send much unchanged content
+static const int TileSize = 64;
+
+int tileColumns(const QImage &image)
+{
+    return (image.width() + TileSize - 1) / TileSize;
+}
+
+int tileCount(const QImage &image)
+{
+    return tileColumns(image) * ((image.height() + TileSize - 1) / TileSize);
+}
+
+QRect tileRect(const QImage &image, int tile)
+{
+    const int columns = tileColumns(image);
+    return QRect((tile % columns) * TileSize, (tile / columns) * TileSize, TileSize, TileSize).intersected(image.rect());
+}
+
+bool tileChanged(const QImage &image, const QImage &previous, const QRect &rect, int bytesPerPixel)
+{
+    const auto offset = rect.x() * bytesPerPixel;
+    const auto size = rect.width() * bytesPerPixel;
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        if (memcmp(image.constScanLine(y) + offset, previous.constScanLine(y) + offset, size) != 0)
+            return true;
+    }
+    return false;
+}
+}
+
+QByteArray RemoteViewFrameEncoder::encode(const QImage &image)
+{
+    if (image.isNull() || image.depth() % 8 != 0)
+        return QByteArray();
+
+    const bool keyFrame = image.size() != m_previous.size() || image.format() != m_previous.format()
+        || image.devicePixelRatio() != m_previous.devicePixelRatio();
+    const int bytesPerPixel = image.depth() / 8;
+
+    QVector<quint32> tiles;
+    QByteArray data;
+    if (keyFrame) {
+        const qsizetype lineSize = qsizetype(image.width()) * bytesPerPixel;
+        data.resize(lineSize * image.height());
+        for (int y = 0; y < image.height(); ++y)
+            memcpy(data.data() + y * lineSize, image.constScanLine(y), lineSize);
+    } else {
+        for (int tile = 0; tile < tileCount(image); ++tile) {
+            const auto rect = tileRect(image, tile);
+            if (!tileChanged(image, m_previous, rect, bytesPerPixel))
+                continue;
+            tiles.push_back(tile);
+
+            // unchanged pixels within the tile become zeros, which compress very well
+            const auto offset = rect.x() * bytesPerPixel;
+            const auto size = rect.width() * bytesPerPixel;
+            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                const auto current = image.constScanLine(y) + offset;
+                const auto previous = m_previous.constScanLine(y) + offset;
+                const auto start = data.size();
+                data.resize(start + size);
+                auto out = reinterpret_cast<uchar *>(data.data() + start);
+                for (int i = 0; i < size; ++i)
+                    out[i] = current[i] ^ previous[i];
+            }
+        }
+    }
+
+    if (data.size() > LZ4_MAX_INPUT_SIZE)
+        return QByteArray();
+    QByteArray compressed;
+    if (!data.isEmpty()) {
+        compressed.resize(LZ4_compressBound(data.size()));
+        const int size = LZ4_compress_default(data.constData(), compressed.data(), data.size(), compressed.size());
+        if (size <= 0)
+            return QByteArray();
+        compressed.resize(size);
+    }
+
+    QByteArray encoded;
+    QDataStream stream(&encoded, QIODevice::WriteOnly);
+    stream << quint8(keyFrame ? KeyFrame : 0) << ++m_frameNumber
+           << quint32(image.format()) << quint32(image.width()) << quint32(image.height()) << image.devicePixelRatio()
+           << tiles << qint32(data.size()) << compressed;
+    m_previous = image;
+    return encoded;
+}
+
+void RemoteViewFrameEncoder::reset()
+{
+    m_previous = QImage();
+}
+
+QImage RemoteViewFrameDecoder::decode(const QByteArray &data)
+{
+    quint8 flags;
+    quint32 frameNumber, format, width, height;
+    double devicePixelRatio;
+    QVector<quint32> tiles;
+    qint32 size;
+    QByteArray compressed;
+
+    QDataStream stream(data);
+    stream >> flags >> frameNumber >> format >> width >> height >> devicePixelRatio >> tiles >> size >> compressed;
+    if (stream.status() != QDataStream::Ok || format == QImage::Format_Invalid || format >= QImage::NImageFormats || size < 0) {
+        reset();
+        return QImage();
+    }
+
+    const bool keyFrame = flags & KeyFrame;
+    if (!keyFrame
+        && (m_image.isNull() || frameNumber != m_frameNumber + 1 || m_image.format() != QImage::Format(format)
+            || m_image.size() != QSize(width, height))) {
+        reset();
+        return QImage();
+    }
+
+    QByteArray raw(size, Qt::Uninitialized);
+    if (size > 0 && LZ4_decompress_safe(compressed.constData(), raw.data(), compressed.size(), size) != size) {
+        reset();
+        return QImage();
+    }
+
+    if (keyFrame) {
+        QImage image(width, height, QImage::Format(format));
+        const qsizetype lineSize = qsizetype(image.width()) * (image.depth() / 8);
+        if (image.isNull() || image.depth() % 8 != 0 || raw.size() != lineSize * image.height()) {
+            reset();
+            return QImage();
+        }
+        for (int y = 0; y < image.height(); ++y)
+            memcpy(image.scanLine(y), raw.constData() + y * lineSize, lineSize);
+        image.setDevicePixelRatio(devicePixelRatio);
+        m_image = image;
+    } else {
+        const int bytesPerPixel = m_image.depth() / 8;
+        auto in = reinterpret_cast<const uchar *>(raw.constData());
+        const auto end = in + raw.size();
+        for (const auto tile : std::as_const(tiles)) {
+            if (tile >= quint32(tileCount(m_image))) {
+                reset();
+                return QImage();
+            }
+            const auto rect = tileRect(m_image, tile);
+            const auto offset = rect.x() * bytesPerPixel;
+            const auto lineSize = rect.width() * bytesPerPixel;
+            if (end - in < qsizetype(lineSize) * rect.height()) {
+                reset();
+                return QImage();
+            }
+            for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                auto out = m_image.scanLine(y) + offset;
+                for (int i = 0; i < lineSize; ++i)
+                    out[i] ^= in[i];
+                in += lineSize;
+            }
+        }
+    }
+
+    m_frameNumber = frameNumber;
+    return m_image;
+}
+
+void RemoteViewFrameDecoder::reset()
+{
+    m_image = QImage();
+}
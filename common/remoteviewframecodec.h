@@ -0,0 +1,64 @@
+/*
+  remoteviewframecodec.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_REMOTEVIEWFRAMECODEC_H
+#define GAMMARAY_REMOTEVIEWFRAMECODEC_H
+
+#include "gammaray_common_export.h"
+
+#include <QByteArray>
+#include <QImage>
+
+namespace GammaRay {
+/** @brief Encodes remote view frame images relative to the previously encoded one.
+ *
+ *  The image is split into tiles, and only the tiles that differ from the previous image are
+ *  transmitted, XOR'ed with their previous content and LZ4 compressed. Size, format or device
+ *  pixel ratio changes result in a key frame containing the entire image.
+ *
+ *  Each encoded image can only be decoded by a RemoteViewFrameDecoder that decoded all
+ *  images since the last key frame.
+ *
+ *  @since 3.4
+ */
+class GAMMARAY_COMMON_EXPORT RemoteViewFrameEncoder
+{
+public:
+    /** Returns an empty array if the image format is not supported. */
+    QByteArray encode(const QImage &image);
+    /** Makes the next encoded image a key frame. */
+    void reset();
+
+private:
+    QImage m_previous;
+    quint32 m_frameNumber = 0;
+};
+
+/** @brief Decodes images encoded by RemoteViewFrameEncoder.
+ *  @since 3.4
+ */
+class GAMMARAY_COMMON_EXPORT RemoteViewFrameDecoder
+{
+public:
+    /** Returns a null image if @p data is invalid or relative to an image we have not seen.
+     *  In that case, only a key frame can be decoded next.
+     */
+    QImage decode(const QByteArray &data);
+    void reset();
+
+private:
+    QImage m_image;
+    quint32 m_frameNumber = 0;
+};
+}
+
+#endif // GAMMARAY_REMOTEVIEWFRAMECODEC_H
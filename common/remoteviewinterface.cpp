@@ -25,6 +25,7 @@ Q_DECLARE_METATYPE(QPainterPath) // needed for Qt5
 using namespace GammaRay;
 QT_BEGIN_NAMESPACE
 GAMMARAY_ENUM_STREAM_OPERATORS(RemoteViewInterface::RequestMode)
+GAMMARAY_ENUM_STREAM_OPERATORS(RemoteViewInterface::FrameCodec)
 
 QDataStream &operator<<(QDataStream &s, GammaRay::RemoteViewInterface::TouchPointStates states)
 {
@@ -139,6 +140,7 @@ RemoteViewInterface::RemoteViewInterface(const QString &name, QObject *parent)
     qRegisterMetaType<RemoteViewInterface::TouchPointStates>();
 
     StreamOperators::registerOperators<RequestMode>();
+    StreamOperators::registerOperators<FrameCodec>();
     StreamOperators::registerOperators<GammaRay::RemoteViewFrame>();
     StreamOperators::registerOperators<RemoteViewInterface::TouchPointStates>();
     StreamOperators::registerOperators<QList<QTouchEvent::TouchPoint>>();
@@ -36,6 +36,13 @@ public:
         RequestAll
     };
 
+    /// How frame images are transferred to the client.
+    enum FrameCodec
+    {
+        RawFrames,
+        TileDeltaFrames ///< changed tiles only, see RemoteViewFrameEncoder
+    };
+
     explicit RemoteViewInterface(const QString &name, QObject *parent = nullptr);
 
     QString name() const;
@@ -60,6 +67,9 @@ public slots:
                                 const QList<QTouchEvent::TouchPoint> &touchPoints) = 0;
 
     virtual void sendUserViewport(const QRectF &userViewport) = 0;
+    /// Device pixels per source pixel the client displays frames at, frames may be downscaled
+    /// to that before being sent. 0 requests full resolution frames.
+    virtual void sendUserScale(double scale) = 0;
 
     virtual void setViewActive(bool active) = 0;
 
@@ -68,6 +78,13 @@ public slots:
 
     virtual void requestCompleteFrame() = 0;
 
+    /// Tell the server which frame encoding we can decode. This also makes the next frame a key frame.
+    virtual void setFrameCodec(GammaRay::RemoteViewInterface::FrameCodec codec) = 0;
+
+    /// Tell the server we couldn't decode the last frame, the next one has to be a key frame,
+    /// even if nothing changed meanwhile.
+    virtual void requestKeyFrame() = 0;
+
 signals:
     void reset();
     void elementsAtReceived(const QList<GammaRay::ObjectId> &ids, int bestCandidate);
@@ -83,6 +100,7 @@ Q_DECLARE_METATYPE(QTouchEvent::TouchPoint)
 Q_DECLARE_METATYPE(GammaRay::RemoteViewInterface::TouchPointStates)
 Q_DECLARE_METATYPE(QList<QTouchEvent::TouchPoint>)
 Q_DECLARE_METATYPE(GammaRay::RemoteViewInterface::RequestMode)
+Q_DECLARE_METATYPE(GammaRay::RemoteViewInterface::FrameCodec)
 
 Q_DECLARE_METATYPE(QPointingDevice::PointerType)
 Q_DECLARE_METATYPE(QPointingDeviceUniqueId)
@@ -42,9 +42,19 @@ void TransferImage::setTransform(const QTransform &transform)
     m_transform = transform;
 }
 
+QByteArray TransferImage::encodedImage() const
+{
+    return m_encodedImage;
+}
+
+void TransferImage::setEncodedImage(const QByteArray &data)
+{
+    m_encodedImage = data;
+}
+
 QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image)
 {
-    static const TransferImage::Format format = TransferImage::RawFormat;
+    const TransferImage::Format format = image.encodedImage().isEmpty() ? TransferImage::RawFormat : TransferImage::EncodedFormat;
 
     const QImage &img = image.image();
     stream << ( quint32 )(format);
@@ -57,6 +67,9 @@ QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &imag
         stream << ( quint32 )img.format() << ( quint32 )img.width() << ( quint32 )img.height() << image.transform();
         stream.device()->write(( const char * )img.constBits(), img.sizeInBytes());
         break;
+    case TransferImage::EncodedFormat:
+        stream << image.transform() << image.encodedImage();
+        break;
     }
 
     return stream;
@@ -91,6 +104,15 @@ QDataStream &operator>>(QDataStream &stream, TransferImage &image)
         image.setTransform(transform);
         break;
     }
+    case TransferImage::EncodedFormat: {
+        QTransform transform;
+        QByteArray data;
+        stream >> transform >> data;
+        image.setImage(QImage());
+        image.setTransform(transform);
+        image.setEncodedImage(data);
+        break;
+    }
     }
 
     return stream;
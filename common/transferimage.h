@@ -32,15 +32,21 @@ public:
     QTransform transform() const;
     void setTransform(const QTransform &transform);
 
+    /** Image data encoded with RemoteViewFrameEncoder, transferred instead of the image if set. */
+    QByteArray encodedImage() const;
+    void setEncodedImage(const QByteArray &data);
+
     enum Format
     {
         QImageFormat,
-        RawFormat
+        RawFormat,
+        EncodedFormat
     };
 
 private:
     QImage m_image;
     QTransform m_transform;
+    QByteArray m_encodedImage;
 };
 
 QDataStream &operator<<(QDataStream &stream, const GammaRay::TransferImage &image);
@@ -14,8 +14,15 @@
 #include <config-gammaray.h>
 #include "execution.h"
 
+#include "probeguard.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QThread>
 #include <QtGlobal>
 
+#include <algorithm>
+
 #if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID) && defined(HAVE_BACKTRACE)
 #include <backward.hpp>
 #define USE_BACKWARD_CPP
@@ -119,6 +126,31 @@ Execution::Trace Execution::stackTrace(int maxDepth, int skip)
     return t;
 }
 
+static void *const *frameAddresses(const Execution::TraceData &data)
+{
+#ifdef USE_BACKWARD_CPP
+    return data.begin();
+#else
+    return data.constData();
+#endif
+}
+
+bool Execution::Trace::operator==(const Trace &other) const
+{
+    if (d == other.d)
+        return true;
+    if (size() != other.size())
+        return false;
+    const auto frames = frameAddresses(TracePrivate::get(*this));
+    return std::equal(frames, frames + size(), frameAddresses(TracePrivate::get(other)));
+}
+
+size_t Execution::qHash(const Trace &trace, size_t seed)
+{
+    const auto frames = frameAddresses(TracePrivate::get(trace));
+    return qHashRange(frames, frames + trace.size(), seed);
+}
+
 #ifdef USE_BACKWARD_CPP
 static backward::TraceResolver *resolver()
 {
@@ -178,55 +210,108 @@ static QString maybeDemangleName(char *name)
 }
 #endif
 
-Execution::ResolvedFrame Execution::resolveOne(const Execution::Trace &trace, int index)
+// frame addresses never change their meaning, so we can keep resolved frames for the process lifetime
+struct FrameCache
+{
+    QMutex mutex;
+    QHash<void *, Execution::ResolvedFrame> frames;
+};
+Q_GLOBAL_STATIC(FrameCache, s_frameCache)
+// the resolvers are not thread-safe
+Q_GLOBAL_STATIC(QMutex, s_resolverMutex)
+
+// resolves the frames at @p indexes of @p trace, bypassing the cache
+static QVector<Execution::ResolvedFrame> resolveUncached(const Execution::Trace &trace, const QVector<int> &indexes)
 {
-    ResolvedFrame frame;
-    if (index >= trace.size())
-        return frame;
+    QVector<Execution::ResolvedFrame> frames;
+    frames.reserve(indexes.size());
+    QMutexLocker lock(s_resolverMutex());
 
 #ifdef USE_BACKWARD_CPP
-    auto &st = TracePrivate::get(trace);
+    auto &st = Execution::TracePrivate::get(trace);
     resolver()->load_stacktrace(st);
-    frame = toResolvedFrame(resolver()->resolve(st[index]), st[index].addr);
+    for (int i : indexes)
+        frames.push_back(toResolvedFrame(resolver()->resolve(st[i]), st[i].addr));
 
 #elif defined(HAVE_BACKTRACE)
-    const auto &v = TracePrivate::get(trace);
-    char **strings = backtrace_symbols(v.data() + index, 1);
-    frame.name = maybeDemangleName(strings[0]);
+    const auto &v = Execution::TracePrivate::get(trace);
+    QVector<void *> addresses;
+    addresses.reserve(indexes.size());
+    for (int i : indexes)
+        addresses.push_back(v.at(i));
+    char **strings = backtrace_symbols(addresses.data(), addresses.size());
+    for (int i = 0; i < addresses.size(); ++i) {
+        Execution::ResolvedFrame frame;
+        frame.name = maybeDemangleName(strings[i]);
+        frames.push_back(frame);
+    }
     free(strings);
 
 #else
     Q_UNUSED(trace);
-    Q_UNUSED(index);
+    frames.resize(indexes.size());
 #endif
-    return frame;
+    return frames;
 }
 
-QVector<Execution::ResolvedFrame> Execution::resolveAll(const Execution::Trace &trace)
+// looks up the frames in [begin, end) of @p trace in the cache, returns the indexes of the missing ones
+static QVector<int> lookupCached(const Execution::Trace &trace, int begin, int end, QVector<Execution::ResolvedFrame> &frames)
 {
-    QVector<ResolvedFrame> frames;
-    frames.reserve(trace.size());
-
-#ifdef USE_BACKWARD_CPP
-    auto &st = TracePrivate::get(trace);
-    resolver()->load_stacktrace(st);
-    for (int i = 0; i < trace.size(); ++i)
-        frames.push_back(toResolvedFrame(resolver()->resolve(st[i]), st[i].addr));
-
-#elif defined(HAVE_BACKTRACE)
-    const auto &v = TracePrivate::get(trace);
-    char **strings = backtrace_symbols(v.data(), v.size());
-    for (int i = 0; i < v.size(); ++i) {
-        ResolvedFrame frame;
-        frame.name = maybeDemangleName(strings[i]);
-        frames.push_back(frame);
+    const auto addresses = frameAddresses(Execution::TracePrivate::get(trace));
+    QVector<int> missing;
+    frames.resize(end - begin);
+
+    auto cache = s_frameCache();
+    QMutexLocker lock(&cache->mutex);
+    for (int i = begin; i < end; ++i) {
+        const auto it = cache->frames.constFind(addresses[i]);
+        if (it != cache->frames.constEnd())
+            frames[i - begin] = it.value();
+        else
+            missing.push_back(i);
     }
-    free(strings);
+    return missing;
+}
 
-#endif
+static QVector<Execution::ResolvedFrame> resolveRange(const Execution::Trace &trace, int begin, int end)
+{
+    QVector<Execution::ResolvedFrame> frames;
+    const auto missing = lookupCached(trace, begin, end, frames);
+    if (missing.isEmpty())
+        return frames;
+
+    const auto resolved = resolveUncached(trace, missing);
+    const auto addresses = frameAddresses(Execution::TracePrivate::get(trace));
+    auto cache = s_frameCache();
+    QMutexLocker lock(&cache->mutex);
+    for (int i = 0; i < missing.size(); ++i) {
+        frames[missing.at(i) - begin] = resolved.at(i);
+        cache->frames.insert(addresses[missing.at(i)], resolved.at(i));
+    }
     return frames;
 }
 
+Execution::ResolvedFrame Execution::resolveOne(const Execution::Trace &trace, int index)
+{
+    if (index < 0 || index >= trace.size())
+        return ResolvedFrame();
+    return resolveRange(trace, index, index + 1).at(0);
+}
+
+QVector<Execution::ResolvedFrame> Execution::resolveAll(const Execution::Trace &trace)
+{
+    return resolveRange(trace, 0, trace.size());
+}
+
+bool Execution::resolveAllCached(const Execution::Trace &trace, QVector<ResolvedFrame> &frames)
+{
+    QVector<ResolvedFrame> cached;
+    if (!lookupCached(trace, 0, trace.size(), cached).isEmpty())
+        return false;
+    frames = std::move(cached);
+    return true;
+}
+
 // END Unix specific code
 #else
 // BEGIN Windows specific code
@@ -333,6 +418,25 @@ QVector<Execution::ResolvedFrame> Execution::resolveAll(const Execution::Trace &
     return frames;
 }
 
+bool Execution::resolveAllCached(const Execution::Trace &trace, QVector<ResolvedFrame> &frames)
+{
+    // resolved right away when creating the trace
+    frames = resolveAll(trace);
+    return true;
+}
+
+// frames are resolved right away here, so there is no cheap way to compare them
+bool Execution::Trace::operator==(const Trace &other) const
+{
+    return d == other.d;
+}
+
+size_t Execution::qHash(const Trace &trace, size_t seed)
+{
+    // good enough, construction traces are not recorded on this platform
+    return ::qHash(trace.size(), seed);
+}
+
 // END Windows specific Code
 #endif
 
@@ -376,4 +480,65 @@ int Trace::size() const
 
 }
 }
+
+namespace {
+// a single request for resolveAllAsync(), processed in the resolver thread
+class ResolveJob : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResolveJob(const Execution::Trace &trace)
+        : m_trace(trace)
+    {
+    }
+
+    void run()
+    {
+        emit finished(Execution::resolveAll(m_trace));
+        deleteLater();
+    }
+
+signals:
+    void finished(const QVector<GammaRay::Execution::ResolvedFrame> &frames);
+
+private:
+    Execution::Trace m_trace;
+};
+
+class ResolverThread : public QThread
+{
+public:
+    ResolverThread()
+    {
+        setObjectName(QStringLiteral("GammaRay symbol resolver"));
+        start(QThread::LowPriority);
+    }
+    ~ResolverThread() override
+    {
+        quit();
+        wait();
+    }
+};
+}
+
+Q_GLOBAL_STATIC(ResolverThread, s_resolverThread)
+
+void Execution::resolveAllAsync(const Trace &trace, QObject *context,
+                                const std::function<void(const QVector<ResolvedFrame> &)> &callback)
+{
+    // already shutting down
+    if (s_resolverThread.isDestroyed()) {
+        callback(resolveAll(trace));
+        return;
+    }
+
+    ProbeGuard guard;
+    auto job = new ResolveJob(trace);
+    // queued connections are dropped when context gets destroyed, so there is no need to track it
+    QObject::connect(job, &ResolveJob::finished, context, callback, Qt::QueuedConnection);
+    job->moveToThread(s_resolverThread());
+    QMetaObject::invokeMethod(job, &ResolveJob::run, Qt::QueuedConnection);
+}
 // END generic code
+
+#include "execution.moc"
@@ -21,8 +21,13 @@
 #include <QMetaType>
 #include <QVector>
 
+#include <functional>
 #include <memory>
 
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 
 /*! Functions to inspect the current program execution. */
@@ -54,11 +59,25 @@ public:
     bool empty() const;
     int size() const;
 
+    /*! Traces are equal if they consist of the same frames.
+     *  @since 3.4
+     */
+    bool operator==(const Trace &other) const;
+    bool operator!=(const Trace &other) const
+    {
+        return !operator==(other);
+    }
+
 private:
     friend class TracePrivate;
     std::shared_ptr<TracePrivate> d;
 };
 
+/*! Hash function for Trace, consistent with Trace::operator==.
+ *  @since 3.4
+ */
+GAMMARAY_CORE_EXPORT size_t qHash(const Trace &trace, size_t seed = 0);
+
 /*! Create a backtrace.
  *  @param maxDepth The maximum amount of frames to trace
  *  @param skip The amount of frames to skip from the beginning. This is useful to
@@ -76,11 +95,30 @@ public:
     SourceLocation location;
 };
 
-/*! Resolve a single backtrace frame. */
+/*! Resolve a single backtrace frame.
+ *  Resolved frames are cached process-wide, resolving the same address again is cheap.
+ */
 GAMMARAY_CORE_EXPORT ResolvedFrame resolveOne(const Trace &trace, int index);
-/*! Resolve an entire backtrace. */
+/*! Resolve an entire backtrace.
+ *  Resolved frames are cached process-wide, only frames not seen before are actually resolved.
+ */
 GAMMARAY_CORE_EXPORT QVector<ResolvedFrame> resolveAll(const Trace &trace);
 
+/*! Resolves an entire backtrace, if that is possible without actually resolving any frame.
+ *  That is, if all frames of @p trace are in the cache already.
+ *  @returns @c false if @p trace has unresolved frames, @p frames is left untouched in that case.
+ *  @since 3.4
+ */
+GAMMARAY_CORE_EXPORT bool resolveAllCached(const Trace &trace, QVector<ResolvedFrame> &frames);
+
+/*! Resolves an entire backtrace in a worker thread.
+ *  @p callback is invoked with the result in the thread of @p context, unless
+ *  @p context got destroyed meanwhile.
+ *  @since 3.4
+ */
+GAMMARAY_CORE_EXPORT void resolveAllAsync(const Trace &trace, QObject *context,
+                                          const std::function<void(const QVector<ResolvedFrame> &)> &callback);
+
 }
 
 }
@@ -15,6 +15,7 @@
 
 #include <core/execution.h>
 #include <core/probe.h>
+#include <core/probesettings.h>
 #include <core/qmetaobjectvalidator.h>
 
 #include <common/metatypedeclarations.h>
@@ -89,35 +90,64 @@ hasDynamicMetaObject(const QObject *object)
 
 MetaObjectRegistry::MetaObjectRegistry(QObject *parent)
     : QObject(parent)
+    , m_updateTimer(new QTimer(this))
+    , m_updateInterval(ProbeSettings::value(QStringLiteral("MetaObjectRegistryUpdateInterval"), 100).toInt())
 {
     qRegisterMetaType<const QMetaObject *>();
+
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(std::max(0, m_updateInterval));
+    connect(m_updateTimer, &QTimer::timeout, this, &MetaObjectRegistry::flushDataChanged);
+
     scanMetaTypes();
 }
 
 MetaObjectRegistry::~MetaObjectRegistry() = default;
 
+int MetaObjectRegistry::updateInterval() const
+{
+    return m_updateInterval;
+}
+
+void MetaObjectRegistry::setUpdateInterval(int msecs)
+{
+    m_updateInterval = msecs;
+    m_updateTimer->setInterval(std::max(0, msecs));
+    if (msecs < 0)
+        flushDataChanged();
+}
+
+const MetaObjectRegistry::MetaObjectInfo *MetaObjectRegistry::infoFor(const QMetaObject *metaObject) const
+{
+    const auto it = m_metaObjectIds.constFind(metaObject);
+    if (it == m_metaObjectIds.constEnd())
+        return nullptr;
+    return &m_metaObjectInfos[it.value()];
+}
+
 QVariant MetaObjectRegistry::data(const QMetaObject *metaObject, MetaObjectData type) const
 {
+    const auto info = infoFor(metaObject);
     switch (type) {
     case ClassName:
-        return m_metaObjectInfoMap.value(metaObject).className;
+        return info ? info->className : QByteArray();
     case Valid:
         return isValid(metaObject);
     case SelfCount:
-        if (inheritsQObject(metaObject))
-            return m_metaObjectInfoMap.value(metaObject).selfCount;
+        if (info && info->inheritsQObject)
+            return info->selfCount;
         return QStringLiteral("-");
     case InclusiveCount:
-        if (inheritsQObject(metaObject))
-            return m_metaObjectInfoMap.value(metaObject).inclusiveCount;
+        if (info && info->inheritsQObject)
+            return info->inclusiveCount;
         return QStringLiteral("-");
     case SelfAliveCount:
-        if (inheritsQObject(metaObject))
-            return m_metaObjectInfoMap.value(metaObject).selfAliveCount;
+        if (info && info->inheritsQObject)
+            return info->selfAliveCount;
         return QStringLiteral("-");
     case InclusiveAliveCount:
-        if (inheritsQObject(metaObject))
-            return m_metaObjectInfoMap.value(metaObject).inclusiveAliveCount;
+        if (info && info->inheritsQObject)
+            return info->inclusiveAliveCount;
         return QStringLiteral("-");
     }
     return QVariant();
@@ -125,18 +155,14 @@ QVariant MetaObjectRegistry::data(const QMetaObject *metaObject, MetaObjectData
 
 bool MetaObjectRegistry::isValid(const QMetaObject *metaObject) const
 {
-    const auto it = m_metaObjectInfoMap.constFind(metaObject);
-    if (it == m_metaObjectInfoMap.constEnd())
-        return false;
-    return !(*it).invalid;
+    const auto info = infoFor(metaObject);
+    return info && !info->invalid;
 }
 
 bool MetaObjectRegistry::isStatic(const QMetaObject *metaObject) const
 {
-    const auto it = m_metaObjectInfoMap.constFind(metaObject);
-    if (it == m_metaObjectInfoMap.constEnd())
-        return false;
-    return (*it).isStatic;
+    const auto info = infoFor(metaObject);
+    return info && info->isStatic;
 }
 
 const QMetaObject *MetaObjectRegistry::parentOf(const QMetaObject *metaObject) const
@@ -149,17 +175,6 @@ QVector<const QMetaObject *> MetaObjectRegistry::childrenOf(const QMetaObject *m
     return m_parentChildMap.value(metaObject);
 }
 
-bool MetaObjectRegistry::inheritsQObject(const QMetaObject *metaObject) const
-{
-    while (metaObject) {
-        if (metaObject == &QObject::staticMetaObject)
-            return true;
-        metaObject = m_childParentMap.value(metaObject);
-    }
-
-    return false;
-}
-
 void MetaObjectRegistry::objectAdded(QObject *obj)
 {
     // Probe::objectFullyConstructed calls us and ensures this already
@@ -168,8 +183,20 @@ void MetaObjectRegistry::objectAdded(QObject *obj)
 
     Q_ASSERT(!obj->parent() || Probe::instance()->isValidObject(obj->parent()));
 
+    // a single lookup for known meta objects, and dynamic meta objects seen before
+    // don't need to be merged by name again
     const QMetaObject *metaObject = obj->metaObject();
-    metaObject = addMetaObject(metaObject, hasDynamicMetaObject(obj));
+    auto idIt = m_metaObjectIds.constFind(metaObject);
+    if (idIt == m_metaObjectIds.constEnd()) {
+        const auto canonicalIt = m_canonicalMetaObjectMap.constFind(metaObject);
+        if (canonicalIt != m_canonicalMetaObjectMap.constEnd())
+            metaObject = canonicalIt.value();
+        else
+            metaObject = addMetaObject(metaObject, hasDynamicMetaObject(obj));
+        idIt = m_metaObjectIds.constFind(metaObject);
+        Q_ASSERT(idIt != m_metaObjectIds.constEnd());
+    }
+    const int id = idIt.value();
 
     /*
      * This will increase these values:
@@ -183,22 +210,20 @@ void MetaObjectRegistry::objectAdded(QObject *obj)
      * If this yields some performance issues, we might need to remove the inclusive
      * costs calculation altogether (a calculate-on-request pattern should be even slower)
      */
-    m_metaObjectMap.insert(obj, metaObject);
-    auto &info = m_metaObjectInfoMap[metaObject];
+    m_metaObjectMap.insert(obj, id);
+    auto &info = m_metaObjectInfos[id];
     ++info.selfCount;
     ++info.selfAliveCount;
     if (info.isDynamic)
         addAliveInstance(obj, metaObject);
 
     // increase inclusive counts
-    const QMetaObject *current = metaObject;
-    while (current) {
-        auto &info = m_metaObjectInfoMap[current];
+    for (int current = id; current >= 0; current = m_metaObjectInfos[current].parent) {
+        auto &info = m_metaObjectInfos[current];
         ++info.inclusiveCount;
         ++info.inclusiveAliveCount;
         info.invalid = false;
-        emit dataChanged(current);
-        current = parentOf(current);
+        markChanged(current);
     }
 }
 
@@ -304,10 +329,17 @@ const QMetaObject *MetaObjectRegistry::addMetaObject(const QMetaObject *metaObje
         m_metaObjectNameMap.insert(name, metaObject);
     }
 
-    auto &info = m_metaObjectInfoMap[metaObject];
+    const int id = int(m_metaObjectInfos.size());
+    m_metaObjectInfos.emplace_back();
+    auto &info = m_metaObjectInfos.back();
+    info.metaObject = metaObject;
+    info.parent = parentMetaObject ? m_metaObjectIds.value(parentMetaObject, -1) : -1;
+    info.inheritsQObject = metaObject == &QObject::staticMetaObject
+        || (info.parent >= 0 && m_metaObjectInfos[info.parent].inheritsQObject);
     info.className = metaObject->className();
     info.isStatic = isStatic;
     info.isDynamic = !isStatic && mergeDynamic;
+    m_metaObjectIds.insert(metaObject, id);
     // make the parent immediately retrieveable, so that slots connected to
     // beforeMetaObjectAdded() can use parentOf().
     m_childParentMap.insert(metaObject, parentMetaObject);
@@ -325,12 +357,13 @@ void MetaObjectRegistry::objectRemoved(QObject *obj)
     Q_ASSERT(thread() == QThread::currentThread());
 
     // decrease counter
-    const QMetaObject *metaObject = m_metaObjectMap.take(obj);
-    if (!metaObject)
+    const auto it = m_metaObjectMap.constFind(obj);
+    if (it == m_metaObjectMap.constEnd())
         return;
+    const int id = it.value();
+    m_metaObjectMap.erase(it);
 
-    auto &info = m_metaObjectInfoMap[metaObject];
-    assert(!info.className.isEmpty()); // ie. we found the entry
+    auto &info = m_metaObjectInfos[id];
     if (info.selfAliveCount == 0) {
         // something went wrong, but let's just ignore this event in case of assert
         return;
@@ -339,28 +372,52 @@ void MetaObjectRegistry::objectRemoved(QObject *obj)
     --info.selfAliveCount;
     assert(info.selfAliveCount >= 0);
     if (info.isDynamic)
-        removeAliveInstance(obj, metaObject);
+        removeAliveInstance(obj, info.metaObject);
 
     // decrease inclusive counts
-    const QMetaObject *current = metaObject;
-    while (current) {
-        MetaObjectInfo &info = m_metaObjectInfoMap[current];
+    for (int current = id; current >= 0; current = m_metaObjectInfos[current].parent) {
+        MetaObjectInfo &info = m_metaObjectInfos[current];
         --info.inclusiveAliveCount;
         assert(info.inclusiveAliveCount >= 0);
-        emit dataChanged(current);
-        const QMetaObject *parent = m_childParentMap.value(current);
+        markChanged(current);
         // there is no way to detect when a QMetaObject is getting actually destroyed,
         // so mark them as invalid when there are no objects if that type alive anymore.
         if (info.inclusiveAliveCount == 0 && !info.isStatic) {
             info.invalid = true;
         }
-        current = parent;
+    }
+}
+
+void MetaObjectRegistry::markChanged(int id)
+{
+    auto &info = m_metaObjectInfos[id];
+    if (m_updateInterval < 0) {
+        emit dataChanged(info.metaObject);
+        return;
+    }
+
+    if (info.changed)
+        return;
+    info.changed = true;
+    m_changedMetaObjects.push_back(id);
+    if (!m_updateTimer->isActive())
+        m_updateTimer->start();
+}
+
+void MetaObjectRegistry::flushDataChanged()
+{
+    m_updateTimer->stop();
+    const auto changed = std::move(m_changedMetaObjects);
+    m_changedMetaObjects.clear();
+    for (int id : changed) {
+        m_metaObjectInfos[id].changed = false;
+        emit dataChanged(m_metaObjectInfos[id].metaObject);
     }
 }
 
 bool MetaObjectRegistry::isKnownMetaObject(const QMetaObject *metaObject) const
 {
-    return m_childParentMap.contains(metaObject);
+    return m_metaObjectIds.contains(metaObject);
 }
 
 const QMetaObject *MetaObjectRegistry::aliveInstance(const QMetaObject *metaObject) const
@@ -18,8 +18,20 @@
 #include <QSet>
 #include <QVector>
 
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
 namespace GammaRay {
 
+/** Keeps track of all known QMetaObjects, and the number of instances created for each of them.
+ *
+ *  Instance counts are kept in a flat array indexed by meta object, so tracking an object only
+ *  needs a single hash lookup, independent of the depth of its class hierarchy. Changes of the
+ *  counts are reported via dataChanged() once per update interval, rather than for every object.
+ */
 class MetaObjectRegistry : public QObject
 {
     Q_OBJECT
@@ -52,6 +64,14 @@ public:
 
     const QMetaObject *canonicalMetaObject(const QMetaObject *metaObject) const;
 
+    /** Interval in milliseconds in which changed instance counts are reported via dataChanged().
+     *  Defaults to the @c MetaObjectRegistryUpdateInterval probe setting, or 100ms.
+     *  A negative value reports every change immediately.
+     *  @since 3.4
+     */
+    int updateInterval() const;
+    void setUpdateInterval(int msecs);
+
 public slots:
     void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
@@ -59,11 +79,16 @@ public slots:
 signals:
     void beforeMetaObjectAdded(const QMetaObject *metaObject);
     void afterMetaObjectAdded(const QMetaObject *metaObject);
+    /** Emitted when the instance counts of @p metaObject changed, at most once per update interval. */
     void dataChanged(const QMetaObject *metaObject);
 
 private:
+    struct MetaObjectInfo;
+
     const QMetaObject *addMetaObject(const QMetaObject *metaObject, bool mergeDynamic = false);
-    bool inheritsQObject(const QMetaObject *metaObject) const;
+    const MetaObjectInfo *infoFor(const QMetaObject *metaObject) const;
+    void markChanged(int id);
+    void flushDataChanged();
 
     bool isKnownMetaObject(const QMetaObject *metaObject) const;
     void addAliveInstance(QObject *obj, const QMetaObject *canonicalMO);
@@ -77,6 +102,13 @@ private:
     {
         MetaObjectInfo() = default;
 
+        const QMetaObject *metaObject = nullptr;
+        /// Position of the super class in m_metaObjectInfos, -1 for none
+        int parent = -1;
+        /// @c true if this is QObject, or a class inheriting from it
+        bool inheritsQObject = false;
+        /// @c true while a change is pending to be reported via dataChanged()
+        bool changed = false;
         /// @c true if this is a static meta object that can only become invalid by DLL unloading.
         bool isStatic = false;
         /// @c true if this is a merged dynamic meta object, as e.g. in use by QML
@@ -100,10 +132,12 @@ private:
         /// A copy of QMetaObject::className()
         QByteArray className;
     };
-    QHash<const QMetaObject *, MetaObjectInfo> m_metaObjectInfoMap;
-    /// canonical meta objects at creation time, so we can correctly decrement instance counts
-    /// after destruction
-    QHash<QObject *, const QMetaObject *> m_metaObjectMap;
+    std::vector<MetaObjectInfo> m_metaObjectInfos;
+    /// position in m_metaObjectInfos for every known meta object
+    QHash<const QMetaObject *, int> m_metaObjectIds;
+    /// canonical meta objects at creation time, as position in m_metaObjectInfos, so we can
+    /// correctly decrement instance counts after destruction
+    QHash<QObject *, int> m_metaObjectMap;
     /// name to canonical QMO map, for merging dynamic meta objects as produced by QML
     QHash<QByteArray, const QMetaObject *> m_metaObjectNameMap;
 
@@ -114,6 +148,11 @@ private:
     QHash<QObject *, const QMetaObject *> m_dynamicMetaObjectMap;
     /// QMO instance to canonical QMO mapping (for dynamic ones only)
     QHash<const QMetaObject *, const QMetaObject *> m_canonicalMetaObjectMap;
+
+    /// meta objects with changed counts, to be reported on the next update
+    QVector<int> m_changedMetaObjects;
+    QTimer *m_updateTimer;
+    int m_updateInterval;
 };
 }
 
@@ -0,0 +1,239 @@
+/*
+  objectchangecapture.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "objectchangecapture.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QThreadStorage>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+using namespace GammaRay;
+
+namespace {
+enum RecordState
+{
+    Free,
+    Pending,
+    Claimed,
+    Cancelled
+};
+
+struct Record
+{
+    QAtomicInt state = Free;
+    QObject *obj = nullptr;
+    Execution::Trace trace;
+};
+
+// single producer (the owning thread), single consumer (the probe thread, under the object lock)
+struct RingBuffer
+{
+    static constexpr quint32 Capacity = 1024;
+
+    std::array<Record, Capacity> records;
+    QAtomicInteger<quint32> head = 0; // written by the producer only
+    QAtomicInteger<quint32> tail = 0; // written by the consumer only
+};
+
+struct Registry
+{
+    QMutex mutex;
+    std::vector<std::shared_ptr<RingBuffer>> buffers;
+};
+}
+
+Q_GLOBAL_STATIC(Registry, s_registry)
+
+static QThreadStorage<std::shared_ptr<RingBuffer>> s_localBuffer;
+static QAtomicInt s_enabled = 0;
+static QAtomicPointer<void> s_probeThread = nullptr;
+static QAtomicInt s_pendingCount = 0;
+static QAtomicInt s_drainRequested = 0;
+
+static bool isCapturingThread()
+{
+    return s_enabled.loadAcquire() && QThread::currentThreadId() != s_probeThread.loadRelaxed();
+}
+
+static RingBuffer *localBuffer()
+{
+    if (s_localBuffer.hasLocalData())
+        return s_localBuffer.localData().get();
+
+    if (s_registry.isDestroyed())
+        return nullptr;
+
+    auto buffer = std::make_shared<RingBuffer>();
+    {
+        QMutexLocker lock(&s_registry()->mutex);
+        s_registry()->buffers.push_back(buffer);
+    }
+    s_localBuffer.setLocalData(buffer);
+    return buffer.get();
+}
+
+void ObjectChangeCapture::setEnabled(bool enabled, Qt::HANDLE probeThread)
+{
+    s_probeThread.storeRelaxed(probeThread);
+    s_enabled.storeRelease(enabled);
+
+    // discard anything left over from a previous probe instance
+    if (s_registry.isDestroyed())
+        return;
+    QMutexLocker lock(&s_registry()->mutex);
+    for (const auto &buffer : s_registry()->buffers) {
+        const auto head = buffer->head.loadAcquire();
+        for (auto i = buffer->tail.loadRelaxed(); i != head; ++i) {
+            auto &record = buffer->records[i % RingBuffer::Capacity];
+            if (record.state.testAndSetOrdered(Pending, Claimed))
+                s_pendingCount.deref();
+        }
+        buffer->tail.storeRelease(head);
+    }
+}
+
+bool ObjectChangeCapture::isEnabled()
+{
+    return s_enabled.loadAcquire();
+}
+
+bool ObjectChangeCapture::recordCreated(QObject *obj, bool withTrace)
+{
+    if (!isCapturingThread())
+        return false;
+
+    auto buffer = localBuffer();
+    if (!buffer)
+        return false;
+
+    const auto head = buffer->head.loadRelaxed();
+    if (head - buffer->tail.loadAcquire() >= RingBuffer::Capacity)
+        return false; // full, the probe thread is not keeping up
+
+    auto &record = buffer->records[head % RingBuffer::Capacity];
+    record.obj = obj;
+    if (withTrace)
+        record.trace = Execution::stackTrace(32, 3); // skip 3: this, Probe::objectAdded and the hook function calling us
+    else if (!record.trace.empty())
+        record.trace = Execution::Trace(); // don't attribute a previous trace to this object
+    s_pendingCount.ref();
+    record.state.storeRelease(Pending);
+    buffer->head.storeRelease(head + 1);
+    return true;
+}
+
+bool ObjectChangeCapture::recordDestroyed(QObject *obj)
+{
+    if (!isCapturingThread() || !s_localBuffer.hasLocalData())
+        return false;
+
+    auto buffer = s_localBuffer.localData().get();
+    const auto head = buffer->head.loadRelaxed();
+    bool found = false;
+    // the consumer might advance tail meanwhile, but we are the only one reusing records
+    for (auto i = buffer->tail.loadAcquire(); i != head; ++i) {
+        auto &record = buffer->records[i % RingBuffer::Capacity];
+        if (record.obj != obj)
+            continue;
+        if (record.state.testAndSetOrdered(Pending, Cancelled)) {
+            s_pendingCount.deref();
+            found = true;
+        } else if (record.state.loadAcquire() == Claimed) {
+            // already published, or about to be, needs the locked path
+            return false;
+        }
+    }
+    return found;
+}
+
+bool ObjectChangeCapture::requestDrain()
+{
+    return s_drainRequested.testAndSetOrdered(0, 1);
+}
+
+void ObjectChangeCapture::claim(QObject *obj)
+{
+    if (s_pendingCount.loadAcquire() == 0 || s_registry.isDestroyed())
+        return;
+
+    QMutexLocker lock(&s_registry()->mutex);
+    for (const auto &buffer : s_registry()->buffers) {
+        const auto head = buffer->head.loadAcquire();
+        for (auto i = buffer->tail.loadRelaxed(); i != head; ++i) {
+            auto &record = buffer->records[i % RingBuffer::Capacity];
+            if (record.obj == obj && record.state.testAndSetOrdered(Pending, Claimed))
+                s_pendingCount.deref();
+        }
+    }
+}
+
+void ObjectChangeCapture::cancel(QObject *obj)
+{
+    if (s_pendingCount.loadAcquire() == 0 || s_registry.isDestroyed())
+        return;
+
+    QMutexLocker lock(&s_registry()->mutex);
+    for (const auto &buffer : s_registry()->buffers) {
+        const auto head = buffer->head.loadAcquire();
+        for (auto i = buffer->tail.loadRelaxed(); i != head; ++i) {
+            auto &record = buffer->records[i % RingBuffer::Capacity];
+            if (record.obj == obj && record.state.testAndSetOrdered(Pending, Cancelled))
+                s_pendingCount.deref();
+        }
+    }
+}
+
+void ObjectChangeCapture::drain(const std::function<void(QObject *, const Execution::Trace &)> &func)
+{
+    s_drainRequested.storeRelease(0);
+    if (s_registry.isDestroyed())
+        return;
+
+    struct Claim
+    {
+        QObject *obj;
+        Execution::Trace trace;
+    };
+    std::vector<Claim> claims;
+
+    {
+        QMutexLocker lock(&s_registry()->mutex);
+        auto &buffers = s_registry()->buffers;
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            auto &buffer = *it;
+            const auto head = buffer->head.loadAcquire();
+            for (auto i = buffer->tail.loadRelaxed(); i != head; ++i) {
+                auto &record = buffer->records[i % RingBuffer::Capacity];
+                if (!record.state.testAndSetOrdered(Pending, Claimed))
+                    continue; // cancelled by the producer, or claimed via the locked path
+                s_pendingCount.deref();
+                claims.push_back({ record.obj, record.trace });
+            }
+            buffer->tail.storeRelease(head);
+
+            // the owning thread is gone and everything has been drained
+            if (buffer.use_count() == 1)
+                it = buffers.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // call out without holding the registry lock, func will end up in claim()
+    for (const auto &c : claims)
+        func(c.obj, c.trace);
+}
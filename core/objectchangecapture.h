@@ -0,0 +1,91 @@
+/*
+  objectchangecapture.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_OBJECTCHANGECAPTURE_H
+#define GAMMARAY_OBJECTCHANGECAPTURE_H
+
+#include "execution.h"
+
+#include <qglobal.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/*! Lock-free capture of QObject creation in threads other than the probe thread.
+ *
+ * Each producing thread owns a single-producer ring buffer of creation records.
+ * The probe thread drains all buffers while holding the object lock, and publishes
+ * the recorded objects to Probe::m_validObjects from there. This keeps the object lock
+ * out of the QObject ctor/dtor hooks for the common case of short-lived objects in
+ * worker threads.
+ *
+ * Destruction of an object whose creation record has not been drained yet is resolved
+ * within the producing thread by cancelling the record. When destroyed in any other thread,
+ * the locked path cancels the record instead. Destruction of an already
+ * published object still has to go through the locked path, otherwise Probe::isValidObject()
+ * would report dangling pointers as valid.
+ *
+ * @internal
+ */
+namespace ObjectChangeCapture {
+/*! Enables or disables capturing, and sets the thread the probe lives in.
+ *  Any records still pending from a previous capture session are discarded.
+ *  Pre-condition: object lock is held.
+ */
+void setEnabled(bool enabled, Qt::HANDLE probeThread = nullptr);
+bool isEnabled();
+
+/*! Records the creation of @p obj in the current thread's buffer, along with its
+ *  construction backtrace if @p withTrace is set.
+ *  Returns @c false if the caller has to use the regular locked code path instead,
+ *  e.g. because capturing is disabled, we are on the probe thread or the buffer is full.
+ *  Arbitrary thread, object lock not held.
+ */
+bool recordCreated(QObject *obj, bool withTrace);
+
+/*! Cancels all not yet drained creation records for @p obj in the current thread.
+ *  Returns @c true if the destruction has been handled completely that way, @c false
+ *  if the caller has to use the regular locked code path.
+ *  Arbitrary thread, object lock not held.
+ */
+bool recordDestroyed(QObject *obj);
+
+/*! Returns @c true if the caller is responsible for scheduling a drain of the buffers,
+ *  i.e. the first time this is called after the last call to drain().
+ */
+bool requestDrain();
+
+/*! Claims all pending creation records for @p obj, so that they can no longer be
+ *  cancelled lock-free. Call this before publishing an object via the locked code path.
+ *  Pre-condition: object lock is held.
+ */
+void claim(QObject *obj);
+
+/*! Cancels all pending creation records for @p obj from all threads, for objects destroyed
+ *  in a different thread than the one they were created in, before being drained.
+ *  Pre-condition: object lock is held.
+ */
+void cancel(QObject *obj);
+
+/*! Claims all pending creation records from all threads, and calls @p func for each of
+ *  them, in the order they were recorded per thread.
+ *  Pre-condition: object lock is held, probe thread.
+ */
+void drain(const std::function<void(QObject *, const Execution::Trace &)> &func);
+}
+}
+
+#endif // GAMMARAY_OBJECTCHANGECAPTURE_H
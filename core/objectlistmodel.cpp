@@ -14,6 +14,7 @@
 #include "objectlistmodel.h"
 
 #include "probe.h"
+#include "sortedobjectlist.h"
 
 #include <QThread>
 #include <QCoreApplication>
@@ -24,6 +25,9 @@
 using namespace GammaRay;
 using namespace std;
 
+// above this many separate row ranges a model reset is cheaper than the individual row insertions/removals
+static const int MaximumBatchRanges = 1000;
+
 ObjectListModel::ObjectListModel(Probe *probe)
     : ObjectModelBase<QAbstractTableModel>(probe)
 {
@@ -31,6 +35,10 @@ ObjectListModel::ObjectListModel(Probe *probe)
             this, &ObjectListModel::objectAdded);
     connect(probe, &Probe::objectDestroyed,
             this, &ObjectListModel::objectRemoved);
+    connect(probe, &Probe::objectsCreated,
+            this, &ObjectListModel::objectsAdded);
+    connect(probe, &Probe::objectsDestroyed,
+            this, &ObjectListModel::objectsRemoved);
 }
 
 QPair<int, QVariant> ObjectListModel::defaultSelectedItem()
@@ -73,7 +81,10 @@ void ObjectListModel::objectAdded(QObject *obj)
     Q_ASSERT(Probe::instance()->isValidObject(obj));
 
     auto it = std::lower_bound(m_objects.begin(), m_objects.end(), obj);
-    Q_ASSERT(it == m_objects.end() || *it != obj);
+    if (it != m_objects.end() && *it == obj) {
+        // added as part of a batch already
+        return;
+    }
 
     const int row = std::distance(m_objects.begin(), it);
     Q_ASSERT(row >= 0 && row <= m_objects.size());
@@ -103,6 +114,54 @@ void ObjectListModel::objectRemoved(QObject *obj)
     endRemoveRows();
 }
 
+void ObjectListModel::objectsAdded(const QVector<QObject *> &objects)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    auto sortedObjects = objects;
+    SortedObjectList::prepareInsertion(m_objects, sortedObjects);
+    if (sortedObjects.isEmpty())
+        return;
+
+    const auto ranges = SortedObjectList::insertionRanges(m_objects, sortedObjects);
+    if (ranges.size() > MaximumBatchRanges) {
+        beginResetModel();
+        SortedObjectList::merge(m_objects, sortedObjects);
+        endResetModel();
+        return;
+    }
+
+    for (auto it = ranges.crbegin(); it != ranges.crend(); ++it) {
+        beginInsertRows(QModelIndex(), it->row, it->row + it->count - 1);
+        SortedObjectList::insert(m_objects, sortedObjects, *it);
+        endInsertRows();
+    }
+}
+
+void ObjectListModel::objectsRemoved(const QVector<QObject *> &objects)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    const auto ranges = SortedObjectList::removalRanges(m_objects, objects);
+    if (ranges.size() > MaximumBatchRanges) {
+        auto sortedObjects = objects;
+        std::sort(sortedObjects.begin(), sortedObjects.end());
+        QVector<QObject *> remaining;
+        remaining.reserve(m_objects.size());
+        std::set_difference(m_objects.begin(), m_objects.end(), sortedObjects.begin(), sortedObjects.end(), std::back_inserter(remaining));
+        beginResetModel();
+        m_objects = std::move(remaining);
+        endResetModel();
+        return;
+    }
+
+    for (auto it = ranges.crbegin(); it != ranges.crend(); ++it) {
+        beginRemoveRows(QModelIndex(), it->row, it->row + it->count - 1);
+        SortedObjectList::remove(m_objects, *it);
+        endRemoveRows();
+    }
+}
+
 const QVector<QObject *> &ObjectListModel::objects() const
 {
     return m_objects;
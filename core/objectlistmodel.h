@@ -56,6 +56,8 @@ public:
 private slots:
     void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
+    void objectsAdded(const QVector<QObject *> &objects);
+    void objectsRemoved(const QVector<QObject *> &objects);
 
 private:
     void removeObject(QObject *obj);
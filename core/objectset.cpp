@@ -0,0 +1,117 @@
+/*
+  objectset.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "objectset.h"
+
+#include <utility>
+
+using namespace GammaRay;
+
+static const int MinimumCapacity = 64;
+
+ObjectSet::~ObjectSet() = default;
+
+ObjectSet::ObjectSet(ObjectSet &&other) noexcept
+    : m_buckets(std::move(other.m_buckets))
+    , m_mask(std::exchange(other.m_mask, 0))
+    , m_shift(std::exchange(other.m_shift, 64))
+    , m_size(std::exchange(other.m_size, 0))
+{
+}
+
+ObjectSet &ObjectSet::operator=(ObjectSet &&other) noexcept
+{
+    m_buckets = std::move(other.m_buckets);
+    m_mask = std::exchange(other.m_mask, 0);
+    m_shift = std::exchange(other.m_shift, 64);
+    m_size = std::exchange(other.m_size, 0);
+    return *this;
+}
+
+bool ObjectSet::insert(const QObject *obj)
+{
+    Q_ASSERT(obj);
+
+    // keep the load factor below 3/4, linear probing degrades quickly beyond that
+    if (!m_buckets || (m_size + 1) * 4 > capacity() * 3)
+        rehash(m_buckets ? capacity() * 2 : MinimumCapacity);
+
+    auto i = bucketFor(obj);
+    for (; m_buckets[i]; i = (i + 1) & m_mask) {
+        if (m_buckets[i] == obj)
+            return false;
+    }
+    m_buckets[i] = obj;
+    ++m_size;
+    return true;
+}
+
+bool ObjectSet::remove(const QObject *obj)
+{
+    if (!m_size || !obj)
+        return false;
+
+    auto hole = bucketFor(obj);
+    for (; m_buckets[hole] != obj; hole = (hole + 1) & m_mask) {
+        if (!m_buckets[hole])
+            return false;
+    }
+
+    // shift back following entries of the same probe sequence into the hole
+    for (auto i = (hole + 1) & m_mask; m_buckets[i]; i = (i + 1) & m_mask) {
+        const auto home = bucketFor(m_buckets[i]);
+        if (((i - home) & m_mask) >= ((i - hole) & m_mask)) {
+            m_buckets[hole] = m_buckets[i];
+            hole = i;
+        }
+    }
+    m_buckets[hole] = nullptr;
+    --m_size;
+
+    // give memory back after large bursts of short-lived objects
+    if (capacity() > MinimumCapacity && m_size * 8 < capacity())
+        rehash(capacity() / 2);
+    return true;
+}
+
+void ObjectSet::clear()
+{
+    m_buckets.reset();
+    m_mask = 0;
+    m_shift = 64;
+    m_size = 0;
+}
+
+void ObjectSet::rehash(int capacity)
+{
+    Q_ASSERT(capacity >= MinimumCapacity);
+    Q_ASSERT((capacity & (capacity - 1)) == 0);
+
+    auto oldBuckets = std::move(m_buckets);
+    const auto oldCapacity = oldBuckets ? m_mask + 1 : 0;
+
+    m_buckets.reset(new const QObject *[capacity]());
+    m_mask = quintptr(capacity) - 1;
+    m_shift = 64;
+    for (auto c = capacity; c > 1; c >>= 1)
+        --m_shift;
+
+    for (quintptr j = 0; j < oldCapacity; ++j) {
+        const auto *obj = oldBuckets[j];
+        if (!obj)
+            continue;
+        auto i = bucketFor(obj);
+        while (m_buckets[i])
+            i = (i + 1) & m_mask;
+        m_buckets[i] = obj;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+  objectset.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_OBJECTSET_H
+#define GAMMARAY_OBJECTSET_H
+
+#include "gammaray_core_export.h"
+
+#include <qglobal.h>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/** @brief Flat open-addressing hash set of QObject pointers.
+ *
+ *  Replacement for QSet<const QObject*> for sets with millions of entries that
+ *  are queried very frequently, such as the set of objects known to the probe.
+ *  Entries are stored inline in a single power-of-two sized bucket array using
+ *  linear probing, so a lookup is usually a single cache line access, and there
+ *  is no per-entry overhead besides the load factor.
+ *
+ *  Removal uses backward shifting, so there are no tombstones degrading lookup
+ *  performance over time.
+ *
+ *  @note Inserting @c nullptr is not allowed.
+ *  @since 3.4
+ */
+class GAMMARAY_CORE_EXPORT ObjectSet
+{
+public:
+    ObjectSet() = default;
+    ~ObjectSet();
+    ObjectSet(ObjectSet &&other) noexcept;
+    ObjectSet &operator=(ObjectSet &&other) noexcept;
+
+    /** Returns @c true if @p obj is contained in this set. */
+    inline bool contains(const QObject *obj) const
+    {
+        // nullptr marks empty buckets, it would match the first one we probe
+        if (!m_size || !obj)
+            return false;
+        for (auto i = bucketFor(obj);; i = (i + 1) & m_mask) {
+            const auto *entry = m_buckets[i];
+            if (entry == obj)
+                return true;
+            if (!entry)
+                return false;
+        }
+    }
+
+    /** Inserts @p obj, returns @c false if it was already contained. */
+    bool insert(const QObject *obj);
+    /** Removes @p obj, returns @c false if it was not contained. */
+    bool remove(const QObject *obj);
+    void clear();
+
+    int size() const
+    {
+        return m_size;
+    }
+    bool isEmpty() const
+    {
+        return m_size == 0;
+    }
+    /** Number of buckets currently allocated. */
+    int capacity() const
+    {
+        return m_buckets ? int(m_mask + 1) : 0;
+    }
+    /** Heap memory used by this set, in bytes. */
+    size_t memoryUsage() const
+    {
+        return size_t(capacity()) * sizeof(const QObject *);
+    }
+
+    ObjectSet &operator<<(const QObject *obj)
+    {
+        insert(obj);
+        return *this;
+    }
+
+private:
+    Q_DISABLE_COPY(ObjectSet)
+
+    inline quintptr bucketFor(const QObject *obj) const
+    {
+        // Fibonacci hashing, uses the high bits of the product which depend on all pointer bits
+        return quintptr((quint64(reinterpret_cast<quintptr>(obj)) * Q_UINT64_C(0x9E3779B97F4A7C15)) >> m_shift);
+    }
+    void rehash(int capacity);
+
+    std::unique_ptr<const QObject *[]> m_buckets;
+    quintptr m_mask = 0;
+    int m_shift = 64;
+    int m_size = 0;
+};
+}
+
+#endif // GAMMARAY_OBJECTSET_H
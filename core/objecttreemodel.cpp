@@ -32,11 +32,16 @@ using namespace GammaRay;
 
 ObjectTreeModel::ObjectTreeModel(Probe *probe)
     : ObjectModelBase<QAbstractItemModel>(probe)
+    , m_nodes(1)
 {
     connect(probe, &Probe::objectCreated,
             this, &ObjectTreeModel::objectAdded);
     connect(probe, &Probe::objectDestroyed,
             this, &ObjectTreeModel::objectRemoved);
+    connect(probe, &Probe::objectsCreated,
+            this, &ObjectTreeModel::objectsAdded);
+    connect(probe, &Probe::objectsDestroyed,
+            this, &ObjectTreeModel::objectsRemoved);
     connect(probe, &Probe::objectReparented,
             this, &ObjectTreeModel::objectReparented);
     connect(probe, &Probe::objectFavorited,
@@ -65,7 +70,7 @@ void ObjectTreeModel::objectAdded(QObject *obj)
     IF_DEBUG(cout << "tree obj added: " << hex << obj << " p: " << parentObject(obj) << endl;)
     Q_ASSERT(!obj->parent() || Probe::instance()->isValidObject(parentObject(obj)));
 
-    if (indexForObject(obj).isValid()) {
+    if (m_objectNodes.contains(obj)) {
         IF_DEBUG(cout << "tree double obj added: " << hex << obj << endl;)
         return;
     }
@@ -75,27 +80,22 @@ void ObjectTreeModel::objectAdded(QObject *obj)
     // then later the delayed signal comes in
     // so catch this gracefully by first adding the
     // parent if required
-    QModelIndex index = indexForObject(parentObject(obj));
+    int parentNode = RootNode;
     if (parentObject(obj)) {
-        if (!index.isValid()) {
+        auto it = m_objectNodes.constFind(parentObject(obj));
+        if (it == m_objectNodes.cend()) {
             IF_DEBUG(cout << "tree: handle parent first" << endl;)
             objectAdded(parentObject(obj));
-            index = indexForObject(parentObject(obj));
+            it = m_objectNodes.constFind(parentObject(obj));
         }
+        // either we get a proper parent and hence valid index or there is no parent
+        Q_ASSERT(it != m_objectNodes.cend());
+        parentNode = it.value();
     }
 
-    // either we get a proper parent and hence valid index or there is no parent
-    Q_ASSERT(index.isValid() || !parentObject(obj));
-
-    QVector<QObject *> &children = m_parentChildMap[parentObject(obj)];
-    auto it = std::lower_bound(children.begin(), children.end(), obj);
-    const int row = std::distance(children.begin(), it);
-
-    beginInsertRows(index, row, row);
-
-    children.insert(it, obj);
-    m_childParentMap.insert(obj, parentObject(obj));
-
+    const int row = m_nodes[parentNode].children.size();
+    beginInsertRows(indexForNode(parentNode), row, row);
+    addNode(obj, parentNode);
     endInsertRows();
 }
 
@@ -108,35 +108,126 @@ void ObjectTreeModel::objectRemoved(QObject *obj)
                  << "tree removed: "
                  << hex << obj << " "
                  << hex << obj->parent() << dec << " "
-                 << m_parentChildMap.value(obj->parent()).size() << " "
-                 << m_parentChildMap.contains(obj) << endl;)
+                 << m_objectNodes.contains(obj) << endl;)
 
-    auto parentIt = m_childParentMap.constFind(obj);
-    if (parentIt == m_childParentMap.cend()) {
-        Q_ASSERT(!m_parentChildMap.contains(obj));
+    const auto it = m_objectNodes.constFind(obj);
+    if (it == m_objectNodes.cend())
         return;
-    }
 
-    QObject *parentObj = parentIt.value();
-    const QModelIndex parentIndex = indexForObject(parentObj);
-    if (parentObj && !parentIndex.isValid())
-        return;
+    const int node = it.value();
+    const int parentNode = m_nodes[node].parent;
+    const int row = rowForNode(node);
 
-    QVector<QObject *> &siblings = m_parentChildMap[parentObj];
+    beginRemoveRows(indexForNode(parentNode), row, row);
+    m_nodes[parentNode].children.remove(row);
+    releaseNodes(node);
+    endRemoveRows();
+}
 
-    auto it = std::lower_bound(siblings.begin(), siblings.end(), obj);
-    if (it == siblings.end() || *it != obj)
-        return;
-    const int row = std::distance(siblings.begin(), it);
+// groups @p objects by parent, in order of first appearance of each parent
+template<typename Parent, typename ParentFunc>
+static QVector<QPair<Parent, QVector<QObject *>>> groupByParent(const QVector<QObject *> &objects, ParentFunc parentFunc)
+{
+    QVector<QPair<Parent, QVector<QObject *>>> groups;
+    QHash<Parent, int> groupIndexes;
+    for (QObject *obj : objects) {
+        const Parent parent = parentFunc(obj);
+        auto it = groupIndexes.constFind(parent);
+        if (it == groupIndexes.cend()) {
+            it = groupIndexes.insert(parent, groups.size());
+            groups.push_back({ parent, {} });
+        }
+        groups[it.value()].second.push_back(obj);
+    }
+    return groups;
+}
 
-    beginRemoveRows(parentIndex, row, row);
+void ObjectTreeModel::objectsAdded(const QVector<QObject *> &objects)
+{
+    Q_ASSERT(thread() == QThread::currentThread());
 
-    siblings.erase(it);
-    m_childParentMap.erase(parentIt);
-    m_parentChildMap.remove(obj);
-    m_favorites.remove(obj);
+    // Probe emits parents before their children, and groups are processed in order of
+    // first appearance, so a parent is always inserted before its children
+    const auto groups = groupByParent<QObject *>(objects, parentObject);
+    for (const auto &group : groups) {
+        QObject *parentObj = group.first;
+        const int parentNode = parentObj ? m_objectNodes.value(parentObj, -1) : int(RootNode);
+        if (parentNode < 0) {
+            // unknown parent, let the single object code path sort this out
+            for (QObject *obj : group.second)
+                objectAdded(obj);
+            continue;
+        }
 
-    endRemoveRows();
+        // skip duplicates, and objects known already, possibly below a different parent
+        QVector<QObject *> newObjects;
+        newObjects.reserve(group.second.size());
+        QSet<QObject *> seen;
+        for (QObject *obj : group.second) {
+            if (!m_objectNodes.contains(obj) && !seen.contains(obj)) {
+                seen.insert(obj);
+                newObjects.push_back(obj);
+            }
+        }
+        if (newObjects.isEmpty())
+            continue;
+
+        // appended as a whole, no matter how many siblings there are already
+        const int first = m_nodes[parentNode].children.size();
+        beginInsertRows(indexForNode(parentNode), first, first + newObjects.size() - 1);
+        m_nodes[parentNode].children.reserve(first + newObjects.size());
+        for (QObject *obj : std::as_const(newObjects))
+            addNode(obj, parentNode);
+        endInsertRows();
+    }
+}
+
+void ObjectTreeModel::objectsRemoved(const QVector<QObject *> &objects)
+{
+    Q_ASSERT(thread() == QThread::currentThread());
+
+    const auto groups = groupByParent<int>(objects, [this](QObject *obj) {
+        const auto it = m_objectNodes.constFind(obj);
+        return it == m_objectNodes.cend() ? -1 : m_nodes[it.value()].parent;
+    });
+    for (const auto &group : groups) {
+        const int parentNode = group.first;
+        if (parentNode < 0)
+            continue;
+
+        // an earlier group might have removed this parent along with its subtree already
+        QVector<int> rows;
+        rows.reserve(group.second.size());
+        for (QObject *obj : group.second) {
+            const auto it = m_objectNodes.constFind(obj);
+            if (it != m_objectNodes.cend() && m_nodes[it.value()].parent == parentNode)
+                rows.push_back(rowForNode(it.value()));
+        }
+        if (rows.isEmpty())
+            continue;
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        // contiguous ranges, back to front so the rows of the remaining ones stay valid
+        const QModelIndex parentIndex = indexForNode(parentNode);
+        for (int last = rows.size() - 1; last >= 0;) {
+            int first = last;
+            while (first > 0 && rows.at(first - 1) == rows.at(first) - 1)
+                --first;
+
+            const int firstRow = rows.at(first);
+            const int count = last - first + 1;
+            beginRemoveRows(parentIndex, firstRow, firstRow + count - 1);
+            auto &siblings = m_nodes[parentNode].children;
+            const auto removed = siblings.mid(firstRow, count);
+            siblings.remove(firstRow, count);
+            for (int node : removed)
+                releaseNodes(node);
+            endRemoveRows();
+
+            last = first - 1;
+        }
+    }
 }
 
 void ObjectTreeModel::objectReparented(QObject *obj)
@@ -152,38 +243,31 @@ void ObjectTreeModel::objectReparented(QObject *obj)
     }
 
     // we didn't know obj yet
-    auto parentIt = m_childParentMap.constFind(obj);
-    if (parentIt == m_childParentMap.cend()) {
-        Q_ASSERT(!m_parentChildMap.contains(obj));
+    const auto it = m_objectNodes.constFind(obj);
+    if (it == m_objectNodes.cend()) {
         objectAdded(obj);
         return;
     }
 
-    QObject *oldParent = parentIt.value();
-    const auto sourceParent = indexForObject(oldParent);
-    if ((oldParent && !sourceParent.isValid()) || (oldParent == parentObject(obj)))
+    const int node = it.value();
+    const int oldParentNode = m_nodes[node].parent;
+    if (m_nodes[oldParentNode].object == parentObject(obj))
         return;
 
-    QVector<QObject *> &oldSiblings = m_parentChildMap[oldParent];
-    auto oldIt = std::lower_bound(oldSiblings.begin(),
-                                  oldSiblings.end(), obj);
-    if (oldIt == oldSiblings.end() || *oldIt != obj)
+    IF_DEBUG(cout << "actually reparenting! " << hex << obj << " old parent: " << m_nodes[oldParentNode].object << " new parent: " << parentObject(obj) << dec << endl;)
+    const int newParentNode = parentObject(obj) ? m_objectNodes.value(parentObject(obj), -1) : int(RootNode);
+    Q_ASSERT(newParentNode >= 0);
+    if (newParentNode < 0)
         return;
-    const int sourceRow = std::distance(oldSiblings.begin(), oldIt);
-
-    IF_DEBUG(cout << "actually reparenting! " << hex << obj << " old parent: " << oldParent << " new parent: " << parentObject(obj) << dec << endl;)
-    const auto destParent = indexForObject(parentObject(obj));
-    Q_ASSERT(destParent.isValid() || !parentObject(obj));
 
-    QVector<QObject *> &newSiblings = m_parentChildMap[parentObject(obj)];
-    auto newIt = std::lower_bound(newSiblings.begin(),
-                                  newSiblings.end(), obj);
-    const int destRow = std::distance(newSiblings.begin(), newIt);
+    const int sourceRow = rowForNode(node);
+    const int destRow = m_nodes[newParentNode].children.size();
 
-    beginMoveRows(sourceParent, sourceRow, sourceRow, destParent, destRow);
-    oldSiblings.erase(oldIt);
-    newSiblings.insert(newIt, obj);
-    m_childParentMap.insert(obj, parentObject(obj));
+    beginMoveRows(indexForNode(oldParentNode), sourceRow, sourceRow, indexForNode(newParentNode), destRow);
+    m_nodes[oldParentNode].children.remove(sourceRow);
+    m_nodes[newParentNode].children.push_back(node);
+    m_nodes[node].parent = newParentNode;
+    m_nodes[node].row = destRow;
     endMoveRows();
 }
 
@@ -213,7 +297,7 @@ QVariant ObjectTreeModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    QObject *obj = reinterpret_cast<QObject *>(index.internalPointer());
+    QObject *obj = m_nodes[nodeForIndex(index)].object;
 
     QMutexLocker lock(Probe::objectLock());
     if (Probe::instance()->isValidObject(obj)) {
@@ -235,44 +319,90 @@ int ObjectTreeModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.column() == 1)
         return 0;
-    QObject *parentObj = reinterpret_cast<QObject *>(parent.internalPointer());
-    return m_parentChildMap.value(parentObj).size();
+    return m_nodes[nodeForIndex(parent)].children.size();
 }
 
 QModelIndex ObjectTreeModel::parent(const QModelIndex &child) const
 {
-    QObject *childObj = reinterpret_cast<QObject *>(child.internalPointer());
-    return indexForObject(m_childParentMap.value(childObj));
+    if (!child.isValid())
+        return {};
+    return indexForNode(m_nodes[nodeForIndex(child)].parent);
 }
 
 QModelIndex ObjectTreeModel::index(int row, int column, const QModelIndex &parent) const
 {
-    QObject *parentObj = reinterpret_cast<QObject *>(parent.internalPointer());
-    const QVector<QObject *> children = m_parentChildMap.value(parentObj);
+    const QVector<int> &children = m_nodes[nodeForIndex(parent)].children;
     if (row < 0 || column < 0 || row >= children.size() || column >= columnCount())
         return {};
-    return createIndex(row, column, children.at(row));
+    const int node = children.at(row);
+    m_nodes[node].row = row;
+    return createIndex(row, column, quintptr(node));
 }
 
 QModelIndex ObjectTreeModel::indexForObject(QObject *object) const
 {
     if (!object)
         return {};
-    // Find the parent
-    auto parentIt = m_childParentMap.constFind(object);
-    if (parentIt == m_childParentMap.cend())
+    const auto it = m_objectNodes.constFind(object);
+    if (it == m_objectNodes.cend())
         return {};
+    return indexForNode(it.value());
+}
 
-    // Find all children of this parent
-    auto childrenIt = m_parentChildMap.constFind(parentIt.value());
-    if (childrenIt == m_parentChildMap.cend())
+QModelIndex ObjectTreeModel::indexForNode(int node) const
+{
+    if (node == RootNode)
         return {};
-    const QVector<QObject *> &siblings = childrenIt.value();
-
-    // Find where @p object is
-    auto it = std::lower_bound(siblings.constBegin(), siblings.constEnd(), object);
-    if (it == siblings.constEnd() || *it != object)
-        return QModelIndex();
-    const int row = std::distance(siblings.constBegin(), it);
-    return createIndex(row, 0, *it);
+    return createIndex(rowForNode(node), 0, quintptr(node));
+}
+
+int ObjectTreeModel::nodeForIndex(const QModelIndex &index) const
+{
+    return index.isValid() ? int(index.internalId()) : int(RootNode);
+}
+
+int ObjectTreeModel::rowForNode(int node) const
+{
+    const Node &n = m_nodes[node];
+    const QVector<int> &siblings = m_nodes[n.parent].children;
+    if (n.row >= siblings.size() || siblings.at(n.row) != node) {
+        // outdated by a removal before it, renumber all siblings at once
+        for (int row = 0; row < siblings.size(); ++row)
+            m_nodes[siblings.at(row)].row = row;
+    }
+    return n.row;
+}
+
+int ObjectTreeModel::addNode(QObject *object, int parent)
+{
+    int node;
+    if (m_freeNodes.isEmpty()) {
+        node = int(m_nodes.size());
+        m_nodes.emplace_back();
+    } else {
+        node = m_freeNodes.takeLast();
+    }
+
+    auto &siblings = m_nodes[parent].children;
+    Node &n = m_nodes[node];
+    n.object = object;
+    n.parent = parent;
+    n.row = siblings.size();
+    siblings.push_back(node);
+    m_objectNodes.insert(object, node);
+    return node;
+}
+
+void ObjectTreeModel::releaseNodes(int node)
+{
+    QVector<int> pending = { node };
+    while (!pending.isEmpty()) {
+        const int current = pending.takeLast();
+        Node &n = m_nodes[current];
+        pending += n.children;
+        m_objectNodes.remove(n.object);
+        m_favorites.remove(n.object);
+        n = Node();
+        m_freeNodes.push_back(current);
+    }
 }
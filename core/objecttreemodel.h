@@ -16,8 +16,12 @@
 
 #include "objectmodelbase.h"
 
+#include <QHash>
+#include <QSet>
 #include <QVector>
 
+#include <vector>
+
 namespace GammaRay {
 class Probe;
 
@@ -38,16 +42,39 @@ public:
 private slots:
     void objectAdded(QObject *obj);
     void objectRemoved(QObject *obj);
+    void objectsAdded(const QVector<QObject *> &objects);
+    void objectsRemoved(const QVector<QObject *> &objects);
     void objectReparented(QObject *obj);
     void objectFavorited(QObject *obj);
     void objectUnfavorited(QObject *obj);
 
 private:
+    // one per tracked object, QModelIndex::internalId() is the position in m_nodes
+    struct Node
+    {
+        QObject *object = nullptr;
+        int parent = -1; // RootNode for top-level objects
+        mutable int row = 0; // in the children of parent, renumbered lazily after removals
+        QVector<int> children; // in order of insertion
+    };
+    enum
+    {
+        RootNode = 0
+    };
+
     QModelIndex indexForObject(QObject *object) const;
+    QModelIndex indexForNode(int node) const;
+    int nodeForIndex(const QModelIndex &index) const;
+    int rowForNode(int node) const;
+    /// Appends a new node for @p object to the children of @p parent, and returns it.
+    int addNode(QObject *object, int parent);
+    /// Releases @p node and everything below it, without touching the children of its parent.
+    void releaseNodes(int node);
 
 private:
-    QHash<QObject *, QObject *> m_childParentMap;
-    QHash<QObject *, QVector<QObject *>> m_parentChildMap;
+    std::vector<Node> m_nodes;
+    QVector<int> m_freeNodes;
+    QHash<QObject *, int> m_objectNodes;
     QSet<QObject *> m_favorites;
 };
 }
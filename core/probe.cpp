@@ -30,6 +30,8 @@
 #include "varianthandler.h"
 #include "metaobjectregistry.h"
 #include "favoriteobject.h"
+#include "objectchangecapture.h"
+#include "tracestore.h"
 
 #include "remote/server.h"
 #include "remote/remotemodelserver.h"
@@ -45,6 +47,7 @@
 #include <QGuiApplication>
 #include <QWindow>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QLibrary>
 #include <QMouseEvent>
 #include <QUrl>
@@ -55,6 +58,7 @@
 #include <algorithm>
 #include <iostream>
 #include <cstdio>
+#include <utility>
 
 #define IF_DEBUG(x)
 
@@ -166,14 +170,31 @@ struct Listener
     bool trackDestroyed = true;
     QVector<QObject *> addedBeforeProbeInstance;
 
-    QHash<QObject *, Execution::Trace> constructionBacktracesForObjects;
+    // construction backtraces, deduplicated as most objects are created from a few code locations only
+    TraceStore constructionBacktraces;
+    QHash<QObject *, TraceStore::TraceId> constructionBacktracesForObjects;
 };
 
 Q_GLOBAL_STATIC(Listener, s_listener)
 
+// 0 disables construction backtraces, N records them for every Nth object
+static QAtomicInt s_constructionBacktraceInterval = 1;
+static QAtomicInteger<quint32> s_constructionBacktraceCounter = 0;
+
+static bool sampleConstructionBacktrace()
+{
+    const auto interval = s_constructionBacktraceInterval.loadRelaxed();
+    if (interval <= 1)
+        return interval == 1 && Execution::hasFastStackTrace();
+    return s_constructionBacktraceCounter.fetchAndAddRelaxed(1) % quint32(interval) == 0
+        && Execution::hasFastStackTrace();
+}
+
 // ensures proper information is returned by isValidObject by
 // locking it in objectAdded/Removed
 Q_GLOBAL_STATIC(QRecursiveMutex, s_lock)
+// set while the incremental object discovery has objects pending, see objectRemoved()
+static QAtomicInt s_discoveryRunning = 0;
 
 Probe::Probe(QObject *parent)
     : QObject(parent)
@@ -182,6 +203,8 @@ Probe::Probe(QObject *parent)
     , m_window(nullptr)
     , m_metaObjectRegistry(new MetaObjectRegistry(this))
     , m_queueTimer(new QTimer(this))
+    , m_discoveryTimer(new QTimer(this))
+    , m_probeController(nullptr)
     , m_server(nullptr)
 {
     qputenv("DEBUGINFOD_URLS", QByteArray());
@@ -195,7 +218,8 @@ Probe::Probe(QObject *parent)
     m_server = new Server(this);
 
     ObjectBroker::setSelectionModelFactoryCallback(selectionModelFactory);
-    ObjectBroker::registerObject<ProbeControllerInterface *>(new ProbeController(this));
+    m_probeController = new ProbeController(this);
+    ObjectBroker::registerObject<ProbeControllerInterface *>(m_probeController);
     m_toolManager = new ToolManager(this);
     ObjectBroker::registerObject<ToolManagerInterface *>(m_toolManager);
     ObjectBroker::registerObject<FavoriteObjectInterface *>(new FavoriteObject(this));
@@ -218,6 +242,11 @@ Probe::Probe(QObject *parent)
     connect(m_queueTimer, &QTimer::timeout,
             this, &Probe::processQueuedObjectChanges);
 
+    m_discoveryTimer->setSingleShot(true);
+    m_discoveryTimer->setInterval(0);
+    connect(m_discoveryTimer, &QTimer::timeout,
+            this, &Probe::discoverObjectsIncrementally);
+
     m_previousSignalSpyCallbackSet = qt_signal_spy_callback_set.loadRelaxed();
 
     connect(this, &Probe::objectCreated, m_metaObjectRegistry, &MetaObjectRegistry::objectAdded);
@@ -236,6 +265,12 @@ Probe::~Probe()
 
     qt_register_signal_spy_callbacks(m_previousSignalSpyCallbackSet);
 
+    {
+        QMutexLocker lock(s_lock());
+        ObjectChangeCapture::setEnabled(false);
+        s_discoveryRunning.storeRelease(0);
+    }
+
     ObjectBroker::clear();
     ProbeSettings::resetLauncherIdentifier();
     MetaObjectRepository::instance()->clear();
@@ -309,15 +344,29 @@ void Probe::createProbe(bool findExisting)
 
         s_instance = QAtomicPointer<Probe>(probe);
 
+        s_constructionBacktraceInterval.storeRelaxed(
+            ProbeSettings::value(QStringLiteral("ConstructionBacktraceSampling"), 1).toInt());
+
+        // objects created in other threads are recorded lock-free from here on, if requested
+        ObjectChangeCapture::setEnabled(ProbeSettings::value(QStringLiteral("LockFreeObjectCapture"), false).toBool(),
+                                        QThread::currentThreadId());
+
         // add objects to the probe that were tracked before its creation
+        probe->m_batchObjectCreations = true;
         foreach (QObject *obj, s_listener()->addedBeforeProbeInstance) {
             objectAdded(obj);
         }
         s_listener()->addedBeforeProbeInstance.clear();
 
         // try to find existing objects by other means
-        if (findExisting)
-            probe->findExistingObjects();
+        if (findExisting) {
+            if (ProbeSettings::value(QStringLiteral("IncrementalObjectDiscovery"), false).toBool())
+                probe->startIncrementalObjectDiscovery();
+            else
+                probe->findExistingObjects();
+        }
+        probe->m_batchObjectCreations = false;
+        probe->flushCreatedObjects();
     }
 
     // eventually initialize the rest
@@ -503,20 +552,35 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
 {
     if (obj == nullptr)
         return;
-    QMutexLocker lock(s_lock());
 
     // attempt to ignore objects created by GammaRay itself, especially short-lived ones
     if (fromCtor && ProbeGuard::insideProbe() && obj->thread() == QThread::currentThread())
         return;
 
+    const bool withTrace = fromCtor && sampleConstructionBacktrace();
+
+    // objects created in other threads can be handed over to us without taking the lock
+    if (fromCtor && ObjectChangeCapture::recordCreated(obj, withTrace)) {
+        if (ObjectChangeCapture::requestDrain()) {
+            if (auto probe = instance())
+                QMetaObject::invokeMethod(probe, "processQueuedObjectChanges", Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    // capture outside of the lock, interning it is cheap in comparison
+    Execution::Trace trace;
+    if (withTrace)
+        trace = Execution::stackTrace(32, 2); // skip 2: this and the hook function calling us
+
+    QMutexLocker lock(s_lock());
+
     // ignore objects created when global statics are already getting destroyed (on exit)
     if (s_listener.isDestroyed())
         return;
 
-
-    if (Execution::hasFastStackTrace() && fromCtor) {
-        s_listener()->constructionBacktracesForObjects.insert(obj, Execution::stackTrace(32, 2)); // skip 2: this and the hook function calling us
-    }
+    if (withTrace)
+        setConstructionBacktrace(obj, trace);
 
     if (!isInitialized()) {
         IF_DEBUG(cout
@@ -546,6 +610,14 @@ void Probe::objectAdded(QObject *obj, bool fromCtor)
         return;
     }
 
+    // from here on the object must not be dropped by a lock-free destruction in its thread anymore
+    ObjectChangeCapture::claim(obj);
+    addUnknownObject(obj, fromCtor);
+}
+
+// pre-condition: we have the lock, arbitrary thread, obj is not filtered and not tracked yet
+void Probe::addUnknownObject(QObject *obj, bool fromCtor)
+{
     // make sure we already know the parent
     if (obj->parent() && !instance()->m_validObjects.contains(obj->parent()))
         objectAdded(obj->parent(), fromCtor);
@@ -575,26 +647,58 @@ void Probe::processQueuedObjectChanges()
 {
     QMutexLocker lock(s_lock());
 
-    IF_DEBUG(cout << Q_FUNC_INFO << " " << m_queuedObjectChanges.size() << endl;)
-
     // must be called from the main thread via timeout
     Q_ASSERT(QThread::currentThread() == thread());
 
-    const auto queuedObjectChanges = m_queuedObjectChanges; // copy, in case this gets modified while we iterate (which can actually happen)
-    for (const auto &change : queuedObjectChanges) {
+    // publish objects recorded lock-free by other threads, queuing them like any other object from a ctor
+    // this also needs to happen when re-entered below, nobody would schedule another drain otherwise
+    ObjectChangeCapture::drain([this](QObject *obj, const Execution::Trace &trace) {
+        if (!trace.empty())
+            setConstructionBacktrace(obj, trace);
+        if (m_validObjects.contains(obj) || filterObject(obj))
+            return;
+        addUnknownObject(obj, true);
+    });
+
+    // a nested event loop in one of the slots below can get us here again
+    // what we just queued is picked up once the outer call is done
+    if (!m_processedObjectChanges.changes.isEmpty())
+        return;
+
+    IF_DEBUG(cout << Q_FUNC_INFO << " " << m_queuedObjectChanges.changes.size() << endl;)
+
+    // changes queued while we iterate (which can actually happen) end up in the next batch
+    std::swap(m_queuedObjectChanges, m_processedObjectChanges);
+    auto &changes = m_processedObjectChanges.changes;
+    // consecutive changes of the same type are reported as one batch
+    m_batchObjectCreations = true;
+    for (int i = 0; i < changes.size(); ++i) {
+        const auto change = changes.at(i);
+        if (!change.obj) // purged
+            continue;
         switch (change.type) {
         case ObjectChange::Create:
+            flushDestroyedObjects();
+            m_processedObjectChanges.creations.remove(change.obj);
             objectFullyConstructed(change.obj);
             break;
         case ObjectChange::Destroy:
-            emit objectDestroyed(change.obj);
+            flushCreatedObjects();
+            m_destroyedObjectsBatch.push_back(change.obj);
             break;
         }
     }
+    flushCreatedObjects();
+    flushDestroyedObjects();
+    m_batchObjectCreations = false;
+    flushCreatedObjects(); // anything created by the slots connected to the last batch
 
     IF_DEBUG(cout << Q_FUNC_INFO << " done" << endl;)
 
-    m_queuedObjectChanges.clear();
+    changes.clear();
+    m_processedObjectChanges.creations.clear();
+    if (!m_queuedObjectChanges.changes.isEmpty())
+        notifyQueuedObjectChanges();
 
     for (QObject *obj : std::as_const(m_pendingReparents)) {
         if (!isValidObject(obj))
@@ -639,7 +743,41 @@ void Probe::objectFullyConstructed(QObject *obj)
     Q_ASSERT(!obj->parent() || m_validObjects.contains(obj->parent()));
 
     m_toolManager->objectAdded(obj);
-    emit objectCreated(obj);
+    if (m_batchObjectCreations)
+        m_createdObjectsBatch.push_back(obj);
+    else
+        emit objectCreated(obj);
+}
+
+// pre-condition: lock is held already, our thread
+void Probe::flushCreatedObjects()
+{
+    auto objects = std::exchange(m_createdObjectsBatch, {});
+    // slots connected to previous batches might have deleted some of these meanwhile
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [this](QObject *obj) {
+                      return !m_validObjects.contains(obj);
+                  }),
+                  objects.end());
+    if (objects.isEmpty())
+        return;
+
+    emit objectsCreated(objects);
+    for (QObject *obj : std::as_const(objects)) {
+        if (m_validObjects.contains(obj))
+            emit objectCreated(obj);
+    }
+}
+
+// pre-condition: lock is held already, our thread
+void Probe::flushDestroyedObjects()
+{
+    const auto objects = std::exchange(m_destroyedObjectsBatch, {});
+    if (objects.isEmpty())
+        return;
+
+    emit objectsDestroyed(objects);
+    for (QObject *obj : objects)
+        emit objectDestroyed(obj);
 }
 
 /*
@@ -653,8 +791,26 @@ void Probe::objectFullyConstructed(QObject *obj)
  */
 void Probe::objectRemoved(QObject *obj)
 {
+    // destroyed before we even got to see it, nothing to do for us
+    if (ObjectChangeCapture::recordDestroyed(obj)) {
+        // but the incremental discovery might have found it as a child of a tracked parent
+        if (s_discoveryRunning.loadAcquire()) {
+            QMutexLocker lock(s_lock());
+            if (isInitialized())
+                instance()->m_discoveryPending.remove(obj);
+        }
+        return;
+    }
+
     QMutexLocker lock(s_lock());
 
+    // created in another thread and not drained yet, the drain must not publish it anymore
+    ObjectChangeCapture::cancel(obj);
+
+    // the address might get reused by an object we don't sample a backtrace for
+    if (!s_listener.isDestroyed())
+        s_listener()->constructionBacktracesForObjects.remove(obj);
+
     if (!isInitialized()) {
         IF_DEBUG(cout
                      << "objectRemoved Before: "
@@ -676,6 +832,10 @@ void Probe::objectRemoved(QObject *obj)
 
     IF_DEBUG(cout << "object removed:" << hex << obj << " " << obj->parent() << endl;)
 
+    // don't let the incremental discovery dereference it later on
+    if (!instance()->m_discoveryPending.isEmpty())
+        instance()->m_discoveryPending.remove(obj);
+
     bool success = instance()->m_validObjects.remove(obj);
     if (!success) {
         // object was not tracked by the probe, probably a gammaray object
@@ -705,7 +865,8 @@ void Probe::queueCreatedObject(QObject *obj)
     ObjectChange c;
     c.obj = obj;
     c.type = ObjectChange::Create;
-    m_queuedObjectChanges.push_back(c);
+    m_queuedObjectChanges.creations.insert(obj, m_queuedObjectChanges.changes.size());
+    m_queuedObjectChanges.changes.push_back(c);
     notifyQueuedObjectChanges();
 }
 
@@ -715,29 +876,27 @@ void Probe::queueDestroyedObject(QObject *obj)
     ObjectChange c;
     c.obj = obj;
     c.type = ObjectChange::Destroy;
-    m_queuedObjectChanges.push_back(c);
+    m_queuedObjectChanges.changes.push_back(c);
     notifyQueuedObjectChanges();
 }
 
 // pre-condition: we have the lock, arbitrary thread
 bool Probe::isObjectCreationQueued(QObject *obj) const
 {
-    return std::find_if(m_queuedObjectChanges.begin(), m_queuedObjectChanges.end(),
-                        [obj](const ObjectChange &c) {
-                            return c.obj == obj && c.type == Probe::ObjectChange::Create;
-                        })
-        != m_queuedObjectChanges.end();
+    return m_queuedObjectChanges.creations.contains(obj)
+        || m_processedObjectChanges.creations.contains(obj);
 }
 
 // pre-condition: we have the lock, arbitrary thread
 void Probe::purgeChangesForObject(QObject *obj)
 {
-    for (int i = 0; i < m_queuedObjectChanges.size(); ++i) {
-        if (m_queuedObjectChanges.at(i).obj == obj
-            && m_queuedObjectChanges.at(i).type == ObjectChange::Create) {
-            m_queuedObjectChanges.remove(i);
-            return;
-        }
+    for (auto queue : { &m_queuedObjectChanges, &m_processedObjectChanges }) {
+        const auto it = queue->creations.find(obj);
+        if (it == queue->creations.end())
+            continue;
+        queue->changes[it.value()].obj = nullptr;
+        queue->creations.erase(it);
+        return;
     }
 }
 
@@ -855,6 +1014,81 @@ void Probe::findExistingObjects()
     }
 }
 
+/*
+ * Prepares walking the object tree in time-sliced chunks from the event loop,
+ * rather than in one go as findExistingObjects() does. This keeps the target
+ * responsive while attaching to an application with a large number of objects.
+ *
+ * pre-condition: lock is held
+ */
+void Probe::startIncrementalObjectDiscovery()
+{
+    m_discoveryTimeSlice = qMax(1, ProbeSettings::value(QStringLiteral("ObjectDiscoveryTimeSlice"), 10).toInt());
+
+    // pushed in reverse, so we visit them in the same order as findExistingObjects()
+    if (auto guiApp = qobject_cast<QGuiApplication *>(QCoreApplication::instance())) {
+        const auto windows = guiApp->allWindows();
+        for (auto it = windows.crbegin(); it != windows.crend(); ++it) {
+            if (m_discoveryPending.insert(*it))
+                m_discoveryStack.push_back(*it);
+        }
+    }
+    if (m_discoveryPending.insert(QCoreApplication::instance()))
+        m_discoveryStack.push_back(QCoreApplication::instance());
+
+    m_discoveredObjectCount = 0;
+    s_discoveryRunning.storeRelease(1);
+    m_probeController->setObjectDiscoveryRunning(true);
+    m_probeController->setDiscoveredObjectCount(0);
+    m_discoveryTimer->start();
+}
+
+/*
+ * Discovers objects until the time slice is used up, and publishes them to
+ * the object models in one batch per slice.
+ *
+ * pre-condition: lock isn't held, main thread
+ */
+void Probe::discoverObjectsIncrementally()
+{
+    QElapsedTimer sliceTimer;
+    sliceTimer.start();
+
+    {
+        QMutexLocker lock(s_lock());
+        m_batchObjectCreations = true;
+        while (!m_discoveryStack.isEmpty() && sliceTimer.elapsed() < m_discoveryTimeSlice) {
+            QObject *obj = m_discoveryStack.takeLast();
+            if (!m_discoveryPending.remove(obj))
+                continue; // destroyed since we found it
+
+            // tracked already, e.g. as the parent of an object created meanwhile, its
+            // existing children might still be unknown though
+            if (!m_validObjects.contains(obj)) {
+                objectAdded(obj);
+                ++m_discoveredObjectCount;
+            }
+
+            const auto &children = obj->children();
+            for (auto it = children.crbegin(); it != children.crend(); ++it) {
+                if (m_discoveryPending.insert(*it))
+                    m_discoveryStack.push_back(*it);
+            }
+        }
+        m_batchObjectCreations = false;
+        flushCreatedObjects();
+    }
+
+    m_probeController->setDiscoveredObjectCount(m_discoveredObjectCount);
+    if (m_discoveryStack.isEmpty()) {
+        m_discoveryStack.squeeze();
+        s_discoveryRunning.storeRelease(0);
+        m_probeController->setObjectDiscoveryRunning(false);
+    } else {
+        m_discoveryTimer->start();
+    }
+}
+
 void Probe::discoverObject(QObject *object)
 {
     if (!object)
@@ -972,15 +1206,20 @@ void Probe::executeSignalCallback(const Func &func)
                   func);
 }
 
+// pre-condition: lock is held
+void Probe::setConstructionBacktrace(QObject *obj, const Execution::Trace &trace)
+{
+    auto listener = s_listener();
+    listener->constructionBacktracesForObjects.insert(obj, listener->constructionBacktraces.intern(trace));
+}
+
 SourceLocation Probe::objectCreationSourceLocation(const QObject *object)
 {
-    QObject *key = const_cast<QObject *>(object);
-    if (!s_listener()->constructionBacktracesForObjects.contains(key)) {
+    const auto st = objectCreationStackTrace(const_cast<QObject *>(object));
+    if (st.empty()) {
         IF_DEBUG(std::cout << "No backtrace for object available" << object << "." << std::endl;)
         return SourceLocation();
     }
-
-    const auto &st = s_listener()->constructionBacktracesForObjects.value(key);
     int distanceToQObject = 0;
 
     const QMetaObject *metaObject = object->metaObject();
@@ -995,5 +1234,7 @@ SourceLocation Probe::objectCreationSourceLocation(const QObject *object)
 
 Execution::Trace Probe::objectCreationStackTrace(QObject *object)
 {
-    return s_listener()->constructionBacktracesForObjects.value(object);
+    QMutexLocker lock(s_lock());
+    const auto listener = s_listener();
+    return listener->constructionBacktraces.trace(listener->constructionBacktracesForObjects.value(object));
 }
@@ -15,11 +15,13 @@
 #define GAMMARAY_PROBE_H
 
 #include "gammaray_core_export.h"
+#include "objectset.h"
 #include "signalspycallbackset.h"
 
 #include <common/sourcelocation.h>
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QPoint>
 #include <QSet>
@@ -48,6 +50,7 @@ class Server;
 class ToolManager;
 class ProblemCollector;
 class MetaObjectRegistry;
+class ProbeController;
 namespace Execution {
 class Trace;
 }
@@ -270,6 +273,29 @@ signals:
      * - The objectLock() is locked.
      */
     void objectDestroyed(QObject *obj);
+
+    /*!
+     * Emitted for a batch of newly created QObjects, e.g. when processing delayed
+     * object creations or when discovering existing objects on attaching.
+     *
+     * This is emitted right before the individual objectCreated() signals for the same
+     * objects, so consumers benefiting from bulk updates can handle all of @p objects
+     * at once here, and ignore the individual signals for objects they know already.
+     * The same notes as for objectCreated() apply.
+     *
+     * @since 3.4
+     */
+    void objectsCreated(const QVector<QObject *> &objects);
+
+    /*!
+     * Emitted for a batch of destroyed QObjects, right before the individual
+     * objectDestroyed() signals for the same objects.
+     * The same notes as for objectDestroyed() apply.
+     *
+     * @since 3.4
+     */
+    void objectsDestroyed(const QVector<QObject *> &objects);
+
     void objectReparented(QObject *obj);
     void objectFavorited(QObject *obj);
     void objectUnfavorited(QObject *obj);
@@ -286,6 +312,7 @@ private slots:
     void shutdown();
 
     void processQueuedObjectChanges();
+    void discoverObjectsIncrementally();
     static void handleObjectDestroyed(QObject *obj);
 
 private:
@@ -298,6 +325,8 @@ private:
      */
     QT_DEPRECATED static bool hasReliableObjectTracking();
 
+    static void addUnknownObject(QObject *obj, bool fromCtor);
+    static void setConstructionBacktrace(QObject *obj, const Execution::Trace &trace);
     void objectFullyConstructed(QObject *obj);
 
     void queueCreatedObject(QObject *obj);
@@ -305,8 +334,11 @@ private:
     bool isObjectCreationQueued(QObject *obj) const;
     void purgeChangesForObject(QObject *obj);
     void notifyQueuedObjectChanges();
+    void flushCreatedObjects();
+    void flushDestroyedObjects();
 
     void findExistingObjects();
+    void startIncrementalObjectDiscovery();
 
     /*! Check if we are capable of showing widgets. */
     static bool canShowWidgets();
@@ -326,7 +358,7 @@ private:
     ProblemCollector *m_problemCollector;
     ToolManager *m_toolManager;
     QObject *m_window;
-    QSet<const QObject *> m_validObjects;
+    ObjectSet m_validObjects;
     MetaObjectRegistry *m_metaObjectRegistry;
 
     // all delayed object changes need to go through a single queue, as the order is crucial
@@ -339,10 +371,34 @@ private:
             Destroy
         } type;
     };
-    QVector<ObjectChange> m_queuedObjectChanges;
+    // queued changes plus an index of the queued creations, purged creations are left
+    // behind as tombstones (obj == nullptr) to keep the indexes stable
+    struct ObjectChangeQueue
+    {
+        QVector<ObjectChange> changes;
+        QHash<QObject *, int> creations;
+    };
+    ObjectChangeQueue m_queuedObjectChanges;
+    // the batch currently being processed, swapped with m_queuedObjectChanges
+    ObjectChangeQueue m_processedObjectChanges;
+
+    // while set, objectCreated() is deferred and collected for objectsCreated()
+    bool m_batchObjectCreations = false;
+    QVector<QObject *> m_createdObjectsBatch;
+    QVector<QObject *> m_destroyedObjectsBatch;
 
     QList<QObject *> m_pendingReparents;
     QTimer *m_queueTimer;
+
+    // incremental discovery of existing objects, see startIncrementalObjectDiscovery()
+    QVector<QObject *> m_discoveryStack;
+    // objects on the discovery stack that have not been destroyed meanwhile
+    ObjectSet m_discoveryPending;
+    QTimer *m_discoveryTimer;
+    int m_discoveryTimeSlice = 10;
+    int m_discoveredObjectCount = 0;
+
+    ProbeController *m_probeController;
     QVector<QObject *> m_globalEventFilters;
     QVector<SignalSpyCallbackSet> m_signalSpyCallbacks;
 
@@ -0,0 +1,590 @@
+/*
+  asyncfilterproxymodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "asyncfilterproxymodel.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <limits>
+
+using namespace GammaRay;
+
+static const int SliceBudget = 8; // ms spent collecting strings per event loop iteration
+static const int ChunkSize = 4096; // rows matched per worker job
+static const int PublishInterval = 100; // ms between applying partial results
+static const int MinimumCompaction = 4096; // released entries before compacting is worth it
+
+AsyncFilterProxyModel::AsyncFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_sliceTimer(new QTimer(this))
+    , m_publishTimer(new QTimer(this))
+{
+    m_sliceTimer->setSingleShot(true);
+    m_sliceTimer->setInterval(0);
+    connect(m_sliceTimer, &QTimer::timeout, this, &AsyncFilterProxyModel::processSlice);
+
+    m_publishTimer->setSingleShot(true);
+    m_publishTimer->setInterval(PublishInterval);
+    connect(m_publishTimer, &QTimer::timeout, this, &AsyncFilterProxyModel::publishResults);
+
+    // results are applied in order, and the strings are never modified, so one thread is enough
+    m_workers.setMaxThreadCount(1);
+
+    connect(this, &QSortFilterProxyModel::filterRoleChanged, this, [this] {
+        dropSnapshot();
+        if (!m_pattern.pattern().isEmpty())
+            startSearch();
+    });
+}
+
+AsyncFilterProxyModel::~AsyncFilterProxyModel()
+{
+    cancelSearch();
+    m_workers.waitForDone();
+}
+
+void AsyncFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    cancelSearch();
+    dropSnapshot();
+    for (const auto &connection : std::as_const(m_sourceConnections))
+        disconnect(connection);
+    m_sourceConnections.clear();
+
+    m_source = sourceModel;
+    if (sourceModel) {
+        // connected before QSortFilterProxyModel, so we see changes before it refilters the affected rows
+        const auto structureAboutToChange = [this] {
+            sourceStructureAboutToChange();
+        };
+        m_sourceConnections = {
+            connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &AsyncFilterProxyModel::sourceRowsInserted),
+            connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &AsyncFilterProxyModel::sourceRowsAboutToBeRemoved),
+            connect(sourceModel, &QAbstractItemModel::rowsAboutToBeMoved, this, &AsyncFilterProxyModel::sourceRowsAboutToBeMoved),
+            connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &AsyncFilterProxyModel::sourceRowsMoved),
+            connect(sourceModel, &QAbstractItemModel::columnsAboutToBeInserted, this, structureAboutToChange),
+            connect(sourceModel, &QAbstractItemModel::columnsAboutToBeRemoved, this, structureAboutToChange),
+            connect(sourceModel, &QAbstractItemModel::columnsAboutToBeMoved, this, structureAboutToChange),
+            connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, structureAboutToChange),
+            connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, structureAboutToChange),
+            connect(sourceModel, &QAbstractItemModel::dataChanged, this, &AsyncFilterProxyModel::sourceDataChanged),
+        };
+        // before setting the source, so the initial filtering doesn't match synchronously
+        if (!m_pattern.pattern().isEmpty())
+            startSearch();
+    }
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+QRegularExpression AsyncFilterProxyModel::filterPattern() const
+{
+    return m_pattern;
+}
+
+void AsyncFilterProxyModel::setFilterPattern(const QRegularExpression &pattern)
+{
+    if (pattern == m_pattern)
+        return;
+    m_pattern = pattern;
+    startSearch();
+}
+
+Qt::CaseSensitivity AsyncFilterProxyModel::filterPatternCaseSensitivity() const
+{
+    return (m_pattern.patternOptions() & QRegularExpression::CaseInsensitiveOption) ? Qt::CaseInsensitive : Qt::CaseSensitive;
+}
+
+void AsyncFilterProxyModel::setFilterPatternCaseSensitivity(Qt::CaseSensitivity caseSensitivity)
+{
+    if (caseSensitivity == filterPatternCaseSensitivity())
+        return;
+    auto options = m_pattern.patternOptions();
+    options.setFlag(QRegularExpression::CaseInsensitiveOption, caseSensitivity == Qt::CaseInsensitive);
+    m_pattern.setPatternOptions(options);
+    if (!m_pattern.pattern().isEmpty())
+        startSearch();
+}
+
+void AsyncFilterProxyModel::setFilterPatternKeyColumn(int column)
+{
+    if (column == filterKeyColumn())
+        return;
+    // keeps the refiltering triggered by QSortFilterProxyModel from matching synchronously
+    m_searching = m_source && !m_pattern.pattern().isEmpty();
+    setFilterKeyColumn(column);
+    startSearch();
+}
+
+bool AsyncFilterProxyModel::isSearching() const
+{
+    return m_searching;
+}
+
+bool AsyncFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_pattern.pattern().isEmpty())
+        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+
+    const auto entry = entryForRow(sourceRow, sourceParent);
+    if (entry >= 0) {
+        const auto state = m_matches.at(entry);
+        if (state & Stale)
+            return matchesRow(sourceRow, sourceParent);
+        if (state & Decided) // by the current search, or the previous one while we are waiting for results
+            return state & Matched;
+    }
+
+    if (m_searching)
+        return false; // decided once we get the results for this row
+    return matchesRow(sourceRow, sourceParent);
+}
+
+void AsyncFilterProxyModel::startSearch()
+{
+    cancelSearch();
+    if (!m_source || m_pattern.pattern().isEmpty()) {
+        invalidateRowsFilter();
+        return;
+    }
+
+    for (auto &state : m_matches)
+        state &= quint8(~Current);
+    m_searching = true;
+    if (!m_collecting && !m_snapshotComplete) {
+        dropSnapshot();
+        m_collecting = true;
+        addBlock(false);
+        m_pendingParents = { { QPersistentModelIndex(), RootBlock } };
+    }
+    m_sliceTimer->start();
+}
+
+void AsyncFilterProxyModel::cancelSearch()
+{
+    // results of jobs still queued or running are discarded
+    m_generation.fetchAndAddOrdered(1);
+    m_dispatched = 0;
+    m_received = 0;
+    m_searching = false;
+    m_sliceTimer->stop();
+    m_publishTimer->stop();
+}
+
+void AsyncFilterProxyModel::dropSnapshot()
+{
+    m_blocks.clear();
+    m_texts.clear();
+    m_matches.clear();
+    m_releasedEntries = 0;
+    m_pendingParents.clear();
+    m_collectRow = 0;
+    m_collecting = false;
+    m_snapshotComplete = false;
+    resetParentCache();
+}
+
+void AsyncFilterProxyModel::processSlice()
+{
+    if (m_collecting)
+        collectRows(SliceBudget);
+    if (m_searching)
+        dispatchRows();
+
+    if (m_collecting)
+        m_sliceTimer->start();
+    else
+        finishSearchIfDone();
+}
+
+void AsyncFilterProxyModel::collectRows(qint64 budget)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!m_pendingParents.isEmpty()) {
+        const auto pending = m_pendingParents.first();
+        if (m_blocks.at(pending.block).released) {
+            // removed before we got to it
+            m_pendingParents.removeFirst();
+            m_collectRow = 0;
+            continue;
+        }
+
+        m_blocks[pending.block].tracking = true;
+        const QModelIndex parent = pending.index;
+        const auto rowCount = m_source->rowCount(parent);
+        while (m_collectRow < rowCount) {
+            // outside of a search there is nothing to wait for, so match right away.
+            // Not holding a reference to the block, collecting a row can add blocks.
+            const auto row = collectRow(m_collectRow, parent, !m_searching);
+            m_blocks[pending.block].rows.push_back(row);
+            ++m_collectRow;
+            if ((m_collectRow % 64) == 0 && timer.elapsed() >= budget)
+                return;
+        }
+
+        m_pendingParents.removeFirst();
+        m_collectRow = 0;
+    }
+
+    m_collecting = false;
+    m_snapshotComplete = true;
+}
+
+AsyncFilterProxyModel::Row AsyncFilterProxyModel::collectRow(int sourceRow, const QModelIndex &sourceParent, bool matchNow)
+{
+    const auto role = filterRole();
+    const auto columnCount = m_source->columnCount(sourceParent);
+    QStringList texts;
+    texts.reserve(columnCount);
+    for (int column = 0; column < columnCount; ++column)
+        texts.push_back(m_source->index(sourceRow, column, sourceParent).data(role).toString());
+
+    quint8 state = 0;
+    if (matchNow && !m_pattern.pattern().isEmpty())
+        state = Decided | Current | (matchesTexts(texts) ? Matched : 0);
+    m_texts.push_back(texts);
+    m_matches.push_back(state);
+
+    Row row;
+    row.entry = m_texts.size() - 1;
+    const auto child = m_source->index(sourceRow, 0, sourceParent);
+    if (m_source->hasChildren(child)) {
+        if (!m_collecting) {
+            m_collecting = true;
+            m_snapshotComplete = false;
+            m_collectRow = 0;
+            m_sliceTimer->start();
+        }
+        row.children = addBlock(false);
+        m_pendingParents.push_back({ child, row.children });
+    }
+    return row;
+}
+
+int AsyncFilterProxyModel::addBlock(bool tracking)
+{
+    Block block;
+    block.tracking = tracking;
+    m_blocks.push_back(block);
+    return m_blocks.size() - 1;
+}
+
+void AsyncFilterProxyModel::dispatchRows()
+{
+    const int generation = m_generation.loadRelaxed();
+    const auto keyColumn = filterKeyColumn();
+    // not shared with m_pattern, which is still used for synchronous matching in this thread
+    const QRegularExpression pattern(m_pattern.pattern(), m_pattern.patternOptions());
+
+    while (m_dispatched < m_texts.size()) {
+        const auto offset = m_dispatched;
+        const auto count = std::min<int>(ChunkSize, m_texts.size() - offset);
+        m_workers.start([this, generation, offset, texts = m_texts.mid(offset, count), pattern, keyColumn]() {
+            QVector<bool> results;
+            results.reserve(texts.size());
+            for (const auto &row : texts) {
+                if ((results.size() % 256) == 0 && m_generation.loadRelaxed() != generation)
+                    return; // cancelled
+                if (keyColumn < 0) {
+                    results.push_back(std::any_of(row.begin(), row.end(), [&pattern](const QString &text) {
+                        return text.contains(pattern);
+                    }));
+                } else {
+                    results.push_back(row.value(keyColumn).contains(pattern));
+                }
+            }
+            QMetaObject::invokeMethod(
+                this, [this, generation, offset, results]() {
+                    applyResults(generation, offset, results);
+                },
+                Qt::QueuedConnection);
+        });
+        m_dispatched += count;
+    }
+}
+
+void AsyncFilterProxyModel::applyResults(int generation, int offset, const QVector<bool> &results)
+{
+    if (generation != m_generation.loadRelaxed())
+        return; // outdated search, or the snapshot has been dropped meanwhile
+
+    for (int i = 0; i < results.size(); ++i) {
+        auto &state = m_matches[offset + i];
+        if ((state & Stale) == 0)
+            state = Decided | Current | (results.at(i) ? Matched : 0);
+    }
+    m_received += results.size();
+
+    if (!finishSearchIfDone() && !m_publishTimer->isActive())
+        m_publishTimer->start();
+}
+
+bool AsyncFilterProxyModel::finishSearchIfDone()
+{
+    if (!m_searching || m_collecting || m_received < m_texts.size())
+        return false;
+
+    m_searching = false;
+    m_publishTimer->stop();
+    publishResults();
+    emit searchFinished();
+    return true;
+}
+
+void AsyncFilterProxyModel::publishResults()
+{
+    invalidateRowsFilter();
+}
+
+int AsyncFilterProxyModel::blockForParent(const QModelIndex &sourceParent) const
+{
+    if (m_blocks.isEmpty())
+        return -1;
+    if (!sourceParent.isValid())
+        return RootBlock;
+    if (sourceParent == m_cachedParent)
+        return m_cachedBlock;
+
+    // walk down from the top-level row, rows of the ancestors are all we need
+    QVarLengthArray<int, 16> rows;
+    for (auto index = sourceParent; index.isValid(); index = index.parent())
+        rows.push_back(index.row());
+    int block = RootBlock;
+    for (auto it = rows.crbegin(); it != rows.crend(); ++it) {
+        const auto &blockRows = m_blocks.at(block).rows;
+        if (*it >= blockRows.size())
+            return -1;
+        block = blockRows.at(*it).children;
+        if (block < 0)
+            return -1;
+    }
+
+    // not collected yet might change without the source model changing, so only cache this
+    m_cachedParent = sourceParent;
+    m_cachedBlock = block;
+    return block;
+}
+
+int AsyncFilterProxyModel::entryForRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    const auto block = blockForParent(sourceParent);
+    if (block < 0 || sourceRow >= m_blocks.at(block).rows.size())
+        return -1;
+    return m_blocks.at(block).rows.at(sourceRow).entry;
+}
+
+bool AsyncFilterProxyModel::matchesRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    const auto keyColumn = filterKeyColumn();
+    if (keyColumn >= 0)
+        return m_source->index(sourceRow, keyColumn, sourceParent).data(filterRole()).toString().contains(m_pattern);
+
+    const auto columnCount = m_source->columnCount(sourceParent);
+    for (int column = 0; column < columnCount; ++column) {
+        if (m_source->index(sourceRow, column, sourceParent).data(filterRole()).toString().contains(m_pattern))
+            return true;
+    }
+    return false;
+}
+
+bool AsyncFilterProxyModel::matchesTexts(const QStringList &texts) const
+{
+    const auto keyColumn = filterKeyColumn();
+    if (keyColumn >= 0)
+        return texts.value(keyColumn).contains(m_pattern);
+    return std::any_of(texts.begin(), texts.end(), [this](const QString &text) {
+        return text.contains(m_pattern);
+    });
+}
+
+bool AsyncFilterProxyModel::isCollectingRowsOf(int block) const
+{
+    return m_collecting && !m_pendingParents.isEmpty() && m_pendingParents.first().block == block;
+}
+
+void AsyncFilterProxyModel::releaseRows(int block, int first, int last)
+{
+    auto &rows = m_blocks[block].rows;
+    last = std::min<int>(last, rows.size() - 1);
+    if (first > last)
+        return;
+
+    const auto released = rows.mid(first, last - first + 1);
+    rows.remove(first, released.size());
+    if (isCollectingRowsOf(block))
+        m_collectRow -= released.size();
+    m_releasedEntries += released.size();
+    for (const auto &row : released) {
+        m_texts[row.entry] = QStringList();
+        m_matches[row.entry] = 0;
+        // the collected children go along with their parent
+        if (row.children >= 0)
+            releaseBlock(row.children);
+    }
+}
+
+void AsyncFilterProxyModel::releaseBlock(int block)
+{
+    releaseRows(block, 0, std::numeric_limits<int>::max());
+    m_blocks[block].tracking = false;
+    m_blocks[block].released = true;
+}
+
+void AsyncFilterProxyModel::compactEntries()
+{
+    QVector<int> blockIds(m_blocks.size(), -1);
+    QVector<Block> blocks;
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        if (m_blocks.at(i).released)
+            continue;
+        blockIds[i] = blocks.size();
+        blocks.push_back(std::move(m_blocks[i]));
+    }
+
+    QVector<QStringList> texts;
+    QVector<quint8> matches;
+    texts.reserve(m_texts.size() - m_releasedEntries);
+    matches.reserve(m_texts.size() - m_releasedEntries);
+    for (auto &block : blocks) {
+        for (auto &row : block.rows) {
+            texts.push_back(std::move(m_texts[row.entry]));
+            matches.push_back(m_matches.at(row.entry));
+            row.entry = texts.size() - 1;
+            if (row.children >= 0)
+                row.children = blockIds.at(row.children);
+        }
+    }
+
+    // released ones are never the one being collected, that resets m_collectRow when released
+    QVector<PendingParent> pendingParents;
+    pendingParents.reserve(m_pendingParents.size());
+    for (const auto &pending : std::as_const(m_pendingParents)) {
+        if (blockIds.at(pending.block) >= 0)
+            pendingParents.push_back({ pending.index, blockIds.at(pending.block) });
+    }
+
+    m_blocks = std::move(blocks);
+    m_texts = std::move(texts);
+    m_matches = std::move(matches);
+    m_pendingParents = std::move(pendingParents);
+    m_releasedEntries = 0;
+    resetParentCache();
+
+    // results of jobs still in flight refer to the old entries, decided states are kept though
+    m_generation.fetchAndAddOrdered(1);
+    m_dispatched = 0;
+    m_received = 0;
+    if (m_searching && !m_sliceTimer->isActive())
+        m_sliceTimer->start();
+}
+
+void AsyncFilterProxyModel::resetParentCache()
+{
+    m_cachedParent = QModelIndex();
+    m_cachedBlock = -1;
+}
+
+void AsyncFilterProxyModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    resetParentCache();
+    const auto sourceParent = parent.siblingAtColumn(0);
+    auto block = blockForParent(sourceParent);
+    if (block < 0 && sourceParent.isValid()) {
+        // the first children of a collected row
+        const auto parentBlock = blockForParent(sourceParent.parent());
+        if (parentBlock < 0 || sourceParent.row() >= m_blocks.at(parentBlock).rows.size())
+            return; // collected along with its parent later
+        block = addBlock(true);
+        m_blocks[parentBlock].rows[sourceParent.row()].children = block;
+    }
+    if (block < 0 || !m_blocks.at(block).tracking)
+        return; // collected along with the other rows of the parent later
+    if (first > m_blocks.at(block).rows.size())
+        return; // in the part of the parent currently being collected that is still to be collected
+
+    // matched synchronously, QSortFilterProxyModel filters them right after this
+    const auto firstEntry = m_texts.size();
+    QVector<Row> rows;
+    rows.reserve(last - first + 1);
+    for (int row = first; row <= last; ++row)
+        rows.push_back(collectRow(row, sourceParent, true));
+    auto &blockRows = m_blocks[block].rows;
+    blockRows.insert(first, rows.size(), Row());
+    std::copy(rows.cbegin(), rows.cend(), blockRows.begin() + first);
+    if (isCollectingRowsOf(block))
+        m_collectRow += rows.size();
+
+    // decided already, so there is no need to wait for results for them to finish the current search
+    if (m_dispatched == firstEntry) {
+        m_dispatched += rows.size();
+        m_received += rows.size();
+    } else if (m_searching && !m_sliceTimer->isActive()) {
+        m_sliceTimer->start(); // dispatches them along with the rest
+    }
+}
+
+void AsyncFilterProxyModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    resetParentCache();
+    const auto block = blockForParent(parent.siblingAtColumn(0));
+    if (block < 0)
+        return;
+
+    releaseRows(block, first, last);
+    resetParentCache();
+    if (m_releasedEntries > MinimumCompaction && m_releasedEntries > m_texts.size() / 2)
+        compactEntries();
+}
+
+void AsyncFilterProxyModel::sourceRowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd)
+{
+    sourceRowsAboutToBeRemoved(sourceParent, sourceStart, sourceEnd);
+}
+
+void AsyncFilterProxyModel::sourceRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd,
+                                            const QModelIndex &destinationParent, int destinationRow)
+{
+    const auto count = sourceEnd - sourceStart + 1;
+    if (sourceParent == destinationParent && destinationRow > sourceEnd)
+        destinationRow -= count;
+    sourceRowsInserted(destinationParent, destinationRow, destinationRow + count - 1);
+}
+
+void AsyncFilterProxyModel::sourceStructureAboutToChange()
+{
+    // the snapshot is addressed by source rows, which are about to change arbitrarily
+    const bool searching = m_searching;
+    cancelSearch();
+    dropSnapshot();
+    if (searching)
+        startSearch();
+}
+
+void AsyncFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!topLeft.isValid() || m_texts.isEmpty())
+        return;
+
+    // those rows are refiltered by QSortFilterProxyModel right after this, with the current data
+    const auto block = blockForParent(topLeft.parent().siblingAtColumn(0));
+    if (block < 0)
+        return;
+    const auto &rows = m_blocks.at(block).rows;
+    const auto last = std::min<int>(bottomRight.row(), rows.size() - 1);
+    for (int row = topLeft.row(); row <= last; ++row)
+        m_matches[rows.at(row).entry] |= Stale;
+}
@@ -0,0 +1,168 @@
+/*
+  asyncfilterproxymodel.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_ASYNCFILTERPROXYMODEL_H
+#define GAMMARAY_ASYNCFILTERPROXYMODEL_H
+
+#include "gammaray_core_export.h"
+
+#include <QAtomicInt>
+#include <QPersistentModelIndex>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/** @brief QSortFilterProxyModel matching its filter pattern on a worker thread.
+ *
+ *  Setting a pattern with setFilterPattern() does not refilter synchronously. Instead, the
+ *  strings of the filter role are collected from the source model in short time slices, and
+ *  matched against the pattern on a worker thread. Results are applied incrementally as they
+ *  arrive, rows not matched yet keep the state of the previous search meanwhile. A new pattern
+ *  cancels a search still in progress.
+ *
+ *  The collected strings are reused for subsequent searches. Rows inserted, removed or moved in
+ *  the source model are tracked incrementally, keeping the results for all other rows. Inserted
+ *  rows are matched synchronously. Layout changes, resets and column changes drop everything
+ *  collected so far and restart the search.
+ *
+ *  This replicates the default row filtering of QSortFilterProxyModel only, so it is not a
+ *  suitable base for proxies reimplementing filterAcceptsRow().
+ *
+ *  @since 3.4
+ */
+class GAMMARAY_CORE_EXPORT AsyncFilterProxyModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit AsyncFilterProxyModel(QObject *parent = nullptr);
+    ~AsyncFilterProxyModel() override;
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    /** The pattern matched asynchronously, independent of filterRegularExpression(). */
+    QRegularExpression filterPattern() const;
+    void setFilterPattern(const QRegularExpression &pattern);
+    Qt::CaseSensitivity filterPatternCaseSensitivity() const;
+    void setFilterPatternCaseSensitivity(Qt::CaseSensitivity caseSensitivity);
+    /** Like setFilterKeyColumn(), but without synchronously refiltering with the current pattern. */
+    void setFilterPatternKeyColumn(int column);
+
+    /** Returns @c true while results for the current pattern are still outstanding. */
+    bool isSearching() const;
+
+signals:
+    /** Emitted once all results for the current pattern have been applied. */
+    void searchFinished();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    enum MatchState : quint8
+    {
+        Decided = 1, // matched by any search, Matched is valid
+        Matched = 2,
+        Current = 4, // matched by the current search
+        Stale = 8 // changed since collected, match synchronously
+    };
+
+    // collected rows of one source parent, addressed by row so they follow row changes
+    struct Row
+    {
+        int entry = -1;
+        int children = -1; // block of the collected children, if any
+    };
+    struct Block
+    {
+        QVector<Row> rows;
+        bool tracking = false; // rows are collected or being collected
+        bool released = false; // its parent row has been removed, until the next compaction
+    };
+    struct PendingParent
+    {
+        QPersistentModelIndex index;
+        int block;
+    };
+    enum
+    {
+        RootBlock = 0
+    };
+
+    void startSearch();
+    void cancelSearch();
+    void dropSnapshot();
+    void processSlice();
+    void collectRows(qint64 budget);
+    Row collectRow(int sourceRow, const QModelIndex &sourceParent, bool matchNow);
+    int addBlock(bool tracking);
+    void dispatchRows();
+    void applyResults(int generation, int offset, const QVector<bool> &results);
+    bool finishSearchIfDone();
+    void publishResults();
+    int blockForParent(const QModelIndex &sourceParent) const;
+    int entryForRow(int sourceRow, const QModelIndex &sourceParent) const;
+    bool matchesRow(int sourceRow, const QModelIndex &sourceParent) const;
+    bool matchesTexts(const QStringList &texts) const;
+    bool isCollectingRowsOf(int block) const;
+    void releaseRows(int block, int first, int last);
+    void releaseBlock(int block);
+    void compactEntries();
+    void resetParentCache();
+
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd);
+    void sourceRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd,
+                         const QModelIndex &destinationParent, int destinationRow);
+    void sourceStructureAboutToChange();
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+    QRegularExpression m_pattern;
+    QPointer<QAbstractItemModel> m_source;
+    QVector<QMetaObject::Connection> m_sourceConnections;
+
+    // snapshot of the source model, mirroring its tree so it is found by row rather than by
+    // (persistent) index. Entries are never moved, so results can be applied by entry while rows
+    // are inserted or removed meanwhile.
+    QVector<Block> m_blocks; // RootBlock for the top-level rows
+    QVector<QStringList> m_texts; // entry -> filterRole() string per column
+    QVector<quint8> m_matches; // entry -> MatchState
+    int m_releasedEntries = 0; // entries of removed rows, until the next compaction
+    QVector<PendingParent> m_pendingParents; // parents still to collect
+    int m_collectRow = 0; // next row of m_pendingParents.first() to collect
+    bool m_collecting = false;
+    bool m_snapshotComplete = false;
+    // filterAcceptsRow() is called for all children of a parent in a row
+    mutable QModelIndex m_cachedParent;
+    mutable int m_cachedBlock = -1;
+
+    // current search
+    QAtomicInt m_generation;
+    int m_dispatched = 0;
+    int m_received = 0;
+    bool m_searching = false;
+
+    QTimer *m_sliceTimer;
+    QTimer *m_publishTimer;
+    QThreadPool m_workers;
+};
+}
+
+#endif // GAMMARAY_ASYNCFILTERPROXYMODEL_H
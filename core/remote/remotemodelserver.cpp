@@ -12,9 +12,11 @@
 */
 
 #include "remotemodelserver.h"
+#include "asyncfilterproxymodel.h"
 #include "common/remotemodelroles.h"
 #include "server.h"
 #include <core/probeguard.h>
+#include <core/probesettings.h>
 #include <common/protocol.h>
 #include <common/message.h>
 #include <common/modelevent.h>
@@ -29,7 +31,9 @@
 #include <QIcon>
 #include <QSequentialIterable>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace GammaRay;
@@ -37,14 +41,22 @@ using namespace std;
 
 void (*RemoteModelServer::s_registerServerCallback)() = nullptr;
 
+// beyond this, pending changes of a parent/role set are collapsed into their bounding rectangle
+static const int MaxDirtyRects = 16;
+
 RemoteModelServer::RemoteModelServer(const QString &objectName, QObject *parent)
     : QObject(parent)
     , m_model(nullptr)
     , m_dummyBuffer(new QBuffer(&m_dummyData, this))
+    , m_dataChangedTimer(new QTimer(this))
+    , m_dataChangedInterval(ProbeSettings::value(QStringLiteral("RemoteModelUpdateInterval"), 16).toInt())
     , m_monitored(false)
 {
     setObjectName(objectName);
     m_dummyBuffer->open(QIODevice::WriteOnly);
+    m_dataChangedTimer->setSingleShot(true);
+    m_dataChangedTimer->setInterval(std::max(0, m_dataChangedInterval));
+    connect(m_dataChangedTimer, &QTimer::timeout, this, &RemoteModelServer::flushDataChanged);
     registerServer();
 }
 
@@ -63,6 +75,7 @@ void RemoteModelServer::setModel(QAbstractItemModel *model)
     if (m_model)
         disconnectModel();
 
+    resetChangeTracking();
     m_model = model;
     if (m_model && m_monitored)
         connectModel();
@@ -71,6 +84,19 @@ void RemoteModelServer::setModel(QAbstractItemModel *model)
         modelReset();
 }
 
+int RemoteModelServer::dataChangedInterval() const
+{
+    return m_dataChangedInterval;
+}
+
+void RemoteModelServer::setDataChangedInterval(int msecs)
+{
+    m_dataChangedInterval = msecs;
+    m_dataChangedTimer->setInterval(std::max(0, msecs));
+    if (msecs < 0)
+        flushDataChanged();
+}
+
 void RemoteModelServer::connectModel()
 {
     Q_ASSERT(m_model);
@@ -94,6 +120,19 @@ void RemoteModelServer::connectModel()
             this, &RemoteModelServer::columnsRemoved);
     connect(m_model.data(), &QAbstractItemModel::dataChanged,
             this, &RemoteModelServer::dataChanged);
+    // pending data changes refer to the current structure, so send them out before it changes
+    connect(m_model.data(), &QAbstractItemModel::rowsAboutToBeInserted,
+            this, &RemoteModelServer::flushDataChanged);
+    connect(m_model.data(), &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, &RemoteModelServer::flushDataChanged);
+    connect(m_model.data(), &QAbstractItemModel::columnsAboutToBeInserted,
+            this, &RemoteModelServer::flushDataChanged);
+    connect(m_model.data(), &QAbstractItemModel::columnsAboutToBeMoved,
+            this, &RemoteModelServer::flushDataChanged);
+    connect(m_model.data(), &QAbstractItemModel::columnsAboutToBeRemoved,
+            this, &RemoteModelServer::flushDataChanged);
+    connect(m_model.data(), &QAbstractItemModel::layoutAboutToBeChanged,
+            this, &RemoteModelServer::flushDataChanged);
     connect(m_model.data(),
             &QAbstractItemModel::layoutChanged,
             this,
@@ -106,6 +145,7 @@ void RemoteModelServer::disconnectModel()
 {
     Q_ASSERT(m_model);
     Model::unused(m_model);
+    resetChangeTracking();
 
     disconnect(m_model.data(), &QAbstractItemModel::headerDataChanged,
                this, &RemoteModelServer::headerDataChanged);
@@ -125,6 +165,18 @@ void RemoteModelServer::disconnectModel()
                this, &RemoteModelServer::columnsRemoved);
     disconnect(m_model.data(), &QAbstractItemModel::dataChanged,
                this, &RemoteModelServer::dataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::rowsAboutToBeInserted,
+               this, &RemoteModelServer::flushDataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::rowsAboutToBeRemoved,
+               this, &RemoteModelServer::flushDataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::columnsAboutToBeInserted,
+               this, &RemoteModelServer::flushDataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::columnsAboutToBeMoved,
+               this, &RemoteModelServer::flushDataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::columnsAboutToBeRemoved,
+               this, &RemoteModelServer::flushDataChanged);
+    disconnect(m_model.data(), &QAbstractItemModel::layoutAboutToBeChanged,
+               this, &RemoteModelServer::flushDataChanged);
     disconnect(m_model.data(), &QAbstractItemModel::layoutChanged,
                this, &RemoteModelServer::layoutChanged);
     disconnect(m_model.data(), &QAbstractItemModel::modelReset, this, &RemoteModelServer::modelReset);
@@ -145,9 +197,12 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
 
         Message reply(m_myAddress, Protocol::ModelRowColumnCountReply);
         reply << size;
+        Protocol::ModelIndexDecoder decoder;
+        Protocol::ModelIndexEncoder encoder;
         for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
-            msg >> index;
+            Protocol::RelativeModelIndex relativeIndex;
+            msg >> relativeIndex;
+            const auto index = decoder.decode(relativeIndex);
             const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
 
             qint32 rowCount = -1, columnCount = -1;
@@ -156,37 +211,70 @@ void RemoteModelServer::newRequest(const GammaRay::Message &msg)
                 columnCount = m_model->columnCount(qmIndex);
             }
 
-            reply << index << rowCount << columnCount;
+            reply << encoder.encode(index) << rowCount << columnCount;
         }
         sendMessage(reply);
         break;
     }
 
     case Protocol::ModelContentRequest: {
+        // roles the client needs per column, see RemoteModel::requestedRoles()
+        QVector<QVector<int>> columnRoles;
         quint32 size;
-        msg >> size;
+        msg >> columnRoles >> size;
         Q_ASSERT(size > 0);
 
-        QVector<QModelIndex> indexes;
-        indexes.reserve(size);
+        // group by column, the roles are the same within a group
+        QMap<int, QVector<QModelIndex>> groups;
+        Protocol::ModelIndexDecoder decoder;
         for (quint32 i = 0; i < size; ++i) {
-            Protocol::ModelIndex index;
-            msg >> index;
+            Protocol::RelativeModelIndex relativeIndex;
+            msg >> relativeIndex;
+            const auto index = decoder.decode(relativeIndex);
             const QModelIndex qmIndex = Protocol::toQModelIndex(m_model, index);
             if (!qmIndex.isValid())
                 continue;
-            indexes.push_back(qmIndex);
+            markFetched(index);
+            groups[qmIndex.column()].push_back(qmIndex);
         }
-        if (indexes.isEmpty())
+        if (groups.isEmpty())
             break;
 
+        // columnar layout: per group all indexes, all flags, and then all values per role
         Message msg(m_myAddress, Protocol::ModelContentReply);
-        msg << quint32(indexes.size());
-        for (const auto &qmIndex : std::as_const(indexes)) {
-            msg << Protocol::fromQModelIndex(qmIndex);
-            msg << filterItemData(m_model->itemData(qmIndex));
-            msg.writeCStringMarker(GammaRay::REMOTE_MODEL_MARKER, sizeof(GammaRay::REMOTE_MODEL_MARKER) - 1);
-            msg << qint32(m_model->flags(qmIndex));
+        msg << quint32(groups.size());
+        Protocol::ModelIndexEncoder encoder;
+        for (auto it = groups.cbegin(); it != groups.cend(); ++it) {
+            const auto &indexes = it.value();
+            const auto roles = columnRoles.isEmpty() ? QVector<int>() : columnRoles.value(it.key(), columnRoles.last());
+
+            QVector<QMap<int, QVariant>> itemData;
+            itemData.reserve(indexes.size());
+            QVector<int> availableRoles;
+            for (const auto &qmIndex : indexes) {
+                itemData.push_back(filterItemData(roles.isEmpty() ? m_model->itemData(qmIndex) : requestedItemData(qmIndex, roles)));
+                const auto &data = itemData.last();
+                for (auto roleIt = data.keyBegin(); roleIt != data.keyEnd(); ++roleIt)
+                    availableRoles.push_back(*roleIt);
+            }
+            std::sort(availableRoles.begin(), availableRoles.end());
+            availableRoles.erase(std::unique(availableRoles.begin(), availableRoles.end()), availableRoles.end());
+
+            msg << quint32(indexes.size());
+            for (const auto &qmIndex : indexes)
+                msg << encoder.encode(Protocol::fromQModelIndex(qmIndex));
+            for (const auto &qmIndex : indexes)
+                msg << qint32(m_model->flags(qmIndex));
+
+            msg << quint32(availableRoles.size());
+            QVector<QVariant> values(indexes.size());
+            for (int role : std::as_const(availableRoles)) {
+                for (int i = 0; i < itemData.size(); ++i)
+                    values[i] = itemData.at(i).value(role);
+                msg << qint32(role) << values;
+                // allows the client to skip values of types it can't deserialize
+                msg.writeCStringMarker(GammaRay::REMOTE_MODEL_MARKER, sizeof(GammaRay::REMOTE_MODEL_MARKER) - 1);
+            }
         }
 
         sendMessage(msg);
@@ -275,12 +363,29 @@ QMap<int, QVariant> RemoteModelServer::filterItemData(QMap<int, QVariant> &&item
     return std::move(itemData);
 }
 
+QMap<int, QVariant> RemoteModelServer::requestedItemData(const QModelIndex &index, const QVector<int> &roles) const
+{
+    QMap<int, QVariant> itemData;
+    for (int role : roles) {
+        auto value = m_model->data(index, role);
+        if (value.isValid())
+            itemData.insert(role, std::move(value));
+    }
+    return itemData;
+}
+
 bool RemoteModelServer::canSerialize(const QVariant &value) const
 {
+    // apart from the content of containers this only depends on the type, so we only need to find out once
+    const auto cached = m_serializableTypes.constFind(value.userType());
+    if (cached != m_serializableTypes.cend() && !cached.value())
+        return false;
+
     if (qstrcmp(value.typeName(), "QJSValue") == 0 || qstrcmp(value.typeName(), "QJsonObject") == 0 || qstrcmp(value.typeName(), "QJsonValue") == 0 || qstrcmp(value.typeName(), "QJsonArray") == 0) {
         // QJSValue tries to serialize nested elements and asserts if that fails
         // too bad it can contain QObject* as nested element, which obviously can't be serialized...
         // QJsonObject serialization fails due to QTBUG-73437
+        m_serializableTypes.insert(value.userType(), false);
         return false;
     }
 
@@ -293,6 +398,7 @@ bool RemoteModelServer::canSerialize(const QVariant &value) const
         }
         // note: do not return true here, the fact we can write every single element
         // does not mean we can write the entire thing, or vice vesa...
+        return trySerialize(value);
     } else if (value.canConvert<QVariantMap>()) {
         auto iterable = value.value<QAssociativeIterable>();
         for (auto it = iterable.begin(); it != iterable.end(); ++it) {
@@ -300,12 +406,20 @@ bool RemoteModelServer::canSerialize(const QVariant &value) const
                 return false;
         }
         // see above
+        return trySerialize(value);
     }
 
-    // whitelist a few expensive to encode types we know we can serialize
-    if (value.userType() == qMetaTypeId<QUrl>() || value.userType() == qMetaTypeId<GammaRay::SourceLocation>())
+    if (cached != m_serializableTypes.cend())
         return true;
 
+    // whitelist a few expensive to encode types we know we can serialize
+    const bool serializable = value.userType() == qMetaTypeId<QUrl>() || value.userType() == qMetaTypeId<GammaRay::SourceLocation>() || trySerialize(value);
+    m_serializableTypes.insert(value.userType(), serializable);
+    return serializable;
+}
+
+bool RemoteModelServer::trySerialize(const QVariant &value) const
+{
     // ugly, but there doesn't seem to be a better way atm to find out without trying
     m_dummyBuffer->seek(0);
     QDataStream stream(m_dummyBuffer);
@@ -325,14 +439,222 @@ void RemoteModelServer::modelMonitored(bool monitored)
     }
 }
 
+// two rectangles can be merged if their union does not cover any additional cells
+static bool canMergeRects(const QRect &a, const QRect &b)
+{
+    if (a.contains(b) || b.contains(a))
+        return true;
+    if (a.left() == b.left() && a.right() == b.right())
+        return a.top() <= b.bottom() + 1 && b.top() <= a.bottom() + 1;
+    if (a.top() == b.top() && a.bottom() == b.bottom())
+        return a.left() <= b.right() + 1 && b.left() <= a.right() + 1;
+    return false;
+}
+
+static void addDirtyRect(QVector<QRect> &rects, QRect rect)
+{
+    for (int i = 0; i < rects.size();) {
+        if (canMergeRects(rects.at(i), rect)) {
+            // the grown rectangle might now be mergeable with ones we already checked
+            rect = rect.united(rects.at(i));
+            rects.remove(i);
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+    rects.push_back(rect);
+
+    if (rects.size() > MaxDirtyRects) {
+        QRect bounds;
+        for (const auto &r : std::as_const(rects))
+            bounds |= r;
+        rects = { bounds };
+    }
+}
+
+// Adjusts the interval [low, high] for the insertion (count > 0) or removal (count < 0) of
+// items starting at first. Returns false if the interval has been removed entirely.
+static bool shiftInterval(int &low, int &high, int first, int count)
+{
+    if (count > 0) {
+        if (low >= first)
+            low += count;
+        if (high >= first)
+            high += count;
+        return true;
+    }
+
+    const int last = first - count - 1;
+    low = low > last ? low + count : std::min(low, first);
+    high = high > last ? high + count : std::min(high, first - 1);
+    return low <= high;
+}
+
+static bool isDescendant(const Protocol::ModelIndex &index, const Protocol::ModelIndex &ancestor)
+{
+    return index.size() > ancestor.size() && std::equal(ancestor.begin(), ancestor.end(), index.begin());
+}
+
 void RemoteModelServer::dataChanged(const QModelIndex &begin, const QModelIndex &end,
                                     const QVector<int> &roles)
 {
-    if (!isConnected())
+    if (!isConnected() || !begin.isValid() || !end.isValid())
         return;
-    Message msg(m_myAddress, Protocol::ModelContentChanged);
-    msg << Protocol::fromQModelIndex(begin) << Protocol::fromQModelIndex(end) << roles;
-    sendMessage(msg);
+
+    auto sortedRoles = roles;
+    std::sort(sortedRoles.begin(), sortedRoles.end());
+    sortedRoles.erase(std::unique(sortedRoles.begin(), sortedRoles.end()), sortedRoles.end());
+
+    const QRect rect(QPoint(begin.column(), begin.row()), QPoint(end.column(), end.row()));
+    const auto parent = begin.parent();
+    auto it = std::find_if(m_dirtyRegions.begin(), m_dirtyRegions.end(), [&](const DirtyRegion &region) {
+        return region.parent == parent && region.roles == sortedRoles;
+    });
+    if (it == m_dirtyRegions.end())
+        m_dirtyRegions.push_back({ parent, sortedRoles, { rect } });
+    else
+        addDirtyRect(it->rects, rect);
+
+    if (m_dataChangedInterval < 0)
+        flushDataChanged();
+    else if (!m_dataChangedTimer->isActive())
+        m_dataChangedTimer->start();
+}
+
+void RemoteModelServer::flushDataChanged()
+{
+    m_dataChangedTimer->stop();
+    if (m_dirtyRegions.isEmpty())
+        return;
+
+    const auto regions = std::move(m_dirtyRegions);
+    m_dirtyRegions.clear();
+    if (!m_model || !isConnected())
+        return;
+
+    for (const auto &region : regions) {
+        const auto parent = Protocol::fromQModelIndex(region.parent);
+        const auto fetched = m_fetchedRegions.value(parent);
+        for (const auto &rect : region.rects) {
+            // the client doesn't have anything else, and will request it once it needs it
+            const auto r = rect & fetched;
+            if (r.isEmpty())
+                continue;
+
+            auto begin = parent;
+            begin.push_back(Protocol::ModelIndexData(r.top(), r.left()));
+            auto end = parent;
+            end.push_back(Protocol::ModelIndexData(r.bottom(), r.right()));
+
+            Message msg(m_myAddress, Protocol::ModelContentChanged);
+            msg << begin << end << region.roles;
+            sendMessage(msg);
+        }
+    }
+}
+
+void RemoteModelServer::resetChangeTracking()
+{
+    m_dataChangedTimer->stop();
+    m_dirtyRegions.clear();
+    m_fetchedRegions.clear();
+}
+
+void RemoteModelServer::markFetched(const Protocol::ModelIndex &index)
+{
+    Q_ASSERT(!index.isEmpty());
+    const auto &cell = index.last();
+    auto &rect = m_fetchedRegions[index.mid(0, index.size() - 1)];
+    rect |= QRect(cell.column, cell.row, 1, 1);
+}
+
+void RemoteModelServer::shiftFetchedRegions(const Protocol::ModelIndex &parent, int first, int count,
+                                            Qt::Orientation orientation)
+{
+    if (m_fetchedRegions.isEmpty())
+        return;
+
+    const auto depth = parent.size();
+    QHash<Protocol::ModelIndex, QRect> regions;
+    regions.reserve(m_fetchedRegions.size());
+    for (auto it = m_fetchedRegions.cbegin(); it != m_fetchedRegions.cend(); ++it) {
+        auto index = it.key();
+        auto rect = it.value();
+        if (index == parent) {
+            int low = orientation == Qt::Vertical ? rect.top() : rect.left();
+            int high = orientation == Qt::Vertical ? rect.bottom() : rect.right();
+            if (!shiftInterval(low, high, first, count))
+                continue;
+            if (orientation == Qt::Vertical) {
+                rect.setTop(low);
+                rect.setBottom(high);
+            } else {
+                rect.setLeft(low);
+                rect.setRight(high);
+            }
+        } else if (isDescendant(index, parent)) {
+            auto &pos = orientation == Qt::Vertical ? index[depth].row : index[depth].column;
+            int high = pos;
+            if (!shiftInterval(pos, high, first, count))
+                continue;
+        }
+        regions.insert(index, rect);
+    }
+    m_fetchedRegions = std::move(regions);
+}
+
+void RemoteModelServer::moveFetchedRegions(const Protocol::ModelIndex &sourceParent, int sourceStart,
+                                           int sourceEnd, const Protocol::ModelIndex &destinationParent,
+                                           int destinationRow)
+{
+    if (m_fetchedRegions.isEmpty())
+        return;
+
+    // take out the moved rows, and everything below them, relative to the first moved row
+    const auto depth = sourceParent.size();
+    const int count = sourceEnd - sourceStart + 1;
+    QRect movedRect;
+    const auto sourceIt = m_fetchedRegions.constFind(sourceParent);
+    if (sourceIt != m_fetchedRegions.cend())
+        movedRect = sourceIt.value() & QRect(QPoint(sourceIt.value().left(), sourceStart), QPoint(sourceIt.value().right(), sourceEnd));
+    QVector<QPair<Protocol::ModelIndex, QRect>> movedRegions;
+    for (auto it = m_fetchedRegions.begin(); it != m_fetchedRegions.end();) {
+        const auto &index = it.key();
+        if (isDescendant(index, sourceParent) && index.at(depth).row >= sourceStart && index.at(depth).row <= sourceEnd) {
+            movedRegions.push_back({ index.mid(depth), it.value() });
+            it = m_fetchedRegions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    shiftFetchedRegions(sourceParent, sourceStart, -count, Qt::Vertical);
+
+    // destination parent and row are in terms of the structure before the removal
+    auto destParent = destinationParent;
+    if (isDescendant(destParent, sourceParent) && destParent.at(depth).row > sourceEnd)
+        destParent[depth].row -= count;
+    if (destinationParent == sourceParent && destinationRow > sourceEnd)
+        destinationRow -= count;
+    shiftFetchedRegions(destParent, destinationRow, count, Qt::Vertical);
+
+    const int offset = destinationRow - sourceStart;
+    if (!movedRect.isEmpty())
+        m_fetchedRegions[destParent] |= movedRect.translated(0, offset);
+    for (auto &moved : movedRegions) {
+        moved.first[0].row += offset;
+        m_fetchedRegions.insert(destParent + moved.first, moved.second);
+    }
+}
+
+void RemoteModelServer::removeFetchedRegions(const Protocol::ModelIndex &parent)
+{
+    for (auto it = m_fetchedRegions.begin(); it != m_fetchedRegions.end();) {
+        if (it.key() == parent || isDescendant(it.key(), parent))
+            it = m_fetchedRegions.erase(it);
+        else
+            ++it;
+    }
 }
 
 void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first, int last)
@@ -346,7 +668,9 @@ void RemoteModelServer::headerDataChanged(Qt::Orientation orientation, int first
 
 void RemoteModelServer::rowsInserted(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelRowsAdded, parent, start, end);
+    const auto parentIndex = Protocol::fromQModelIndex(parent);
+    shiftFetchedRegions(parentIndex, start, end - start + 1, Qt::Vertical);
+    sendAddRemoveMessage(Protocol::ModelRowsAdded, parentIndex, start, end);
 }
 
 void RemoteModelServer::rowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart,
@@ -356,6 +680,7 @@ void RemoteModelServer::rowsAboutToBeMoved(const QModelIndex &sourceParent, int
     Q_UNUSED(sourceStart);
     Q_UNUSED(sourceEnd);
     Q_UNUSED(destinationRow);
+    flushDataChanged();
     m_preOpIndexes.push_back(Protocol::fromQModelIndex(sourceParent));
     m_preOpIndexes.push_back(Protocol::fromQModelIndex(destinationParent));
 }
@@ -368,24 +693,31 @@ void RemoteModelServer::rowsMoved(const QModelIndex &sourceParent, int sourceSta
     Q_ASSERT(m_preOpIndexes.size() >= 2);
     const auto destParentIdx = m_preOpIndexes.takeLast();
     const auto sourceParentIdx = m_preOpIndexes.takeLast();
+    moveFetchedRegions(sourceParentIdx, sourceStart, sourceEnd, destParentIdx, destinationRow);
     sendMoveMessage(Protocol::ModelRowsMoved, sourceParentIdx, sourceStart, sourceEnd,
                     destParentIdx, destinationRow);
 }
 
 void RemoteModelServer::rowsRemoved(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelRowsRemoved, parent, start, end);
+    const auto parentIndex = Protocol::fromQModelIndex(parent);
+    shiftFetchedRegions(parentIndex, start, start - end - 1, Qt::Vertical);
+    sendAddRemoveMessage(Protocol::ModelRowsRemoved, parentIndex, start, end);
 }
 
 void RemoteModelServer::columnsInserted(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelColumnsAdded, parent, start, end);
+    const auto parentIndex = Protocol::fromQModelIndex(parent);
+    shiftFetchedRegions(parentIndex, start, end - start + 1, Qt::Horizontal);
+    sendAddRemoveMessage(Protocol::ModelColumnsAdded, parentIndex, start, end);
 }
 
 void RemoteModelServer::columnsMoved(const QModelIndex &sourceParent, int sourceStart,
                                      int sourceEnd, const QModelIndex &destinationParent,
                                      int destinationColumn)
 {
+    // the client resets itself on this
+    m_fetchedRegions.clear();
     sendMoveMessage(Protocol::ModelColumnsMoved,
                     Protocol::fromQModelIndex(sourceParent), sourceStart, sourceEnd,
                     Protocol::fromQModelIndex(destinationParent), destinationColumn);
@@ -393,7 +725,9 @@ void RemoteModelServer::columnsMoved(const QModelIndex &sourceParent, int source
 
 void RemoteModelServer::columnsRemoved(const QModelIndex &parent, int start, int end)
 {
-    sendAddRemoveMessage(Protocol::ModelColumnsRemoved, parent, start, end);
+    const auto parentIndex = Protocol::fromQModelIndex(parent);
+    shiftFetchedRegions(parentIndex, start, start - end - 1, Qt::Horizontal);
+    sendAddRemoveMessage(Protocol::ModelColumnsRemoved, parentIndex, start, end);
 }
 
 
@@ -411,6 +745,14 @@ void RemoteModelServer::layoutChanged(const QList<QPersistentModelIndex> &parent
 void RemoteModelServer::sendLayoutChanged(const QVector<Protocol::ModelIndex> &parents,
                                           quint32 hint)
 {
+    // the client discards all content below the changed parents
+    if (parents.isEmpty()) {
+        m_fetchedRegions.clear();
+    } else {
+        for (const auto &parent : parents)
+            removeFetchedRegions(parent);
+    }
+
     if (!isConnected())
         return;
     Message msg(m_myAddress, Protocol::ModelLayoutChanged);
@@ -420,18 +762,19 @@ void RemoteModelServer::sendLayoutChanged(const QVector<Protocol::ModelIndex> &p
 
 void RemoteModelServer::modelReset()
 {
+    resetChangeTracking();
     if (!isConnected())
         return;
     sendMessage(Message(m_myAddress, Protocol::ModelReset));
 }
 
-void RemoteModelServer::sendAddRemoveMessage(Protocol::MessageType type, const QModelIndex &parent,
+void RemoteModelServer::sendAddRemoveMessage(Protocol::MessageType type, const Protocol::ModelIndex &parent,
                                              int start, int end)
 {
     if (!isConnected())
         return;
     Message msg(m_myAddress, type);
-    msg << Protocol::fromQModelIndex(parent) << start << end;
+    msg << parent << start << end;
     sendMessage(msg);
 }
 
@@ -493,6 +836,8 @@ void RemoteModelServer::setProxyDynamicSortFilter(bool dynamicSortFilter)
 
 Qt::CaseSensitivity RemoteModelServer::proxyFilterCaseSensitivity() const
 {
+    if (auto proxy = qobject_cast<AsyncFilterProxyModel *>(m_model))
+        return proxy->filterPatternCaseSensitivity();
     if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
         return proxy->filterCaseSensitivity();
     return Qt::CaseSensitive;
@@ -500,7 +845,9 @@ Qt::CaseSensitivity RemoteModelServer::proxyFilterCaseSensitivity() const
 
 void RemoteModelServer::setProxyFilterCaseSensitivity(Qt::CaseSensitivity caseSensitivity)
 {
-    if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
+    if (auto proxy = qobject_cast<AsyncFilterProxyModel *>(m_model))
+        proxy->setFilterPatternCaseSensitivity(caseSensitivity);
+    else if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
         proxy->setFilterCaseSensitivity(caseSensitivity);
 }
 
@@ -513,12 +860,16 @@ int RemoteModelServer::proxyFilterKeyColumn() const
 
 void RemoteModelServer::setProxyFilterKeyColumn(int column)
 {
-    if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
+    if (auto proxy = qobject_cast<AsyncFilterProxyModel *>(m_model))
+        proxy->setFilterPatternKeyColumn(column);
+    else if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
         proxy->setFilterKeyColumn(column);
 }
 
 RemoteModelServer::RegExpT RemoteModelServer::proxyFilterRegExp() const
 {
+    if (auto proxy = qobject_cast<AsyncFilterProxyModel *>(m_model))
+        return proxy->filterPattern();
     if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
         return proxy->filterRegularExpression();
     return {};
@@ -526,6 +877,9 @@ RemoteModelServer::RegExpT RemoteModelServer::proxyFilterRegExp() const
 
 void RemoteModelServer::setProxyFilterRegExp(const RegExpT &regExp)
 {
-    if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
+    // filtering large models synchronously would block the target application
+    if (auto proxy = qobject_cast<AsyncFilterProxyModel *>(m_model))
+        proxy->setFilterPattern(regExp);
+    else if (auto proxy = qobject_cast<QSortFilterProxyModel *>(m_model))
         proxy->setFilterRegularExpression(regExp);
 }
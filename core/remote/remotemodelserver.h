@@ -16,13 +16,17 @@
 
 #include <common/protocol.h>
 
+#include <QHash>
+#include <QMap>
 #include <QObject>
 #include <QPointer>
+#include <QRect>
 #include <QRegularExpression>
 
 QT_BEGIN_NAMESPACE
 class QBuffer;
 class QAbstractItemModel;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
@@ -31,6 +35,11 @@ class Message;
 /** Provides the server-side interface for a QAbstractItemModel to be used from a separate process.
  *  If the source model is a QSortFilterProxyModel, this also forwards properties for configuring
  *  the proxy behavior, enabling server-side searching and sorting.
+ *  Filter patterns for an AsyncFilterProxyModel are matched asynchronously.
+ *
+ *  Data changes are not forwarded immediately, but collected and merged into as few rectangular
+ *  ranges as possible, and sent out once per update interval. Only cells the client has actually
+ *  requested content for are included.
  */
 class RemoteModelServer : public QObject
 {
@@ -52,6 +61,14 @@ public:
     /** Set the source model for this model server instance. */
     void setModel(QAbstractItemModel *model);
 
+    /** Interval in milliseconds in which data changes are forwarded to the client.
+     *  Defaults to the @c RemoteModelUpdateInterval probe setting, or 16ms (one frame).
+     *  A negative value forwards changes immediately.
+     *  @since 3.4
+     */
+    int dataChangedInterval() const;
+    void setDataChangedInterval(int msecs);
+
 public slots:
     void newRequest(const GammaRay::Message &msg);
     /** Notifications about an object on the client side (un)monitoring this object.
@@ -62,8 +79,8 @@ public slots:
 private:
     void connectModel();
     void disconnectModel();
-    void sendAddRemoveMessage(Protocol::MessageType type, const QModelIndex &parent, int start,
-                              int end);
+    void sendAddRemoveMessage(Protocol::MessageType type, const Protocol::ModelIndex &parent,
+                              int start, int end);
     void sendMoveMessage(Protocol::MessageType type, const Protocol::ModelIndex &sourceParent,
                          int sourceStart, int sourceEnd,
                          const Protocol::ModelIndex &destinationParent, int destinationIndex);
@@ -71,7 +88,17 @@ private:
     void sendLayoutChanged(
         const QVector<Protocol::ModelIndex> &parents = QVector<Protocol::ModelIndex>(),
         quint32 hint = 0);
+    QMap<int, QVariant> requestedItemData(const QModelIndex &index, const QVector<int> &roles) const;
     bool canSerialize(const QVariant &value) const;
+    bool trySerialize(const QVariant &value) const;
+
+    void resetChangeTracking();
+    void markFetched(const Protocol::ModelIndex &index);
+    void shiftFetchedRegions(const Protocol::ModelIndex &parent, int first, int count,
+                             Qt::Orientation orientation);
+    void moveFetchedRegions(const Protocol::ModelIndex &sourceParent, int sourceStart, int sourceEnd,
+                            const Protocol::ModelIndex &destinationParent, int destinationRow);
+    void removeFetchedRegions(const Protocol::ModelIndex &parent);
 
     // proxy model settings
     bool proxyDynamicSortFilter() const;
@@ -111,16 +138,33 @@ private slots:
 
     void modelDeleted();
 
+    void flushDataChanged();
+
 private:
     QPointer<QAbstractItemModel> m_model;
     // those two are used for canSerialize, since recreating the QBuffer is somewhat expensive,
     // especially since being a QObject triggers all kind of GammaRay internals
     QByteArray m_dummyData;
     QBuffer *m_dummyBuffer;
+    // canSerialize results per non-container metatype
+    mutable QHash<int, bool> m_serializableTypes;
     // converted model indexes from aboutToBeX signals, needed in cases where the operation changes
     // the serialized index (move to sub-tree of source parent for example)
     // as operations can occur nested, we need to have a stack for this
     QList<Protocol::ModelIndex> m_preOpIndexes;
+
+    // pending data changes, merged into rectangles (x: column, y: row) per parent and set of roles
+    struct DirtyRegion
+    {
+        QModelIndex parent;
+        QVector<int> roles;
+        QVector<QRect> rects;
+    };
+    QVector<DirtyRegion> m_dirtyRegions;
+    QTimer *m_dataChangedTimer;
+    int m_dataChangedInterval;
+    // bounding rectangle of the cells the client requested content for, per parent
+    QHash<Protocol::ModelIndex, QRect> m_fetchedRegions;
     Protocol::ObjectAddress m_myAddress;
     bool m_monitored;
 };
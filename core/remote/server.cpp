@@ -182,6 +182,9 @@ void Server::messageReceived(const Message &msg)
             }
 
             Message::setNegotiatedDataVersion(version);
+            // the client knows about batches as well, we passed the protocol version check
+            setMessageBatchingEnabled(true);
+            setStreamCompressionEnabled(true);
             break;
         }
         case Protocol::ObjectMonitored:
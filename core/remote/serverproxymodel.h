@@ -14,6 +14,8 @@
 #ifndef GAMMARAY_SERVERPROXYMODEL_H
 #define GAMMARAY_SERVERPROXYMODEL_H
 
+#include "asyncfilterproxymodel.h"
+
 #include <common/modelevent.h>
 
 #include <QCoreApplication>
@@ -35,16 +37,33 @@ inline void init<QSortFilterProxyModel>(QSortFilterProxyModel *proxy)
     proxy->setAutoAcceptChildRows(true);
 }
 
+/** The class ServerProxyModel actually derives from, filtering of plain QSortFilterProxyModels
+ *  is done asynchronously, as this is what the client side search lines end up in.
+ */
+template<typename BaseProxy>
+struct ServerProxyBase
+{
+    using type = BaseProxy;
+};
+
+template<>
+struct ServerProxyBase<QSortFilterProxyModel>
+{
+    using type = AsyncFilterProxyModel;
+};
+
 /** Sort/filter proxy model for server-side use to pass through extra roles in itemData().
  *  Every remoted proxy model should be wrapped into this template, unless you already have
  *  a special implementation for itemData() handling this.
  */
 template<typename BaseProxy>
-class ServerProxyModel : public BaseProxy
+class ServerProxyModel : public ServerProxyBase<BaseProxy>::type
 {
+    using Base = typename ServerProxyBase<BaseProxy>::type;
+
 public:
     explicit ServerProxyModel(QObject *parent = nullptr)
-        : BaseProxy(parent)
+        : Base(parent)
         , m_sourceModel(nullptr)
         , m_active(false)
     {
@@ -67,8 +86,8 @@ public:
 
     QMap<int, QVariant> itemData(const QModelIndex &index) const override
     {
-        const QModelIndex sourceIndex = BaseProxy::mapToSource(index);
-        auto d = BaseProxy::sourceModel()->itemData(sourceIndex);
+        const QModelIndex sourceIndex = Base::mapToSource(index);
+        auto d = Base::sourceModel()->itemData(sourceIndex);
         for (int role : m_extraRoles)
             d.insert(role, sourceIndex.data(role));
         for (int role : m_extraProxyRoles)
@@ -81,7 +100,7 @@ public:
         m_sourceModel = sourceModel;
         if (m_active && sourceModel) {
             Model::used(sourceModel);
-            BaseProxy::setSourceModel(sourceModel);
+            Base::setSourceModel(sourceModel);
         }
     }
 
@@ -90,7 +109,7 @@ public:
     {
         if (!m_active)
             Model::used(this);
-        return BaseProxy::index(row, column, parent);
+        return Base::index(row, column, parent);
     }
 
 protected:
@@ -101,13 +120,13 @@ protected:
             m_active = mev->used();
             if (m_sourceModel) {
                 QCoreApplication::sendEvent(m_sourceModel, event);
-                if (mev->used() && BaseProxy::sourceModel() != m_sourceModel)
-                    BaseProxy::setSourceModel(m_sourceModel);
+                if (mev->used() && Base::sourceModel() != m_sourceModel)
+                    Base::setSourceModel(m_sourceModel);
                 else if (!mev->used())
-                    BaseProxy::setSourceModel(nullptr);
+                    Base::setSourceModel(nullptr);
             }
         }
-        BaseProxy::customEvent(event);
+        Base::customEvent(event);
     }
 
 private:
@@ -27,6 +27,8 @@
 #include <private/qevent_p.h>
 #include <private/qpointingdevice_p.h>
 
+#include <algorithm>
+
 using namespace GammaRay;
 
 RemoteViewServer::RemoteViewServer(const QString &name, QObject *parent)
@@ -66,6 +68,7 @@ void RemoteViewServer::pickElementId(const GammaRay::ObjectId &id)
 
 void RemoteViewServer::resetView()
 {
+    m_frameEncoder.reset();
     if (isActive())
         emit reset();
     else
@@ -93,9 +96,28 @@ void RemoteViewServer::sendFrame(const RemoteViewFrame &frame)
     m_lastTransmittedViewRect = frame.viewRect();
     m_lastTransmittedImageRect = frame.transform().mapRect(QRect(QPoint(), frameImageSize));
 
+    // complete frames are requested for saving them, those need full resolution
+    const int factor = m_pendingCompleteFrame ? 1 : downscaleFactor(frame);
     if (m_pendingCompleteFrame && frameImageSize == frame.viewRect().size())
         m_pendingCompleteFrame = false;
-    emit frameUpdated(frame);
+
+    // in-process there is nothing to gain from downscaling or encoding
+    if (factor > 1 || (m_frameCodec == TileDeltaFrames && Endpoint::isConnected())) {
+        auto transferFrame = frame;
+        transferFrame.downscaleImage(factor);
+        if (m_frameCodec == TileDeltaFrames)
+            transferFrame.encodeImage(&m_frameEncoder);
+        emit frameUpdated(transferFrame);
+    } else {
+        emit frameUpdated(frame);
+    }
+}
+
+int RemoteViewServer::downscaleFactor(const RemoteViewFrame &frame) const
+{
+    if (m_userScale <= 0.0 || !Endpoint::isConnected())
+        return 1;
+    return std::max(1, int(frame.image().devicePixelRatio() / m_userScale));
 }
 
 QRectF RemoteViewServer::userViewport() const
@@ -117,6 +139,20 @@ void RemoteViewServer::requestCompleteFrame()
     sourceChanged();
 }
 
+void RemoteViewServer::setFrameCodec(GammaRay::RemoteViewInterface::FrameCodec codec)
+{
+    m_frameCodec = codec;
+    m_frameEncoder.reset();
+}
+
+void RemoteViewServer::requestKeyFrame()
+{
+    // the client is waiting for a usable frame, not for the next source change
+    m_frameEncoder.reset();
+    m_clientReady = true;
+    sourceChanged();
+}
+
 void RemoteViewServer::clientViewUpdated()
 {
     m_clientReady = true;
@@ -204,6 +240,7 @@ void RemoteViewServer::setViewActive(bool active)
     m_clientActive = active;
     m_clientReady = active;
     m_pendingCompleteFrame = false;
+    m_frameEncoder.reset();
     if (active)
         sourceChanged();
     else
@@ -218,10 +255,24 @@ void RemoteViewServer::sendUserViewport(const QRectF &userViewport)
         sourceChanged();
 }
 
+void RemoteViewServer::sendUserScale(double scale)
+{
+    if (m_userScale == scale)
+        return;
+    // zooming in might need more detail than the last frame had
+    const bool needsUpdate = scale > m_userScale && m_userScale > 0.0;
+    m_userScale = scale;
+    if (needsUpdate || scale <= 0.0)
+        sourceChanged();
+}
+
 void RemoteViewServer::clientConnectedChanged(bool connected)
 {
-    if (!connected)
+    if (!connected) {
         setViewActive(false);
+        m_frameCodec = RawFrames; // the next client has to ask for it again
+        m_userScale = 0.0;
+    }
 }
 
 void RemoteViewServer::requestUpdateTimeout()
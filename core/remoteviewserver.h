@@ -18,6 +18,7 @@
 
 #include "gammaray_core_export.h"
 
+#include <common/remoteviewframecodec.h>
 #include <common/remoteviewinterface.h>
 
 #include <QPointer>
@@ -60,6 +61,8 @@ public slots:
     /// call this to indicate the source has changed and the client requires an update
     void sourceChanged();
     void requestCompleteFrame() override;
+    void setFrameCodec(GammaRay::RemoteViewInterface::FrameCodec codec) override;
+    void requestKeyFrame() override;
 
 signals:
     void elementsAtRequested(const QPoint &pos, GammaRay::RemoteViewInterface::RequestMode mode);
@@ -80,9 +83,11 @@ private:
                         const QList<QTouchEvent::TouchPoint> &touchPoints) override;
     void setViewActive(bool active) override;
     void sendUserViewport(const QRectF &userViewport) override;
+    void sendUserScale(double scale) override;
     void clientViewUpdated() override;
 
     void checkRequestUpdate();
+    int downscaleFactor(const RemoteViewFrame &frame) const;
 
 private slots:
     void clientConnectedChanged(bool connected);
@@ -94,6 +99,7 @@ private:
     QRectF m_lastTransmittedViewRect;
     QRectF m_lastTransmittedImageRect;
     QRectF m_userViewport;
+    double m_userScale = 0.0;
     bool m_clientActive;
     bool m_sourceChanged;
     bool m_clientReady;
@@ -101,6 +107,8 @@ private:
     bool m_pendingReset;
     bool m_pendingCompleteFrame;
     std::unique_ptr<QPointingDevice> m_touchDevice;
+    RemoteViewFrameEncoder m_frameEncoder;
+    FrameCodec m_frameCodec = RawFrames;
 };
 }
 
@@ -0,0 +1,116 @@
+/*
+  sortedobjectlist.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_SORTEDOBJECTLIST_H
+#define GAMMARAY_SORTEDOBJECTLIST_H
+
+#include <QVector>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+/*! Helpers for batch updates of the pointer-sorted object lists used as rows by the object models.
+ *
+ * Batches are split into ranges of contiguous rows, so that models can emit a single
+ * row insertion/removal per range rather than one per object.
+ */
+namespace SortedObjectList {
+struct Range
+{
+    int row; // row in the sorted list
+    int first; // first index in the batch, for insertions
+    int count;
+};
+
+/*! Sorts @p objects and removes duplicates as well as entries already contained in @p list. */
+inline void prepareInsertion(const QVector<QObject *> &list, QVector<QObject *> &objects)
+{
+    std::sort(objects.begin(), objects.end());
+    objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [&list](QObject *obj) {
+                      return std::binary_search(list.begin(), list.end(), obj);
+                  }),
+                  objects.end());
+}
+
+/*! Returns the ranges the sorted @p objects have to be inserted at into @p list, in ascending order.
+ *  Insert them back to front, so the rows of the remaining ranges stay valid.
+ */
+inline QVector<Range> insertionRanges(const QVector<QObject *> &list, const QVector<QObject *> &objects)
+{
+    QVector<Range> ranges;
+    auto listIt = list.begin();
+    for (int i = 0; i < objects.size();) {
+        listIt = std::lower_bound(listIt, list.end(), objects.at(i));
+        // all following objects smaller than the next list entry end up in the same gap
+        const auto last = listIt == list.end()
+            ? objects.end()
+            : std::lower_bound(objects.begin() + i, objects.end(), *listIt);
+        const int count = int(std::distance(objects.begin() + i, last));
+        ranges.push_back({ int(std::distance(list.begin(), listIt)), i, count });
+        i += count;
+    }
+    return ranges;
+}
+
+inline void insert(QVector<QObject *> &list, const QVector<QObject *> &objects, const Range &range)
+{
+    list.insert(range.row, range.count, nullptr);
+    std::copy(objects.begin() + range.first, objects.begin() + range.first + range.count, list.begin() + range.row);
+}
+
+/*! Merges the sorted @p objects into @p list in one go, for use with a model reset. */
+inline void merge(QVector<QObject *> &list, const QVector<QObject *> &objects)
+{
+    QVector<QObject *> merged;
+    merged.reserve(list.size() + objects.size());
+    std::merge(list.begin(), list.end(), objects.begin(), objects.end(), std::back_inserter(merged));
+    list = std::move(merged);
+}
+
+/*! Returns the ranges of contiguous rows occupied by @p objects in @p list, in ascending order.
+ *  Objects not contained in @p list are ignored. Remove them back to front.
+ */
+inline QVector<Range> removalRanges(const QVector<QObject *> &list, const QVector<QObject *> &objects)
+{
+    QVector<int> rows;
+    rows.reserve(objects.size());
+    for (QObject *obj : objects) {
+        const auto it = std::lower_bound(list.begin(), list.end(), obj);
+        if (it != list.end() && *it == obj)
+            rows.push_back(int(std::distance(list.begin(), it)));
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    QVector<Range> ranges;
+    for (int row : std::as_const(rows)) {
+        if (!ranges.isEmpty() && ranges.last().row + ranges.last().count == row)
+            ++ranges.last().count;
+        else
+            ranges.push_back({ row, 0, 1 });
+    }
+    return ranges;
+}
+
+inline void remove(QVector<QObject *> &list, const Range &range)
+{
+    list.remove(range.row, range.count);
+}
+}
+}
+
+#endif // GAMMARAY_SORTEDOBJECTLIST_H
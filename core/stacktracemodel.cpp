@@ -37,10 +37,31 @@ void StackTraceModel::setStackTrace(const Execution::Trace &trace)
         beginInsertRows(QModelIndex(), 0, trace.size() - 1);
         m_trace = trace;
         m_frames.clear();
+        m_resolved = Execution::resolveAllCached(trace, m_frames);
+        if (!m_resolved)
+            m_frames.resize(trace.size());
         endInsertRows();
+
+        // symbol lookup can take seconds, don't block the host application for that
+        if (!m_resolved) {
+            Execution::resolveAllAsync(trace, this, [this, trace](const QVector<Execution::ResolvedFrame> &frames) {
+                setResolvedFrames(trace, frames);
+            });
+        }
     }
 }
 
+void StackTraceModel::setResolvedFrames(const Execution::Trace &trace, const QVector<Execution::ResolvedFrame> &frames)
+{
+    // the trace changed in the meantime
+    if (m_resolved || m_trace != trace || frames.size() != m_frames.size())
+        return;
+
+    m_frames = frames;
+    m_resolved = true;
+    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount(QModelIndex()) - 1));
+}
+
 int StackTraceModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
@@ -59,13 +80,11 @@ QVariant StackTraceModel::data(const QModelIndex &index, int role) const
     if (!index.isValid())
         return QVariant();
 
-    if (m_trace.size() && !m_frames.size()) {
-        m_frames = Execution::resolveAll(m_trace);
-    }
-
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
         case 0:
+            if (!m_resolved)
+                return tr("Resolving...");
             return m_frames.at(index.row()).name;
         case 1:
             return QVariant::fromValue(m_frames.at(index.row()).location);
@@ -90,9 +109,10 @@ QVariant StackTraceModel::headerData(int section, Qt::Orientation orientation, i
 
 QStringList StackTraceModel::fullTrace() const
 {
+    const auto frames = m_resolved ? m_frames : Execution::resolveAll(m_trace);
     QStringList bt;
-    bt.reserve(m_frames.size());
-    for (const auto &frame : std::as_const(m_frames)) {
+    bt.reserve(frames.size());
+    for (const auto &frame : frames) {
         if (frame.location.isValid())
             bt.push_back(frame.name + QLatin1String(" (") + frame.location.displayString() + QLatin1Char(')'));
         else
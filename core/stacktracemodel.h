@@ -42,8 +42,11 @@ public:
     QStringList fullTrace() const;
 
 private:
-    mutable QVector<Execution::ResolvedFrame> m_frames;
+    void setResolvedFrames(const Execution::Trace &trace, const QVector<Execution::ResolvedFrame> &frames);
+
+    QVector<Execution::ResolvedFrame> m_frames;
     Execution::Trace m_trace;
+    bool m_resolved = false;
 };
 }
 
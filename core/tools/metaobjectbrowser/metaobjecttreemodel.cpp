@@ -41,7 +41,8 @@ MetaObjectTreeModel::MetaObjectTreeModel(QObject *parent)
     connect(registry(), &MetaObjectRegistry::afterMetaObjectAdded, this, &MetaObjectTreeModel::endAddMetaObject);
     connect(registry(), &MetaObjectRegistry::dataChanged, this, &MetaObjectTreeModel::scheduleDataChange);
 
-    m_pendingDataChangedTimer->setInterval(100);
+    // the registry already reports changes once per update interval, this only merges them into ranges
+    m_pendingDataChangedTimer->setInterval(0);
     m_pendingDataChangedTimer->setSingleShot(true);
     connect(m_pendingDataChangedTimer, &QTimer::timeout, this, &MetaObjectTreeModel::emitPendingDataChanged);
 }
@@ -0,0 +1,48 @@
+/*
+  tracestore.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "tracestore.h"
+
+using namespace GammaRay;
+
+TraceStore::TraceId TraceStore::intern(const Execution::Trace &trace)
+{
+    if (trace.empty())
+        return InvalidTraceId;
+
+    auto it = m_ids.constFind(trace);
+    if (it != m_ids.constEnd())
+        return it.value();
+
+    m_traces.push_back(trace);
+    const auto id = TraceId(m_traces.size());
+    m_ids.insert(trace, id);
+    return id;
+}
+
+Execution::Trace TraceStore::trace(TraceId id) const
+{
+    if (id == InvalidTraceId || id > TraceId(m_traces.size()))
+        return Execution::Trace();
+    return m_traces.at(int(id - 1));
+}
+
+int TraceStore::size() const
+{
+    return m_traces.size();
+}
+
+void TraceStore::clear()
+{
+    m_traces.clear();
+    m_ids.clear();
+}
@@ -0,0 +1,57 @@
+/*
+  tracestore.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_TRACESTORE_H
+#define GAMMARAY_TRACESTORE_H
+
+#include "gammaray_core_export.h"
+#include "execution.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace GammaRay {
+/*! Deduplicated storage of backtraces.
+ *
+ * Objects are usually created from a comparatively small number of code locations,
+ * so most of their construction backtraces are identical. Interning them allows
+ * to keep a single copy of each distinct trace, and to refer to it by a 32 bit id.
+ *
+ * @internal
+ */
+class GAMMARAY_CORE_EXPORT TraceStore
+{
+public:
+    using TraceId = quint32;
+    /*! Id returned for empty traces, never refers to a stored trace. */
+    static const TraceId InvalidTraceId = 0;
+
+    TraceStore() = default;
+
+    /*! Returns the id of @p trace, storing it if it isn't known yet. */
+    TraceId intern(const Execution::Trace &trace);
+    /*! Returns the trace with id @p id, or an empty trace for an unknown id. */
+    Execution::Trace trace(TraceId id) const;
+
+    /*! Number of distinct traces stored. */
+    int size() const;
+    void clear();
+
+private:
+    Q_DISABLE_COPY(TraceStore)
+
+    QVector<Execution::Trace> m_traces; // indexed by id - 1
+    QHash<Execution::Trace, TraceId> m_ids;
+};
+}
+
+#endif // GAMMARAY_TRACESTORE_H
@@ -0,0 +1,273 @@
+/*
+  allocationmodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "allocationmodel.h"
+
+#include <core/metaobjectregistry.h>
+#include <core/probe.h>
+#include <core/probesettings.h>
+
+#include <QMutexLocker>
+#include <QTimer>
+
+#include <algorithm>
+
+using namespace GammaRay;
+
+static int lifetimeBucket(qint64 msecs)
+{
+    int bucket = AllocationModel::LessThan1ms;
+    for (qint64 bound = 1; msecs >= bound && bucket < AllocationModel::LongerThan10s; bound *= 10)
+        ++bucket;
+    return bucket;
+}
+
+AllocationModel::AllocationModel(Probe *probe, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_probe(probe)
+    , m_historySize(std::max(1, ProbeSettings::value(QStringLiteral("AllocationProfilerHistorySize"), 60).toInt()))
+    , m_updateTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    {
+        // objects that existed already count as alive, but their lifetime is unknown
+        const auto &objects = probe->allQObjects();
+        QMutexLocker lock(Probe::objectLock());
+        m_objects.reserve(objects.size());
+        for (auto obj : objects) {
+            if (!probe->isValidObject(obj))
+                continue;
+            const auto index = classIndex(obj->metaObject());
+            ++m_classes[index].alive;
+            m_objects.insert(obj, { index, -1 });
+        }
+    }
+
+    connect(probe, &Probe::objectCreated, this, &AllocationModel::objectCreated);
+    connect(probe, &Probe::objectDestroyed, this, &AllocationModel::objectDestroyed);
+
+    // rates are per second anyway, so there is no point in reporting each individual change
+    m_updateTimer->setInterval(1000);
+    connect(m_updateTimer, &QTimer::timeout, this, &AllocationModel::updateRates);
+    m_updateTimer->start();
+}
+
+AllocationModel::~AllocationModel() = default;
+
+int AllocationModel::historySize() const
+{
+    return m_historySize;
+}
+
+int AllocationModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return ColumnCount;
+}
+
+int AllocationModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_classes.size();
+}
+
+QVariant AllocationModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const auto &history = m_classes[index.row()];
+    const auto lastSecond = currentSecond() - 1;
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case ClassColumn:
+            return history.className;
+        case CreatedColumn: {
+            const auto s = sample(history, lastSecond);
+            return s ? s->created : 0;
+        }
+        case DestroyedColumn: {
+            const auto s = sample(history, lastSecond);
+            return s ? s->destroyed : 0;
+        }
+        case AliveColumn:
+            return history.alive;
+        case ChurnColumn:
+        case LifetimeColumn: {
+            int churned = 0;
+            int lifetimeCount = 0;
+            qint64 lifetimeSum = 0;
+            for (auto second = lastSecond - m_historySize + 1; second <= lastSecond; ++second) {
+                const auto s = sample(history, second);
+                if (!s)
+                    continue;
+                churned += s->churned;
+                lifetimeSum += s->lifetimeSum;
+                for (const auto count : s->lifetimes)
+                    lifetimeCount += count;
+            }
+            if (index.column() == ChurnColumn)
+                return churned;
+            return lifetimeCount ? double(lifetimeSum) / lifetimeCount : -1.0;
+        }
+        }
+    } else if (role == Qt::ToolTipRole && index.column() == ClassColumn && index.row() == m_shortLivedIndex) {
+        return QStringLiteral("Objects destroyed before their creation was reported, typically within the same event loop iteration they were created in. Their type can no longer be determined at that point.");
+    } else if (role == CreationHistoryRole && index.column() == HistoryColumn) {
+        return QVariant::fromValue(timeSeries(history, &Sample::created));
+    } else if (role == DestructionHistoryRole && index.column() == HistoryColumn) {
+        return QVariant::fromValue(timeSeries(history, &Sample::destroyed));
+    } else if (role == LifetimeHistogramRole && index.column() == LifetimeColumn) {
+        return QVariant::fromValue(lifetimeHistogram(history));
+    }
+
+    return QVariant();
+}
+
+QMap<int, QVariant> AllocationModel::itemData(const QModelIndex &index) const
+{
+    auto d = QAbstractTableModel::itemData(index);
+    if (index.column() == HistoryColumn) {
+        d.insert(CreationHistoryRole, data(index, CreationHistoryRole));
+        d.insert(DestructionHistoryRole, data(index, DestructionHistoryRole));
+    } else if (index.column() == LifetimeColumn) {
+        d.insert(LifetimeHistogramRole, data(index, LifetimeHistogramRole));
+    }
+    return d;
+}
+
+void AllocationModel::objectCreated(QObject *obj)
+{
+    if (m_objects.contains(obj)) // reported before we got to see allQObjects()
+        return;
+
+    const auto index = classIndex(obj->metaObject());
+    auto &history = m_classes[index];
+    ++history.alive;
+    ++currentSample(history).created;
+    m_objects.insert(obj, { index, m_clock.elapsed() });
+}
+
+void AllocationModel::objectDestroyed(QObject *obj)
+{
+    const auto it = m_objects.constFind(obj);
+    if (it == m_objects.cend()) {
+        // created and destroyed again before objectCreated() got emitted for it
+        if (m_shortLivedIndex < 0)
+            m_shortLivedIndex = addClass(QStringLiteral("<short-lived>"));
+        auto &sample = currentSample(m_classes[m_shortLivedIndex]);
+        ++sample.created;
+        ++sample.destroyed;
+        ++sample.churned;
+        return;
+    }
+
+    const auto info = it.value();
+    m_objects.erase(it);
+
+    auto &history = m_classes[info.classIndex];
+    --history.alive;
+    auto &sample = currentSample(history);
+    ++sample.destroyed;
+    if (info.created >= 0) {
+        const auto lifetime = m_clock.elapsed() - info.created;
+        ++sample.churned;
+        sample.lifetimeSum += lifetime;
+        ++sample.lifetimes[lifetimeBucket(lifetime)];
+    }
+}
+
+void AllocationModel::updateRates()
+{
+    if (m_classes.empty())
+        return;
+    emit dataChanged(index(0, CreatedColumn), index(rowCount() - 1, HistoryColumn));
+}
+
+int AllocationModel::classIndex(const QMetaObject *metaObject)
+{
+    metaObject = m_probe->metaObjectRegistry()->canonicalMetaObject(metaObject);
+    const auto it = m_classIndexes.constFind(metaObject);
+    if (it != m_classIndexes.cend())
+        return it.value();
+
+    const auto index = addClass(QString::fromUtf8(metaObject->className()));
+    m_classIndexes.insert(metaObject, index);
+    return index;
+}
+
+int AllocationModel::addClass(const QString &className)
+{
+    const int row = m_classes.size();
+    beginInsertRows(QModelIndex(), row, row);
+    ClassHistory history;
+    history.className = className;
+    // one more than exposed, for the second currently being recorded
+    history.samples.resize(m_historySize + 1);
+    m_classes.push_back(std::move(history));
+    endInsertRows();
+    return row;
+}
+
+qint64 AllocationModel::currentSecond() const
+{
+    return m_clock.elapsed() / 1000;
+}
+
+AllocationModel::Sample &AllocationModel::currentSample(ClassHistory &history)
+{
+    const auto second = currentSecond();
+    auto &sample = history.samples[second % history.samples.size()];
+    if (sample.second != second) { // left over from a previous round through the ring buffer
+        sample = Sample();
+        sample.second = second;
+    }
+    return sample;
+}
+
+const AllocationModel::Sample *AllocationModel::sample(const ClassHistory &history, qint64 second) const
+{
+    if (second < 0)
+        return nullptr;
+    const auto &sample = history.samples[second % history.samples.size()];
+    return sample.second == second ? &sample : nullptr;
+}
+
+QVector<int> AllocationModel::timeSeries(const ClassHistory &history, int Sample::*field) const
+{
+    QVector<int> values;
+    values.reserve(m_historySize);
+    const auto lastSecond = currentSecond() - 1;
+    for (auto second = lastSecond - m_historySize + 1; second <= lastSecond; ++second) {
+        const auto s = sample(history, second);
+        values.push_back(s ? s->*field : 0);
+    }
+    return values;
+}
+
+QVector<int> AllocationModel::lifetimeHistogram(const ClassHistory &history) const
+{
+    QVector<int> buckets(LifetimeBucketCount, 0);
+    const auto lastSecond = currentSecond() - 1;
+    for (auto second = lastSecond - m_historySize + 1; second <= lastSecond; ++second) {
+        const auto s = sample(history, second);
+        if (!s)
+            continue;
+        for (int i = 0; i < LifetimeBucketCount; ++i)
+            buckets[i] += s->lifetimes[i];
+    }
+    return buckets;
+}
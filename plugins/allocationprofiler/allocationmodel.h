@@ -0,0 +1,142 @@
+/*
+  allocationmodel.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_ALLOCATIONPROFILER_ALLOCATIONMODEL_H
+#define GAMMARAY_ALLOCATIONPROFILER_ALLOCATIONMODEL_H
+
+#include <common/objectmodel.h>
+
+#include <QAbstractTableModel>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+#include <array>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+class Probe;
+
+/** @brief Per-class object creation and destruction rates.
+ *
+ *  Counts are kept in one-second samples, in a fixed-size ring buffer per class covering the
+ *  last @c AllocationProfilerHistorySize seconds (probe setting, 60 by default). Only the last
+ *  complete second and the aggregates over the history window are exposed as columns, the
+ *  individual samples are available as time series via the history roles.
+ *
+ *  Objects destroyed before the probe announced their creation, typically within the same
+ *  event loop iteration, cannot be attributed to a class anymore. Those are accounted for
+ *  in a separate row.
+ *
+ *  @since 3.4
+ */
+class AllocationModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit AllocationModel(Probe *probe, QObject *parent = nullptr);
+    ~AllocationModel() override;
+
+    enum Columns
+    {
+        ClassColumn,
+        CreatedColumn, ///< creations in the last complete second
+        DestroyedColumn, ///< destructions in the last complete second
+        AliveColumn,
+        ChurnColumn, ///< objects created and destroyed again within the history window
+        LifetimeColumn, ///< mean lifetime in ms of the churned objects, -1 if unknown
+        HistoryColumn,
+        ColumnCount
+    };
+
+    enum Roles
+    {
+        /** QVector<int> of creations per second in the history window, oldest first. */
+        CreationHistoryRole = ObjectModel::UserRole,
+        /** QVector<int> of destructions per second in the history window, oldest first. */
+        DestructionHistoryRole,
+        /** QVector<int> with the number of churned objects per LifetimeBucket in the history window. */
+        LifetimeHistogramRole
+    };
+
+    /** Lifetime histogram buckets, the upper bound of each is 10 times the previous one. */
+    enum LifetimeBucket
+    {
+        LessThan1ms,
+        LessThan10ms,
+        LessThan100ms,
+        LessThan1s,
+        LessThan10s,
+        LongerThan10s,
+        LifetimeBucketCount
+    };
+
+    /** Number of one-second samples exposed via the history roles. */
+    int historySize() const;
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QMap<int, QVariant> itemData(const QModelIndex &index) const override;
+
+private:
+    struct Sample
+    {
+        qint64 second = -1;
+        int created = 0;
+        int destroyed = 0;
+        int churned = 0;
+        qint64 lifetimeSum = 0; // ms, of churned objects with a known lifetime
+        std::array<int, LifetimeBucketCount> lifetimes = {};
+    };
+
+    struct ClassHistory
+    {
+        QString className;
+        int alive = 0;
+        std::vector<Sample> samples; // ring buffer, indexed by second modulo its size
+    };
+
+    struct ObjectInfo
+    {
+        int classIndex;
+        qint64 created; // ms since m_clock start, -1 for objects that existed already
+    };
+
+    void objectCreated(QObject *obj);
+    void objectDestroyed(QObject *obj);
+    void updateRates();
+
+    int classIndex(const QMetaObject *metaObject);
+    int addClass(const QString &className);
+    qint64 currentSecond() const;
+    Sample &currentSample(ClassHistory &history);
+    const Sample *sample(const ClassHistory &history, qint64 second) const;
+    QVector<int> timeSeries(const ClassHistory &history, int Sample::*field) const;
+    QVector<int> lifetimeHistogram(const ClassHistory &history) const;
+
+    Probe *m_probe;
+    std::vector<ClassHistory> m_classes;
+    QHash<const QMetaObject *, int> m_classIndexes;
+    QHash<QObject *, ObjectInfo> m_objects;
+    int m_shortLivedIndex = -1; // row for objects destroyed before being announced
+    int m_historySize;
+    QElapsedTimer m_clock;
+    QTimer *m_updateTimer;
+};
+}
+
+#endif // GAMMARAY_ALLOCATIONPROFILER_ALLOCATIONMODEL_H
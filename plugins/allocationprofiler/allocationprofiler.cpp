@@ -0,0 +1,24 @@
+/*
+  allocationprofiler.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "allocationprofiler.h"
+#include "allocationmodel.h"
+
+using namespace GammaRay;
+
+AllocationProfiler::AllocationProfiler(Probe *probe, QObject *parent)
+    : QObject(parent)
+{
+    probe->registerModel(QStringLiteral("com.kdab.GammaRay.AllocationModel"), new AllocationModel(probe, this));
+}
+
+AllocationProfiler::~AllocationProfiler() = default;
@@ -0,0 +1,42 @@
+/*
+  allocationprofiler.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_ALLOCATIONPROFILER_H
+#define GAMMARAY_ALLOCATIONPROFILER_H
+
+#include <core/toolfactory.h>
+
+namespace GammaRay {
+
+class AllocationProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AllocationProfiler(Probe *probe, QObject *parent = nullptr);
+    ~AllocationProfiler() override;
+};
+
+class AllocationProfilerFactory : public QObject, public StandardToolFactory<QObject, AllocationProfiler>
+{
+    Q_OBJECT
+    Q_INTERFACES(GammaRay::ToolFactory)
+    Q_PLUGIN_METADATA(IID "com.kdab.GammaRay.ToolFactory" FILE "gammaray_allocationprofiler.json")
+public:
+    explicit AllocationProfilerFactory(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+};
+
+}
+
+#endif // GAMMARAY_ALLOCATIONPROFILER_H
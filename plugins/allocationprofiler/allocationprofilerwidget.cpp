@@ -0,0 +1,113 @@
+/*
+  allocationprofilerwidget.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "allocationprofilerwidget.h"
+#include "ui_allocationprofilerwidget.h"
+#include "allocationmodel.h"
+#include "clientallocationmodel.h"
+
+#include <ui/searchlinecontroller.h>
+
+#include <common/objectbroker.h>
+
+#include <QPainter>
+#include <QStyledItemDelegate>
+
+#include <algorithm>
+
+using namespace GammaRay;
+
+namespace {
+/** Paints creations upwards and destructions downwards from the vertical center, one bar per second. */
+class SparklineDelegate : public QStyledItemDelegate
+{
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+
+        const auto created = index.data(AllocationModel::CreationHistoryRole).value<QVector<int>>();
+        const auto destroyed = index.data(AllocationModel::DestructionHistoryRole).value<QVector<int>>();
+        const auto samples = std::max(created.size(), destroyed.size());
+        if (samples == 0)
+            return;
+
+        int maximum = 1;
+        for (const auto value : created)
+            maximum = std::max(maximum, value);
+        for (const auto value : destroyed)
+            maximum = std::max(maximum, value);
+
+        const QRectF rect = option.rect.adjusted(2, 2, -2, -2);
+        const auto barWidth = rect.width() / samples;
+        const auto halfHeight = rect.height() / 2;
+        const auto center = rect.top() + halfHeight;
+
+        painter->save();
+        painter->setPen(Qt::NoPen);
+        for (int i = 0; i < samples; ++i) {
+            const auto x = rect.left() + i * barWidth;
+            const auto up = halfHeight * created.value(i) / maximum;
+            const auto down = halfHeight * destroyed.value(i) / maximum;
+            painter->fillRect(QRectF(x, center - up, barWidth, up), QColor(0, 160, 0));
+            painter->fillRect(QRectF(x, center, barWidth, down), QColor(200, 0, 0));
+        }
+        painter->restore();
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override
+    {
+        auto size = QStyledItemDelegate::sizeHint(option, index);
+        size.setWidth(std::max(size.width(), 2 * index.data(AllocationModel::CreationHistoryRole).value<QVector<int>>().size()));
+        return size;
+    }
+};
+}
+
+AllocationProfilerWidget::AllocationProfilerWidget(QWidget *parent)
+    : QWidget(parent)
+    , ui(new Ui::AllocationProfilerWidget)
+    , m_stateManager(this)
+{
+    // the history roles are transferred as plain integer vectors
+    qRegisterMetaType<QVector<int>>();
+
+    ui->setupUi(this);
+
+    auto sourceModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.AllocationModel"));
+    // the time series are only needed where they are displayed
+    sourceModel->setProperty("requestedRoles", QVariant::fromValue(QVector<QVector<int>> { {}, { Qt::DisplayRole }, { Qt::DisplayRole }, { Qt::DisplayRole }, { Qt::DisplayRole }, { Qt::DisplayRole, AllocationModel::LifetimeHistogramRole }, { AllocationModel::CreationHistoryRole, AllocationModel::DestructionHistoryRole } }));
+
+    auto model = new ClientAllocationModel(this);
+    model->setSourceModel(sourceModel);
+    model->setDynamicSortFilter(true);
+    ui->allocationView->setModel(model);
+    ui->allocationView->setItemDelegateForColumn(AllocationModel::HistoryColumn, new SparklineDelegate(this));
+
+    ui->allocationView->header()->setObjectName("allocationViewHeader");
+    ui->allocationView->setDeferredResizeMode(AllocationModel::ClassColumn, QHeaderView::Stretch);
+    for (int column = AllocationModel::CreatedColumn; column < AllocationModel::HistoryColumn; ++column)
+        ui->allocationView->setDeferredResizeMode(column, QHeaderView::ResizeToContents);
+    ui->allocationView->setDeferredResizeMode(AllocationModel::HistoryColumn, QHeaderView::Interactive);
+
+    new SearchLineController(ui->allocationSearchLine, model);
+
+    ui->hideIdleClasses->setChecked(model->hideIdleClasses());
+    connect(ui->hideIdleClasses, &QAbstractButton::toggled, model, &ClientAllocationModel::setHideIdleClasses);
+
+    // the classes with the most churn first
+    ui->allocationView->sortByColumn(AllocationModel::ChurnColumn, Qt::DescendingOrder);
+}
+
+AllocationProfilerWidget::~AllocationProfilerWidget() = default;
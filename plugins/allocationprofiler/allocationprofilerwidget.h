@@ -0,0 +1,50 @@
+/*
+  allocationprofilerwidget.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_ALLOCATIONPROFILERWIDGET_H
+#define GAMMARAY_ALLOCATIONPROFILERWIDGET_H
+
+#include <ui/tooluifactory.h>
+#include <ui/uistatemanager.h>
+
+#include <QWidget>
+
+#include <memory>
+
+namespace GammaRay {
+
+namespace Ui {
+class AllocationProfilerWidget;
+}
+
+class AllocationProfilerWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit AllocationProfilerWidget(QWidget *parent = nullptr);
+    ~AllocationProfilerWidget() override;
+
+private:
+    std::unique_ptr<Ui::AllocationProfilerWidget> ui;
+    UIStateManager m_stateManager;
+};
+
+class AllocationProfilerUiFactory : public QObject, public StandardToolUiFactory<AllocationProfilerWidget>
+{
+    Q_OBJECT
+    Q_INTERFACES(GammaRay::ToolUiFactory)
+    Q_PLUGIN_METADATA(IID "com.kdab.GammaRay.ToolUiFactory" FILE "gammaray_allocationprofiler.json")
+};
+
+}
+
+#endif // GAMMARAY_ALLOCATIONPROFILERWIDGET_H
@@ -0,0 +1,128 @@
+/*
+  clientallocationmodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "clientallocationmodel.h"
+
+#include "allocationmodel.h"
+
+#include <QStringList>
+
+using namespace GammaRay;
+
+ClientAllocationModel::ClientAllocationModel(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+ClientAllocationModel::~ClientAllocationModel() = default;
+
+bool ClientAllocationModel::hideIdleClasses() const
+{
+    return m_hideIdleClasses;
+}
+
+void ClientAllocationModel::setHideIdleClasses(bool hide)
+{
+    if (m_hideIdleClasses == hide)
+        return;
+    m_hideIdleClasses = hide;
+    invalidateRowsFilter();
+}
+
+QVariant ClientAllocationModel::data(const QModelIndex &index, int role) const
+{
+    if (hasIndex(index.row(), index.column())) {
+        if (role == Qt::DisplayRole) {
+            switch (index.column()) {
+            case AllocationModel::LifetimeColumn: {
+                const auto value = QSortFilterProxyModel::data(index, role);
+                if (value.typeId() != QMetaType::Double)
+                    break; // not loaded yet
+                return lifetimeToString(value.toDouble());
+            }
+            case AllocationModel::HistoryColumn:
+                return QVariant(); // painted by SparklineDelegate
+            }
+        } else if (role == Qt::ToolTipRole && index.column() == AllocationModel::LifetimeColumn) {
+            return lifetimeHistogramToString(QSortFilterProxyModel::data(index, AllocationModel::LifetimeHistogramRole).value<QVector<int>>());
+        } else if (role == Qt::TextAlignmentRole && index.column() != AllocationModel::ClassColumn) {
+            return QVariant::fromValue<int>(Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    return QSortFilterProxyModel::data(index, role);
+}
+
+QVariant ClientAllocationModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        switch (section) {
+        case AllocationModel::ClassColumn:
+            return tr("Class");
+        case AllocationModel::CreatedColumn:
+            return tr("Created/Sec");
+        case AllocationModel::DestroyedColumn:
+            return tr("Destroyed/Sec");
+        case AllocationModel::AliveColumn:
+            return tr("Alive");
+        case AllocationModel::ChurnColumn:
+            return tr("Churn");
+        case AllocationModel::LifetimeColumn:
+            return tr("Mean Lifetime");
+        case AllocationModel::HistoryColumn:
+            return tr("History");
+        }
+    } else if (orientation == Qt::Horizontal && role == Qt::ToolTipRole) {
+        switch (section) {
+        case AllocationModel::ChurnColumn:
+            return tr("Objects created and destroyed again within the history window.");
+        case AllocationModel::LifetimeColumn:
+            return tr("Mean lifetime of the objects counted as churn.");
+        case AllocationModel::HistoryColumn:
+            return tr("Creations (top) and destructions (bottom) per second within the history window.");
+        }
+    }
+    return QSortFilterProxyModel::headerData(section, orientation, role);
+}
+
+bool ClientAllocationModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_hideIdleClasses) {
+        const auto churn = sourceModel()->index(sourceRow, AllocationModel::ChurnColumn, sourceParent).data();
+        const auto created = sourceModel()->index(sourceRow, AllocationModel::CreatedColumn, sourceParent).data();
+        // rows are kept until loaded, we get dataChanged() for them once that happened
+        if (churn.typeId() == QMetaType::Int && churn.toInt() == 0 && created.toInt() == 0)
+            return false;
+    }
+    return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+}
+
+QString ClientAllocationModel::lifetimeToString(double msecs)
+{
+    if (msecs < 0)
+        return tr("N/A");
+    if (msecs < 1000)
+        return tr("%1 ms").arg(msecs, 0, 'f', 1);
+    return tr("%1 s").arg(msecs / 1000, 0, 'f', 1);
+}
+
+QString ClientAllocationModel::lifetimeHistogramToString(const QVector<int> &buckets)
+{
+    if (buckets.size() != AllocationModel::LifetimeBucketCount)
+        return QString();
+
+    const QStringList labels = { tr("< 1 ms"), tr("< 10 ms"), tr("< 100 ms"), tr("< 1 s"), tr("< 10 s"), tr(">= 10 s") };
+    QStringList lines;
+    for (int i = 0; i < buckets.size(); ++i)
+        lines.push_back(tr("%1: %2").arg(labels.at(i)).arg(buckets.at(i)));
+    return lines.join(QLatin1Char('\n'));
+}
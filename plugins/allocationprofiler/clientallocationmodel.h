@@ -0,0 +1,46 @@
+/*
+  clientallocationmodel.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_CLIENTALLOCATIONMODEL_H
+#define GAMMARAY_CLIENTALLOCATIONMODEL_H
+
+#include <QSortFilterProxyModel>
+
+namespace GammaRay {
+
+/** Client-side formatting of AllocationModel, optionally hiding classes without churn. */
+class ClientAllocationModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit ClientAllocationModel(QObject *parent = nullptr);
+    ~ClientAllocationModel() override;
+
+    bool hideIdleClasses() const;
+    void setHideIdleClasses(bool hide);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    static QString lifetimeToString(double msecs);
+    static QString lifetimeHistogramToString(const QVector<int> &buckets);
+
+    bool m_hideIdleClasses = true;
+};
+
+}
+
+#endif // GAMMARAY_CLIENTALLOCATIONMODEL_H
@@ -15,6 +15,7 @@
 #include "eventmodelroles.h"
 
 #include <core/probe.h>
+#include <core/probesettings.h>
 #include <core/util.h>
 #include <core/varianthandler.h>
 
@@ -27,25 +28,22 @@
 #include <QVariantMap>
 #include <QTimer>
 
+#include <algorithm>
+
 using namespace GammaRay;
 
-static const int TopLevelId = std::numeric_limits<int>::max();
+static const quintptr TopLevelId = std::numeric_limits<quintptr>::max();
 
 EventModel::EventModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_pendingEventTimer(new QTimer(this))
+    , m_maxEvents(std::max(1, ProbeSettings::value(QStringLiteral("EventMonitorHistorySize"), 50000).toInt()))
 {
     qRegisterMetaType<EventData>();
 
     m_pendingEventTimer->setSingleShot(true);
     m_pendingEventTimer->setInterval(200);
-    connect(m_pendingEventTimer, &QTimer::timeout, this, [this]() {
-        Q_ASSERT(!m_pendingEvents.isEmpty());
-        beginInsertRows(QModelIndex(), m_events.size(), m_events.size() + m_pendingEvents.size() - 1);
-        m_events += m_pendingEvents;
-        m_pendingEvents.clear();
-        endInsertRows();
-    });
+    connect(m_pendingEventTimer, &QTimer::timeout, this, &EventModel::insertPendingEvents);
 }
 
 EventModel::~EventModel() = default;
@@ -61,10 +59,35 @@ void EventModel::addEvent(const EventData &event)
 void EventModel::clear()
 {
     beginResetModel();
-    m_events = QVector<EventData>();
+    m_firstEventId += m_events.size();
+    m_events = std::deque<EventData>();
+    m_pendingEvents.clear();
+    m_pendingEventTimer->stop();
     endResetModel();
 }
 
+void EventModel::insertPendingEvents()
+{
+    Q_ASSERT(!m_pendingEvents.isEmpty());
+
+    // no point in inserting what would be removed right away again
+    if (m_pendingEvents.size() > m_maxEvents)
+        m_pendingEvents.erase(m_pendingEvents.begin(), m_pendingEvents.end() - m_maxEvents);
+
+    const int overflow = int(m_events.size()) + m_pendingEvents.size() - m_maxEvents;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_events.erase(m_events.begin(), m_events.begin() + overflow);
+        m_firstEventId += overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), int(m_events.size()), int(m_events.size()) + m_pendingEvents.size() - 1);
+    m_events.insert(m_events.end(), m_pendingEvents.cbegin(), m_pendingEvents.cend());
+    m_pendingEvents.clear();
+    endInsertRows();
+}
+
 int EventModel::columnCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
@@ -74,10 +97,10 @@ int EventModel::columnCount(const QModelIndex &parent) const
 int EventModel::rowCount(const QModelIndex &parent) const
 {
     if (!parent.isValid())
-        return m_events.size();
+        return int(m_events.size());
 
     if (parent.internalId() == TopLevelId && parent.column() == 0) {
-        const EventData &event = m_events.at(parent.row());
+        const EventData &event = m_events[parent.row()];
         return event.propagatedEvents.size();
     }
 
@@ -91,11 +114,11 @@ QVariant EventModel::data(const QModelIndex &index, int role) const
 
     bool isPropagatedEvent = index.internalId() != TopLevelId;
 
-    int rootEventIndex = isPropagatedEvent ? int(index.internalId()) : index.row();
-    Q_ASSERT(rootEventIndex >= 0 && rootEventIndex < m_events.size());
+    const int rootEventIndex = isPropagatedEvent ? int(index.internalId() - m_firstEventId) : index.row();
+    Q_ASSERT(rootEventIndex >= 0 && rootEventIndex < int(m_events.size()));
     const EventData &event = isPropagatedEvent
-        ? m_events.at(rootEventIndex).propagatedEvents.at(index.row())
-        : m_events.at(rootEventIndex);
+        ? m_events[rootEventIndex].propagatedEvents.at(index.row())
+        : m_events[rootEventIndex];
 
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
@@ -118,9 +141,17 @@ QVariant EventModel::data(const QModelIndex &index, int role) const
         }
     } else if (role == EventModelRole::AttributesRole) {
         QVariantMap attributesMap;
+        attributesMap.insert(QStringLiteral("receiver"), QVariant::fromValue(event.receiver));
+        if (!event.thread.isEmpty())
+            attributesMap.insert(QStringLiteral("[thread]"), event.thread);
         for (const QPair<const char *, QVariant> &pair : event.attributes) {
             attributesMap.insert(QString::fromUtf8(pair.first), pair.second);
         }
+        if (!attributesMap.contains(QStringLiteral("[receiver type]"))) {
+            QMutexLocker lock(Probe::objectLock());
+            if (Probe::instance()->isValidObject(event.receiver))
+                attributesMap.insert(QStringLiteral("[receiver type]"), QString::fromUtf8(event.receiver->metaObject()->className()));
+        }
         return attributesMap;
     } else if (role == EventModelRole::ReceiverIdRole && index.column() == EventModelColumn::Receiver) {
         return QVariant::fromValue(ObjectId(event.receiver));
@@ -153,9 +184,9 @@ QModelIndex EventModel::index(int row, int column, const QModelIndex &parent) co
         return {};
 
     if (parent.isValid()) {
-        if (row >= m_events.at(parent.row()).propagatedEvents.size())
+        if (row >= m_events[parent.row()].propagatedEvents.size())
             return QModelIndex();
-        return createIndex(row, column, static_cast<quintptr>(parent.row()));
+        return createIndex(row, column, m_firstEventId + parent.row());
     }
     return createIndex(row, column, TopLevelId);
 }
@@ -164,7 +195,7 @@ QModelIndex EventModel::parent(const QModelIndex &child) const
 {
     if (!child.isValid() || child.internalId() == TopLevelId)
         return {};
-    return createIndex(int(child.internalId()), 0, TopLevelId);
+    return createIndex(int(child.internalId() - m_firstEventId), 0, TopLevelId);
 }
 
 QMap<int, QVariant> EventModel::itemData(const QModelIndex &index) const
@@ -186,5 +217,5 @@ EventData &EventModel::lastEvent()
     if (!m_pendingEvents.empty()) {
         return m_pendingEvents.last();
     }
-    return m_events.last();
+    return m_events.back();
 }
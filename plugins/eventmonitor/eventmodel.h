@@ -19,6 +19,9 @@
 #include <QEvent>
 #include <QVariant>
 #include <QPair>
+#include <QString>
+
+#include <deque>
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -30,9 +33,12 @@ struct EventData
     QTime time;
     QEvent::Type type;
     QObject *receiver;
+    /// captured when the event was delivered, the receiver and anything else still available
+    /// later on is added only when the attributes are requested
     QVector<QPair<const char *, QVariant>> attributes;
     QEvent *eventPtr;
     QVector<EventData> propagatedEvents;
+    QString thread; ///< only set for events recorded as compact records
 };
 }
 
@@ -42,6 +48,9 @@ Q_DECLARE_TYPEINFO(GammaRay::EventData, Q_MOVABLE_TYPE);
 QT_END_NAMESPACE
 
 namespace GammaRay {
+/** Recorded events, bounded to the last @c EventMonitorHistorySize events (probe setting,
+ *  50000 by default). Older events are removed as new ones arrive.
+ */
 class EventModel : public QAbstractItemModel
 {
     Q_OBJECT
@@ -68,9 +77,14 @@ public slots:
     void clear();
 
 private:
-    QVector<EventData> m_events;
+    void insertPendingEvents();
+
+    std::deque<EventData> m_events;
     QVector<EventData> m_pendingEvents;
     QTimer *m_pendingEventTimer;
+    int m_maxEvents;
+    quintptr m_firstEventId = 0; // stable id of m_events.front(), used as internal id of propagated events
+
 };
 }
 
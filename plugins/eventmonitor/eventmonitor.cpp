@@ -23,19 +23,31 @@
 #include <core/metaobject.h>
 #include <core/metaobjectrepository.h>
 #include <core/objectinstance.h>
+#include <core/probesettings.h>
 #include <core/remote/serverproxymodel.h>
 #include <core/util.h>
 
 #include <common/objectbroker.h>
 #include <common/objectmodel.h>
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QItemSelectionModel>
 #include <QMetaMethod>
 #include <QMutex>
 #include <QSortFilterProxyModel>
+#include <QThread>
+#include <QThreadStorage>
+#include <QTimer>
 #include <QtCore/private/qobject_p.h>
 #include <QtGui/qtgui-config.h>
 
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <numeric>
+#include <vector>
+
 using namespace GammaRay;
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 11, 0)
@@ -49,6 +61,75 @@ static EventModel *s_model = nullptr;
 static EventTypeModel *s_eventTypeModel = nullptr;
 static EventMonitor *s_eventMonitor = nullptr;
 
+namespace {
+// fixed-size, recording one does not allocate
+struct EventRecord
+{
+    qint64 time; // ms since s_clock was started
+    QObject *receiver;
+    QEvent::Type type;
+};
+
+// single producer (the recording thread), single consumer (the probe thread)
+struct RecordBuffer
+{
+    static constexpr quint32 Capacity = 4096;
+
+    explicit RecordBuffer(const QString &thread)
+        : thread(thread)
+    {
+    }
+
+    std::array<EventRecord, Capacity> records;
+    QAtomicInteger<quint32> head = 0; // written by the producer only
+    QAtomicInteger<quint32> tail = 0; // written by the consumer only
+    const QString thread;
+};
+
+struct RecordRegistry
+{
+    QMutex mutex;
+    std::vector<std::shared_ptr<RecordBuffer>> buffers;
+};
+}
+
+Q_GLOBAL_STATIC(RecordRegistry, s_recordRegistry)
+
+static QThreadStorage<std::shared_ptr<RecordBuffer>> s_localRecordBuffer;
+static QElapsedTimer s_clock;
+static QTime s_clockStartTime;
+static bool s_compactCapture = false;
+
+static RecordBuffer *localRecordBuffer()
+{
+    if (s_localRecordBuffer.hasLocalData())
+        return s_localRecordBuffer.localData().get();
+
+    if (s_recordRegistry.isDestroyed())
+        return nullptr;
+
+    auto buffer = std::make_shared<RecordBuffer>(Util::displayString(QThread::currentThread()));
+    {
+        QMutexLocker lock(&s_recordRegistry()->mutex);
+        s_recordRegistry()->buffers.push_back(buffer);
+    }
+    s_localRecordBuffer.setLocalData(buffer);
+    return buffer.get();
+}
+
+static void recordCompactEvent(QObject *receiver, QEvent *event)
+{
+    auto buffer = localRecordBuffer();
+    if (!buffer)
+        return;
+
+    const auto head = buffer->head.loadRelaxed();
+    if (head - buffer->tail.loadAcquire() >= RecordBuffer::Capacity)
+        return; // full, the probe thread is not keeping up
+    buffer->records[head % RecordBuffer::Capacity] = { s_clock.elapsed(), receiver, event->type() };
+    buffer->head.storeRelease(head + 1);
+}
+
 static QString eventTypeToClassName(QEvent::Type type)
 {
     switch (type) {
@@ -218,7 +299,6 @@ static EventData createEventData(QObject *receiver, QEvent *event)
     eventData.time = QTime::currentTime();
     eventData.type = event->type();
     eventData.receiver = receiver;
-    eventData.attributes << QPair<const char *, QVariant> { "receiver", QVariant::fromValue(receiver) };
     eventData.eventPtr = event;
 
     // the receiver of a deferred delete event is almost always invalid when shown in the UI
@@ -305,6 +385,11 @@ static bool eventCallback(void **data)
     if (!shouldBeRecorded(receiver, event))
         return false;
 
+    if (s_compactCapture) {
+        recordCompactEvent(receiver, event);
+        return false;
+    }
+
     EventData eventData = createEventData(receiver, event);
 
     if (!event->spontaneous()
@@ -330,7 +415,7 @@ EventPropagationListener::EventPropagationListener(QObject *parent)
 
 bool EventPropagationListener::eventFilter(QObject *receiver, QEvent *event)
 {
-    if (!s_model)
+    if (!s_model || s_compactCapture)
         return false;
 
     if (!s_model->hasEvents())
@@ -371,6 +456,7 @@ EventMonitor::EventMonitor(Probe *probe, QObject *parent)
     , m_eventModel(new EventModel(this))
     , m_eventTypeModel(new EventTypeModel(this))
     , m_eventPropertyModel(new AggregatedPropertyModel(this))
+    , m_collectTimer(new QTimer(this))
 {
     Q_ASSERT(s_model == nullptr);
     s_model = m_eventModel;
@@ -381,6 +467,11 @@ EventMonitor::EventMonitor(Probe *probe, QObject *parent)
     Q_ASSERT(s_eventMonitor == nullptr);
     s_eventMonitor = this;
 
+    s_compactCapture = ProbeSettings::value(QStringLiteral("EventMonitorCompactCapture"), false).toBool();
+    s_clockStartTime = QTime::currentTime();
+    s_clock.start();
+    discardRecords(); // left over from a previous instance, timed against the old clock
+
     QInternal::registerCallback(QInternal::EventNotifyCallback, eventCallback);
     QCoreApplication::instance()->installEventFilter(new EventPropagationListener(this));
 
@@ -399,6 +490,73 @@ EventMonitor::EventMonitor(Probe *probe, QObject *parent)
     QItemSelectionModel *selectionModel = ObjectBroker::selectionModel(filterProxy);
     connect(selectionModel, &QItemSelectionModel::selectionChanged,
             this, &EventMonitor::eventSelected);
+
+    m_collectTimer->setInterval(200);
+    connect(m_collectTimer, &QTimer::timeout, this, &EventMonitor::collectRecords);
+    if (s_compactCapture)
+        m_collectTimer->start();
+}
+
+void EventMonitor::collectRecords()
+{
+    // only collect up to the current time, so all threads are cut off at the same point and
+    // what is collected next time can be appended without breaking the time order
+    const auto cutoff = s_clock.elapsed();
+
+    std::vector<EventRecord> records;
+    std::vector<QString> threads;
+    if (!s_recordRegistry.isDestroyed()) {
+        QMutexLocker lock(&s_recordRegistry()->mutex);
+        auto &buffers = s_recordRegistry()->buffers;
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            auto &buffer = **it;
+            const auto head = buffer.head.loadAcquire();
+            auto i = buffer.tail.loadRelaxed();
+            for (; i != head; ++i) {
+                auto record = buffer.records[i % RecordBuffer::Capacity];
+                if (record.time >= cutoff)
+                    break; // records are in time order per thread
+                // stamped before the last cutoff but published after it, rare enough to just move it forward
+                record.time = std::max(record.time, m_collectedUntil);
+                records.push_back(record);
+                threads.push_back(buffer.thread);
+            }
+            buffer.tail.storeRelease(i);
+
+            // the recording thread is gone and everything has been collected
+            if (it->use_count() == 1 && i == head)
+                it = buffers.erase(it);
+            else
+                ++it;
+        }
+    }
+    m_collectedUntil = cutoff;
+
+    // adding events emits signals, which must not end up in localRecordBuffer() while we hold the lock
+    std::vector<size_t> order(records.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&records](size_t lhs, size_t rhs) {
+        return records[lhs].time < records[rhs].time;
+    });
+    for (const auto i : order) {
+        const auto &record = records[i];
+        EventData event;
+        event.time = s_clockStartTime.addMSecs(record.time);
+        event.type = record.type;
+        event.receiver = record.receiver;
+        event.eventPtr = nullptr;
+        event.thread = threads[i];
+        addEvent(event);
+    }
+}
+
+void EventMonitor::discardRecords()
+{
+    if (s_recordRegistry.isDestroyed())
+        return;
+    QMutexLocker lock(&s_recordRegistry()->mutex);
+    for (const auto &buffer : s_recordRegistry()->buffers)
+        buffer->tail.storeRelease(buffer->head.loadAcquire());
 }
 
 void EventMonitor::eventSelected(const QItemSelection &selection)
@@ -421,6 +579,7 @@ EventMonitor::~EventMonitor()
 
 void EventMonitor::clearHistory()
 {
+    discardRecords();
     m_eventModel->clear();
     m_eventTypeModel->resetCounts();
 }
@@ -21,6 +21,7 @@
 
 QT_BEGIN_NAMESPACE
 class QItemSelection;
+class QTimer;
 QT_END_NAMESPACE
 
 
@@ -42,6 +43,14 @@ public:
 };
 
 
+/** Event monitor tool.
+ *
+ *  Events are recorded with all their attributes. If the @c EventMonitorCompactCapture probe
+ *  setting is enabled, events are only recorded as compact records (type, receiver, time and
+ *  thread) into a lock-free per-thread ring buffer instead, which is collected periodically
+ *  in time order. Attributes that remain available after delivery are added to those when
+ *  the event is inspected. Events are dropped while a thread's ring buffer is full.
+ */
 class EventMonitor : public EventMonitorInterface
 {
     Q_OBJECT
@@ -63,11 +72,16 @@ public slots:
 
 private slots:
     void eventSelected(const QItemSelection &selection);
+    void collectRecords();
 
 private:
+    static void discardRecords();
+
     EventModel *m_eventModel;
     EventTypeModel *m_eventTypeModel;
     AggregatedPropertyModel *m_eventPropertyModel;
+    QTimer *m_collectTimer;
+    qint64 m_collectedUntil = 0; // compact records before this time have been collected
 };
 
 
@@ -15,6 +15,7 @@
 #include "ui_modelinspectorwidget.h"
 #include "modelinspectorclient.h"
 #include "modelcontentdelegate.h"
+#include "modelcontentproxymodel.h"
 
 #include <ui/contextmenuextension.h>
 #include <ui/itemdelegate.h>
@@ -59,6 +60,8 @@ ModelInspectorWidget::ModelInspectorWidget(QWidget *parent)
     ui->selectionModelsView->setSelectionModel(ObjectBroker::selectionModel(selectionModels));
 
     auto contentModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ModelContent"));
+    // only fetch what the view and ModelContentDelegate use, the cell view has its own model for the rest
+    contentModel->setProperty("requestedRoles", QVariant::fromValue(QVector<QVector<int>> { { Qt::DisplayRole, Qt::DecorationRole, Qt::ToolTipRole, Qt::FontRole, Qt::TextAlignmentRole, Qt::BackgroundRole, Qt::ForegroundRole, Qt::CheckStateRole, Qt::SizeHintRole, ModelContentProxyModel::DisabledRole, ModelContentProxyModel::SelectedRole, ModelContentProxyModel::IsDisplayStringEmptyRole } }));
     ui->modelContentView->setModel(contentModel);
     ui->modelContentView->setSelectionModel(ObjectBroker::selectionModel(contentModel));
     ui->modelContentView->header()->setObjectName("modelContentViewHeader");
@@ -717,6 +717,9 @@ void QuickInspector::itemSelectionChanged(const QItemSelection &selection)
     m_currentItem = index.data(ObjectModel::ObjectRole).value<QQuickItem *>();
     m_itemPropertyController->setObject(m_currentItem);
 
+    // the item might be new, or its node replaced, since the last scene graph model update
+    m_sgModel->updatePendingChanges();
+
     // It might be that a sg-node is already selected that belongs to this item, but isn't the root
     // node of the Item. In this case we don't want to overwrite that selection.
     if (m_sgModel->itemForSgNode(m_currentSgNode) != m_currentItem) {
@@ -14,10 +14,15 @@
 #include "quickscenegraphmodel.h"
 
 #include <private/qquickitem_p.h>
+#include <private/qquickwindow_p.h>
 #include "quickitemmodelroles.h"
 
+#include <core/probesettings.h>
+
 #include <QQuickWindow>
+#include <QSet>
 #include <QThread>
+#include <QTimer>
 #include <QSGNode>
 
 #include <algorithm>
@@ -26,6 +31,9 @@ Q_DECLARE_METATYPE(QSGNode *)
 
 using namespace GammaRay;
 
+// beyond that many dirty items between two updates, walking the whole tree is cheaper
+static const int MaxDirtyItems = 4096;
+
 template<typename Container, typename Value>
 static bool contains(const Container &c, const Value &v)
 {
@@ -35,7 +43,11 @@ static bool contains(const Container &c, const Value &v)
 QuickSceneGraphModel::QuickSceneGraphModel(QObject *parent)
     : ObjectModelBase<QAbstractItemModel>(parent)
     , m_rootNode(nullptr)
+    , m_updateTimer(new QTimer(this))
 {
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(ProbeSettings::value(QStringLiteral("QuickSceneGraphModelUpdateInterval"), 100).toInt());
+    connect(m_updateTimer, &QTimer::timeout, this, &QuickSceneGraphModel::processDirtyItems);
 }
 
 QuickSceneGraphModel::~QuickSceneGraphModel() = default;
@@ -45,12 +57,14 @@ void QuickSceneGraphModel::setWindow(QQuickWindow *window)
     beginResetModel();
     clear();
     if (m_window)
-        disconnect(m_window.data(), &QQuickWindow::afterRendering, this, nullptr);
+        disconnect(m_window.data(), &QQuickWindow::beforeSynchronizing, this, nullptr);
     m_window = window;
     m_rootNode = currentRootNode();
     if (m_window && m_rootNode) {
         updateSGTree(false);
-        connect(m_window.data(), &QQuickWindow::afterRendering, this, [this] { updateSGTree(); });
+        // the GUI thread is blocked meanwhile, so the dirty state of the items is safe to read
+        connect(
+            m_window.data(), &QQuickWindow::beforeSynchronizing, this, [this, window] { collectDirtyItems(window); }, Qt::DirectConnection);
     }
 
     endResetModel();
@@ -171,6 +185,109 @@ void QuickSceneGraphModel::clear()
 {
     m_childParentMap.clear();
     m_parentChildMap.clear();
+    m_itemItemNodeMap.clear();
+    m_itemNodeItemMap.clear();
+
+    QMutexLocker lock(&m_dirtyItemsMutex);
+    m_dirtyItems.clear();
+    m_fullUpdatePending = false;
+}
+
+void QuickSceneGraphModel::collectDirtyItems(QQuickWindow *window)
+{
+    // changes that can add, remove or replace nodes, rather than just changing their state
+    static const quint32 structuralChanges = QQuickItemPrivate::Content
+        | QQuickItemPrivate::OpacityValue
+        | QQuickItemPrivate::ChildrenChanged
+        | QQuickItemPrivate::ChildrenStackingChanged
+        | QQuickItemPrivate::ParentChanged
+        | QQuickItemPrivate::Clip
+        | QQuickItemPrivate::Window
+        | QQuickItemPrivate::EffectReference
+        | QQuickItemPrivate::Visible
+        | QQuickItemPrivate::HideReference;
+
+    QMutexLocker lock(&m_dirtyItemsMutex);
+    bool changed = false;
+    for (auto item = QQuickWindowPrivate::get(window)->dirtyItemList; item && !m_fullUpdatePending;
+         item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if ((QQuickItemPrivate::get(item)->dirtyAttributes & structuralChanges) == 0)
+            continue;
+        changed = true;
+        if (m_dirtyItems.size() >= MaxDirtyItems) {
+            m_dirtyItems.clear();
+            m_fullUpdatePending = true;
+        } else {
+            m_dirtyItems.push_back(item);
+        }
+    }
+
+    if (changed && !m_updateScheduled) {
+        m_updateScheduled = true;
+        QMetaObject::invokeMethod(
+            this, [this] {
+                if (!m_updateTimer->isActive())
+                    m_updateTimer->start();
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+void QuickSceneGraphModel::processDirtyItems()
+{
+    QVector<QPointer<QQuickItem>> dirtyItems;
+    bool fullUpdate = false;
+    {
+        QMutexLocker lock(&m_dirtyItemsMutex);
+        dirtyItems.swap(m_dirtyItems);
+        std::swap(fullUpdate, m_fullUpdatePending);
+        m_updateScheduled = false;
+    }
+
+    if (!m_window)
+        return;
+    if (fullUpdate || currentRootNode() != m_rootNode) {
+        updateSGTree();
+        return;
+    }
+
+    QSet<QQuickItem *> seenItems;
+    QVector<QQuickItem *> unknownItems;
+    for (const auto &item : std::as_const(dirtyItems)) {
+        // deleted items are covered by the dirty state of their parent
+        if (!item || item->window() != m_window || seenItems.contains(item))
+            continue;
+        seenItems.insert(item);
+
+        updateItemNodes(item);
+        auto node = QQuickItemPrivate::get(item)->itemNodeInstance;
+        if (!node)
+            continue;
+        if (contains(m_childParentMap, node))
+            populateFromNode(node, true, true);
+        else
+            unknownItems.push_back(item);
+    }
+
+    // nodes of new items are usually added along with the subtree of a dirty ancestor,
+    // anything still unknown after that needs a full update to be found
+    for (auto item : std::as_const(unknownItems)) {
+        if (!contains(m_childParentMap, QQuickItemPrivate::get(item)->itemNodeInstance)) {
+            updateSGTree();
+            return;
+        }
+    }
+}
+
+void QuickSceneGraphModel::updatePendingChanges()
+{
+    {
+        QMutexLocker lock(&m_dirtyItemsMutex);
+        if (!m_updateScheduled)
+            return;
+    }
+    m_updateTimer->stop();
+    processDirtyItems();
 }
 
 // indexForNode() is expensive, so only use it when really needed
@@ -180,7 +297,7 @@ void QuickSceneGraphModel::clear()
         hasMyIndex = true;            \
     }
 
-void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
+void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals, bool incremental)
 {
     if (!node)
         return;
@@ -251,7 +368,7 @@ void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
                     endInsertRows();
                 }
 #endif
-                populateFromNode(*j, emitSignals);
+                populateFromNode(*j, emitSignals, incremental);
             } else { // entirely new
                 if (emitSignals)
                     beginInsertRows(myIndex, idx, idx);
@@ -264,7 +381,9 @@ void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
             ++i;
             ++j;
         } else { // already known node, no change
-            populateFromNode(*j, emitSignals);
+            // when updating incrementally, the subtrees of other items are covered by their own dirty state
+            if (!incremental || !contains(m_itemNodeItemMap, *j))
+                populateFromNode(*j, emitSignals, incremental);
             ++i;
             ++j;
         }
@@ -334,7 +453,7 @@ void QuickSceneGraphModel::populateFromNode(QSGNode *node, bool emitSignals)
                     endInsertRows();
                 }
 #endif
-                populateFromNode(*j, emitSignals);
+                populateFromNode(*j, emitSignals, incremental);
                 ++j;
             }
         }
@@ -377,6 +496,24 @@ void QuickSceneGraphModel::collectItemNodes(QQuickItem *item)
         collectItemNodes(child);
 }
 
+void QuickSceneGraphModel::updateItemNodes(QQuickItem *item)
+{
+    // like collectItemNodes(), but only descending into items we don't know yet
+    QQuickItemPrivate *priv = QQuickItemPrivate::get(item);
+    if (!priv->itemNodeInstance)
+        return;
+
+    QSGNode *itemNode = priv->itemNodeInstance;
+    m_itemItemNodeMap[item] = itemNode;
+    m_itemNodeItemMap[itemNode] = item;
+
+    const auto childItems = item->childItems();
+    for (QQuickItem *child : childItems) {
+        if (!contains(m_itemItemNodeMap, child))
+            collectItemNodes(child);
+    }
+}
+
 QModelIndex QuickSceneGraphModel::indexForNode(QSGNode *node) const
 {
     if (!node)
@@ -467,4 +604,12 @@ void QuickSceneGraphModel::pruneSubTree(QSGNode *node)
         m_parentChildMap.erase(node);
     }
     m_childParentMap.erase(node);
+
+    auto itemIt = m_itemNodeItemMap.find(node);
+    if (itemIt != m_itemNodeItemMap.end()) {
+        auto nodeIt = m_itemItemNodeMap.find(itemIt->second);
+        if (nodeIt != m_itemItemNodeMap.end() && nodeIt->second == node)
+            m_itemItemNodeMap.erase(nodeIt);
+        m_itemNodeItemMap.erase(itemIt);
+    }
 }
@@ -19,6 +19,7 @@
 #include "core/objectmodelbase.h"
 
 #include <QHash>
+#include <QMutex>
 #include <QPointer>
 #include <QVector>
 #include <unordered_map>
@@ -27,10 +28,18 @@ QT_BEGIN_NAMESPACE
 class QSGNode;
 class QQuickItem;
 class QQuickWindow;
+class QTimer;
 QT_END_NAMESPACE
 
 namespace GammaRay {
-/** QQ2 scene graph model. */
+/** QQ2 scene graph model.
+ *
+ *  Items with structural changes are picked up from the window's dirty item list while the
+ *  scene graph is synchronized, and only the node subtrees of those items are diffed
+ *  afterwards, at most every @c QuickSceneGraphModelUpdateInterval milliseconds (probe
+ *  setting, 100 by default). The whole tree is only walked again when the root node changes,
+ *  or when the changes cannot be attributed to known subtrees.
+ */
 class QuickSceneGraphModel : public ObjectModelBase<QAbstractItemModel>
 {
     Q_OBJECT
@@ -48,6 +57,8 @@ public:
     QSGNode *sgNodeForItem(QQuickItem *item) const;
     QQuickItem *itemForSgNode(QSGNode *node) const;
     bool verifyNodeValidity(QSGNode *node);
+    /** Applies pending scene graph changes right away, instead of waiting for the next update. */
+    void updatePendingChanges();
 
 signals:
     void nodeDeleted(QSGNode *node);
@@ -58,8 +69,11 @@ private slots:
 private:
     void clear();
     QSGNode *currentRootNode() const;
-    void populateFromNode(QSGNode *node, bool emitSignals);
+    void populateFromNode(QSGNode *node, bool emitSignals, bool incremental = false);
     void collectItemNodes(QQuickItem *item);
+    void updateItemNodes(QQuickItem *item);
+    void collectDirtyItems(QQuickWindow *window);
+    void processDirtyItems();
     bool recursivelyFindChild(QSGNode *root, QSGNode *child) const;
     void pruneSubTree(QSGNode *node);
 
@@ -70,6 +84,13 @@ private:
     std::unordered_map<QSGNode *, QVector<QSGNode *>> m_parentChildMap;
     std::unordered_map<QQuickItem *, QSGNode *> m_itemItemNodeMap;
     std::unordered_map<QSGNode *, QQuickItem *> m_itemNodeItemMap;
+
+    // written in the render thread while synchronizing, consumed in our thread
+    QMutex m_dirtyItemsMutex;
+    QVector<QPointer<QQuickItem>> m_dirtyItems;
+    bool m_fullUpdatePending = false;
+    bool m_updateScheduled = false;
+    QTimer *m_updateTimer;
 };
 }
 
@@ -16,12 +16,14 @@
 #include "core/varianthandler.h"
 
 #include <core/objectdataprovider.h>
+#include <core/probesettings.h>
 
 #include <QDebug>
 #include <QEvent>
 #include <QPainter>
 #include <QQuickWindow>
 #include <QQuickRenderControl>
+#include <QRunnable>
 
 #ifndef QT_NO_OPENGL
 #include <QOpenGLContext>
@@ -35,11 +37,18 @@
 
 #include <private/qsgsoftwarerenderer_p.h>
 
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+#include <rhi/qrhi.h>
+#else
+#include <private/qrhi_p.h>
+#endif
+
 #include <QQuickOpenGLUtils>
 
 #include <algorithm>
 #include <functional>
 #include <cmath>
+#include <cstring>
 
 namespace GammaRay {
 
@@ -224,10 +233,17 @@ bool ItemOrLayoutFacade::isLayout() const
 std::unique_ptr<AbstractScreenGrabber> AbstractScreenGrabber::get(QQuickWindow *window)
 {
     switch (graphicsApiFor(window)) {
-#ifndef QT_NO_OPENGL
     case RenderInfo::OpenGL:
-        return std::unique_ptr<AbstractScreenGrabber>(new OpenGLScreenGrabber(window));
+#ifndef QT_NO_OPENGL
+        // the generic RHI readback can be forced for OpenGL as well, mainly for testing it
+        if (!ProbeSettings::value(QStringLiteral("QuickInspectorRhiReadback"), false).toBool())
+            return std::unique_ptr<AbstractScreenGrabber>(new OpenGLScreenGrabber(window));
 #endif
+        return std::unique_ptr<AbstractScreenGrabber>(new RhiScreenGrabber(window));
+    case RenderInfo::Direct3D11:
+    case RenderInfo::Vulkan:
+    case RenderInfo::Metal:
+        return std::unique_ptr<AbstractScreenGrabber>(new RhiScreenGrabber(window));
     case RenderInfo::Software:
         return std::unique_ptr<AbstractScreenGrabber>(new SoftwareScreenGrabber(window));
     default:
@@ -583,9 +599,39 @@ OpenGLScreenGrabber::OpenGLScreenGrabber(QQuickWindow *window)
             this, &OpenGLScreenGrabber::windowAfterSynchronizing, Qt::DirectConnection);
     connect(m_window.data(), &QQuickWindow::afterRendering,
             this, &OpenGLScreenGrabber::windowAfterRendering, Qt::DirectConnection);
+    connect(m_window.data(), &QQuickWindow::sceneGraphInvalidated,
+            this, &OpenGLScreenGrabber::sceneGraphInvalidated, Qt::DirectConnection);
 }
 
-OpenGLScreenGrabber::~OpenGLScreenGrabber() = default;
+OpenGLScreenGrabber::~OpenGLScreenGrabber()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_window)
+        return;
+
+    // GL resources can only be released in the render thread
+    QVector<GLuint> buffers;
+    QVector<GLsync> fences;
+    for (const auto &pixelBuffer : m_pixelBuffers) {
+        if (pixelBuffer.buffer)
+            buffers.push_back(pixelBuffer.buffer);
+        if (pixelBuffer.fence)
+            fences.push_back(pixelBuffer.fence);
+    }
+    if (buffers.isEmpty())
+        return;
+
+    m_window->scheduleRenderJob(QRunnable::create([buffers, fences] {
+                                    auto context = QOpenGLContext::currentContext();
+                                    if (!context)
+                                        return;
+                                    auto glFuncs = context->extraFunctions();
+                                    for (auto fence : fences)
+                                        glFuncs->glDeleteSync(fence);
+                                    glFuncs->glDeleteBuffers(buffers.size(), buffers.constData());
+                                }),
+                                QQuickWindow::NoStage);
+}
 
 void OpenGLScreenGrabber::requestGrabWindow(const QRectF &userViewport)
 {
@@ -623,7 +669,12 @@ void OpenGLScreenGrabber::windowAfterRendering()
     // And the gui thread is NOT locked
     Q_ASSERT(QOpenGLContext::currentContext() == m_window->rendererInterface()->getResource(m_window, QSGRendererInterface::OpenGLContextResource));
 
-    if (m_isGrabbing) {
+    const bool readbackFrame = m_readbackFrameRequested;
+    m_readbackFrameRequested = false;
+    const bool contentGrabbed = m_isGrabbing && !m_readbackStarted;
+    bool grabFinished = false;
+
+    if (contentGrabbed) {
         const auto window = QRectF(QPoint(0, 0), m_renderInfo.windowSize);
         const auto intersect = m_userViewport.isValid() ? window.intersected(m_userViewport) : window;
 
@@ -681,35 +732,144 @@ void OpenGLScreenGrabber::windowAfterRendering()
             h = viewport[3] - y;
 
         m_grabbedFrame.transform.reset();
-
-        if (m_grabbedFrame.image.size() != QSize(w, h))
-            m_grabbedFrame.image = QImage(w, h, QImage::Format_RGBA8888);
-
-        glFuncs->glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, m_grabbedFrame.image.bits());
-
         // set transform to flip the read texture later, when displayed
         // Keep in mind that transforms are local coordinate (ie, not impacted by the device pixel ratio)
         m_grabbedFrame.transform.scale(1.0, -1.0);
         m_grabbedFrame.transform.translate(intersect.x(), -intersect.y() - intersect.height());
-        m_grabbedFrame.image.setDevicePixelRatio(m_renderInfo.dpr);
 
-        // Let emit the signal even if our image is possibly null, this way we make perfect ping/pong
-        // requests making it easier to unit test.
-        emit sceneGrabbed(m_grabbedFrame);
+        if (asyncReadbackSupported()) {
+            startReadback(x, y, w, h);
+        } else {
+            if (m_grabbedFrame.image.size() != QSize(w, h))
+                m_grabbedFrame.image = QImage(w, h, QImage::Format_RGBA8888);
+
+            glFuncs->glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, m_grabbedFrame.image.bits());
+            m_grabbedFrame.image.setDevicePixelRatio(m_renderInfo.dpr);
+
+            // Let emit the signal even if our image is possibly null, this way we make perfect ping/pong
+            // requests making it easier to unit test.
+            emit sceneGrabbed(m_grabbedFrame);
+            grabFinished = true;
+        }
+    } else if (m_isGrabbing) {
+        grabFinished = finishReadback();
     }
 
     drawDecorations();
 
     QQuickOpenGLUtils::resetOpenGLState();
 
-    if (m_isGrabbing) {
+    // a frame only rendered by us to pick up a pending readback isn't a scene change
+    if (!contentGrabbed && !readbackFrame)
+        emit sceneChanged();
+
+    if (grabFinished) {
+        m_readbackStarted = false;
         locker.unlock();
         setGrabbingMode(false, QRectF());
-    } else {
-        emit sceneChanged();
     }
 }
 
+void OpenGLScreenGrabber::sceneGraphInvalidated()
+{
+    // We are in the rendering thread at this point, with the context still current
+    QMutexLocker locker(&m_mutex);
+    auto glFuncs = QOpenGLContext::currentContext() ? QOpenGLContext::currentContext()->extraFunctions() : nullptr;
+    for (auto &pixelBuffer : m_pixelBuffers) {
+        if (glFuncs && pixelBuffer.fence)
+            glFuncs->glDeleteSync(pixelBuffer.fence);
+        if (glFuncs && pixelBuffer.buffer)
+            glFuncs->glDeleteBuffers(1, &pixelBuffer.buffer);
+        pixelBuffer = PixelBuffer();
+    }
+    // read back again from the next frame of the new context, if any
+    m_readbackStarted = false;
+}
+
+bool OpenGLScreenGrabber::asyncReadbackSupported() const
+{
+    static const bool enabled = ProbeSettings::value(QStringLiteral("QuickInspectorAsyncReadback"), true).toBool();
+    if (!enabled)
+        return false;
+    const auto format = QOpenGLContext::currentContext()->format();
+    const auto version = qMakePair(format.majorVersion(), format.minorVersion());
+    if (QOpenGLContext::currentContext()->isOpenGLES())
+        return version >= qMakePair(3, 0);
+    return version >= qMakePair(3, 2);
+}
+
+void OpenGLScreenGrabber::startReadback(int x, int y, int w, int h)
+{
+    auto glFuncs = QOpenGLContext::currentContext()->extraFunctions();
+
+    // alternate between buffers, so we never write into one the driver might still be reading from
+    m_currentPixelBuffer = (m_currentPixelBuffer + 1) % int(m_pixelBuffers.size());
+    auto &pixelBuffer = m_pixelBuffers[m_currentPixelBuffer];
+    if (!pixelBuffer.buffer)
+        glFuncs->glGenBuffers(1, &pixelBuffer.buffer);
+    glFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer.buffer);
+
+    const GLsizeiptr size = GLsizeiptr(std::max(w, 0)) * std::max(h, 0) * 4;
+    if (pixelBuffer.size != size) {
+        glFuncs->glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        pixelBuffer.size = size;
+    }
+    // with a pack buffer bound this only queues the copy, rather than waiting for it
+    glFuncs->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glFuncs->glReadPixels(x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (pixelBuffer.fence)
+        glFuncs->glDeleteSync(pixelBuffer.fence);
+    pixelBuffer.fence = glFuncs->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pixelBuffer.imageSize = QSize(w, h);
+    pixelBuffer.frame = m_grabbedFrame;
+    pixelBuffer.frame.image = QImage();
+    m_readbackStarted = true;
+
+    requestReadbackFrame();
+}
+
+bool OpenGLScreenGrabber::finishReadback()
+{
+    auto glFuncs = QOpenGLContext::currentContext()->extraFunctions();
+    auto &pixelBuffer = m_pixelBuffers[m_currentPixelBuffer];
+
+    if (pixelBuffer.fence) {
+        const auto status = glFuncs->glClientWaitSync(pixelBuffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            requestReadbackFrame();
+            return false;
+        }
+        glFuncs->glDeleteSync(pixelBuffer.fence);
+        pixelBuffer.fence = nullptr;
+    }
+
+    GrabbedFrame frame = pixelBuffer.frame;
+    if (pixelBuffer.size > 0) {
+        glFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer.buffer);
+        const auto data = glFuncs->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixelBuffer.size, GL_MAP_READ_BIT);
+        if (data) {
+            frame.image = QImage(pixelBuffer.imageSize, QImage::Format_RGBA8888);
+            memcpy(frame.image.bits(), data, pixelBuffer.size);
+            frame.image.setDevicePixelRatio(m_renderInfo.dpr);
+            glFuncs->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // like with the synchronous readback, emit even if the image is null
+    emit sceneGrabbed(frame);
+    return true;
+}
+
+void OpenGLScreenGrabber::requestReadbackFrame()
+{
+    // the readback is picked up on the next frame, which might not come on its own
+    m_readbackFrameRequested = true;
+    QMetaObject::invokeMethod(m_window.data(), &QQuickWindow::update, Qt::QueuedConnection);
+}
+
 void OpenGLScreenGrabber::drawDecorations()
 {
     // We are in the rendering thread at this point
@@ -721,6 +881,148 @@ void OpenGLScreenGrabber::drawDecorations()
 }
 #endif
 
+RhiScreenGrabber::RhiScreenGrabber(QQuickWindow *window)
+    : AbstractScreenGrabber(window)
+{
+    connect(m_window.data(), &QQuickWindow::afterSynchronizing,
+            this, &RhiScreenGrabber::windowAfterSynchronizing, Qt::DirectConnection);
+    connect(m_window.data(), &QQuickWindow::afterRendering,
+            this, &RhiScreenGrabber::windowAfterRendering, Qt::DirectConnection);
+}
+
+RhiScreenGrabber::~RhiScreenGrabber() = default;
+
+void RhiScreenGrabber::requestGrabWindow(const QRectF &userViewport)
+{
+    setGrabbingMode(true, userViewport);
+}
+
+void RhiScreenGrabber::drawDecorations()
+{
+    // drawing into the window would need its own render pass, the client draws them anyway
+}
+
+void RhiScreenGrabber::setGrabbingMode(bool isGrabbing, const QRectF &userViewport)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_isGrabbing == isGrabbing)
+        return;
+
+    m_isGrabbing = isGrabbing;
+    m_userViewport = userViewport;
+
+    emit grabberReadyChanged(!m_isGrabbing);
+
+    if (m_isGrabbing)
+        updateOverlay();
+}
+
+void RhiScreenGrabber::windowAfterSynchronizing()
+{
+    // We are in the rendering thread at this point
+    // And the gui thread is locked
+    gatherRenderInfo();
+}
+
+void RhiScreenGrabber::windowAfterRendering()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // We are in the rendering thread at this point, the main render pass of the frame is recorded
+    // And the gui thread is NOT locked
+    const bool readbackFrame = m_readbackFrameRequested;
+    m_readbackFrameRequested = false;
+    const bool contentGrabbed = m_isGrabbing && !m_readbackStarted;
+
+    if (!contentGrabbed) {
+        if (m_isGrabbing) {
+            // still waiting for the readback to complete, which needs further frames
+            m_readbackFrameRequested = true;
+            QMetaObject::invokeMethod(m_window.data(), &QQuickWindow::update, Qt::QueuedConnection);
+        }
+        // a frame only rendered by us to pick up a pending readback isn't a scene change
+        if (!readbackFrame)
+            emit sceneChanged();
+        return;
+    }
+
+    auto windowPriv = QQuickWindowPrivate::get(m_window);
+    if (!windowPriv->rhi || !windowPriv->swapchain) {
+        // render control based windows have no swap chain to read back from
+        locker.unlock();
+        emit sceneGrabbed(GrabbedFrame());
+        setGrabbingMode(false, QRectF());
+        return;
+    }
+
+    m_pendingFrame = m_grabbedFrame;
+    m_pendingFrame.image = QImage();
+    const auto window = QRectF(QPoint(0, 0), m_renderInfo.windowSize);
+    m_pendingViewport = m_userViewport.isValid() ? window.intersected(m_userViewport) : window;
+    m_readbackStarted = true;
+
+    // deleted once completed, which might happen after we are gone
+    auto result = new QRhiReadbackResult;
+    const bool yUp = windowPriv->rhi->isYUpInFramebuffer();
+    QPointer<RhiScreenGrabber> grabber(this);
+    result->completed = [grabber, result, yUp] {
+        if (grabber) {
+            const auto format = result->format == QRhiTexture::BGRA8 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGBA8888_Premultiplied;
+            const QImage image(reinterpret_cast<const uchar *>(result->data.constData()),
+                               result->pixelSize.width(), result->pixelSize.height(), format);
+            grabber->readbackCompleted(image, yUp);
+        }
+        delete result;
+    };
+
+    // a default description reads back the current back buffer, once the GPU is done with it
+    auto batch = windowPriv->rhi->nextResourceUpdateBatch();
+    batch->readBackTexture(QRhiReadbackDescription(), result);
+    windowPriv->swapchain->currentFrameCommandBuffer()->resourceUpdate(batch);
+
+    // completion is reported during one of the next frames, which might not come on their own
+    m_readbackFrameRequested = true;
+    QMetaObject::invokeMethod(m_window.data(), &QQuickWindow::update, Qt::QueuedConnection);
+}
+
+void RhiScreenGrabber::readbackCompleted(const QImage &image, bool yUp)
+{
+    // We are in the rendering thread at this point, within QRhi::beginFrame() or endFrame()
+    QMutexLocker locker(&m_mutex);
+    if (!m_readbackStarted)
+        return;
+    m_readbackStarted = false;
+
+    const auto &viewport = m_pendingViewport;
+    const auto dpr = m_renderInfo.dpr;
+    // when in doubt, round x and y to floor and w and h up --> reads one pixel more
+    const int x = static_cast<int>(std::floor(viewport.x() * dpr));
+    int y = static_cast<int>(std::floor(viewport.y() * dpr));
+    const int w = static_cast<int>(std::ceil(viewport.width() * dpr));
+    const int h = static_cast<int>(std::ceil(viewport.height() * dpr));
+
+    GrabbedFrame frame = m_pendingFrame;
+    frame.transform.reset();
+    if (yUp) {
+        // flip later, when displayed, like with the OpenGL readback
+        // Keep in mind that transforms are local coordinate (ie, not impacted by the device pixel ratio)
+        y = image.height() - y - h;
+        frame.transform.scale(1.0, -1.0);
+        frame.transform.translate(viewport.x(), -viewport.y() - viewport.height());
+    } else {
+        frame.transform.translate(viewport.x(), viewport.y());
+    }
+    // detaches from the readback data, which is gone after this
+    frame.image = image.copy(QRect(x, y, w, h).intersected(image.rect()));
+    frame.image.setDevicePixelRatio(dpr);
+
+    emit sceneGrabbed(frame);
+
+    locker.unlock();
+    setGrabbingMode(false, QRectF());
+}
+
 SoftwareScreenGrabber::SoftwareScreenGrabber(QQuickWindow *window)
     : AbstractScreenGrabber(window)
 {
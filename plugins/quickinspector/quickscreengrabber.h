@@ -21,6 +21,11 @@
 #include <QQuickItem>
 #include <QMutex>
 
+#ifndef QT_NO_OPENGL
+#include <QOpenGLExtraFunctions>
+#endif
+
+#include <array>
 #include <memory>
 
 QT_BEGIN_NAMESPACE
@@ -194,6 +199,13 @@ protected:
 };
 
 #ifndef QT_NO_OPENGL
+/**
+ * @brief Screen grabber for OpenGL rendering.
+ *
+ * Where pixel buffer objects and fences are available (OpenGL 3.2, OpenGL ES 3.0), the window
+ * content is read back into one of two pixel buffers asynchronously, and handed out on a later
+ * frame once the GPU is done with it, instead of stalling the render thread until then.
+ */
 class OpenGLScreenGrabber : public AbstractScreenGrabber
 {
     Q_OBJECT
@@ -205,15 +217,64 @@ public:
     void drawDecorations() override;
 
 private:
+    struct PixelBuffer
+    {
+        GLuint buffer = 0;
+        GLsizeiptr size = 0;
+        GLsync fence = nullptr;
+        QSize imageSize;
+        GrabbedFrame frame; // everything but the image, as of the frame being read back
+    };
+
     void setGrabbingMode(bool isGrabbingMode, const QRectF &userViewport);
     void windowAfterSynchronizing();
     void windowAfterRendering();
+    void sceneGraphInvalidated();
+    bool asyncReadbackSupported() const;
+    void startReadback(int x, int y, int w, int h);
+    bool finishReadback();
+    void requestReadbackFrame();
 
     bool m_isGrabbing;
+    bool m_readbackStarted = false;
+    bool m_readbackFrameRequested = false;
+    std::array<PixelBuffer, 2> m_pixelBuffers;
+    int m_currentPixelBuffer = 0;
     QMutex m_mutex;
 };
 #endif
 
+/**
+ * @brief Screen grabber for the other RHI backends (Vulkan, Metal, Direct3D).
+ *
+ * Reads back the swap chain asynchronously, and hands out the result whenever QRhi reports
+ * it completed, typically one or two frames later. This doesn't draw decorations into the
+ * target window.
+ */
+class RhiScreenGrabber : public AbstractScreenGrabber
+{
+    Q_OBJECT
+public:
+    explicit RhiScreenGrabber(QQuickWindow *window);
+    ~RhiScreenGrabber() override;
+
+    void requestGrabWindow(const QRectF &userViewport) override;
+    void drawDecorations() override;
+
+private:
+    void setGrabbingMode(bool isGrabbingMode, const QRectF &userViewport);
+    void windowAfterSynchronizing();
+    void windowAfterRendering();
+    void readbackCompleted(const QImage &image, bool yUp);
+
+    bool m_isGrabbing = false;
+    bool m_readbackStarted = false;
+    bool m_readbackFrameRequested = false;
+    GrabbedFrame m_pendingFrame; // everything but the image, as of the frame being read back
+    QRectF m_pendingViewport;
+    QMutex m_mutex;
+};
+
 /**
  * @brief Screen grabber meant for software rendering.
  */
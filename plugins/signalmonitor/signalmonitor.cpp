@@ -13,6 +13,7 @@
 
 #include "signalmonitor.h"
 #include "signalhistorymodel.h"
+#include "signalprofilermodel.h"
 #include "relativeclock.h"
 #include "signalmonitorcommon.h"
 
@@ -38,6 +39,8 @@ SignalMonitor::SignalMonitor(Probe *probe, QObject *parent)
     probe->registerModel(QStringLiteral("com.kdab.GammaRay.SignalHistoryModel"), proxy);
     m_objSelectionModel = ObjectBroker::selectionModel(proxy);
 
+    probe->registerModel(QStringLiteral("com.kdab.GammaRay.SignalProfilerModel"), new SignalProfilerModel(probe, this));
+
     m_clock = new QTimer(this);
     m_clock->setInterval(1000 / 25); // update frequency of the delegate, we could slow this down a lot, and let the client interpolate, if necessary
     m_clock->setSingleShot(false);
@@ -17,6 +17,7 @@
 #include "signalhistorymodel.h"
 #include "signalmonitorclient.h"
 #include "signalmonitorcommon.h"
+#include "signalprofilermodel.h"
 
 #include <ui/clientdecorationidentityproxymodel.h>
 #include <ui/contextmenuextension.h>
@@ -85,10 +86,35 @@ SignalMonitorWidget::SignalMonitorWidget(QWidget *parent)
     ui->favoritesObjectsTreeView->setEventScrollBar(ui->eventScrollBar);
     m_stateManager.setDefaultSizes(ui->favoritesObjectsTreeView->header(),
                                    UISizeVector() << 200 << 200 << -1);
+
+    // counting emissions costs something in every thread, so only start once the profiler is looked at
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, &SignalMonitorWidget::setupProfiler);
+    setupProfiler();
 }
 
 SignalMonitorWidget::~SignalMonitorWidget() = default;
 
+void SignalMonitorWidget::setupProfiler()
+{
+    if (ui->tabWidget->currentWidget() != ui->profilerTab || ui->profilerView->model())
+        return;
+
+    auto proxy = new QSortFilterProxyModel(this);
+    proxy->setSourceModel(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.SignalProfilerModel")));
+    proxy->setDynamicSortFilter(true);
+    ui->profilerView->setModel(proxy);
+    new SearchLineController(ui->profilerSearchLine, proxy);
+
+    ui->profilerView->header()->setObjectName("profilerViewHeader");
+    ui->profilerView->setDeferredResizeMode(SignalProfilerModel::ClassColumn, QHeaderView::Stretch);
+    ui->profilerView->setDeferredResizeMode(SignalProfilerModel::SignalColumn, QHeaderView::Stretch);
+    for (int column = SignalProfilerModel::RateColumn; column < SignalProfilerModel::ColumnCount; ++column)
+        ui->profilerView->setDeferredResizeMode(column, QHeaderView::ResizeToContents);
+
+    // the top emitters first
+    ui->profilerView->sortByColumn(SignalProfilerModel::RateColumn, Qt::DescendingOrder);
+}
+
 void SignalMonitorWidget::intervalScaleValueChanged(int value)
 {
     // FIXME: Define a more reasonable formula.
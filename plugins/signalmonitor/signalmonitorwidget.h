@@ -56,6 +56,7 @@ private slots:
     void eventDelegateIsActiveChanged(bool active);
     void contextMenu(QPoint pos);
     void selectionChanged(const QItemSelection &selection);
+    void setupProfiler();
 
 private:
     static const QString ITEM_TYPE_NAME_OBJECT;
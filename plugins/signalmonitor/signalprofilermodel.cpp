@@ -0,0 +1,306 @@
+/*
+  signalprofilermodel.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "signalprofilermodel.h"
+
+#include <core/probe.h>
+#include <core/probesettings.h>
+#include <core/signalspycallbackset.h>
+
+#include <common/modelevent.h>
+
+#include <QAtomicInt>
+#include <QMetaMethod>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QTimer>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+using namespace GammaRay;
+
+namespace {
+struct Counter
+{
+    // written by the owning thread only, metaObject is published last
+    QAtomicPointer<const QMetaObject> metaObject = nullptr;
+    int methodIndex = -1;
+    QByteArray className;
+    QByteArray signature;
+    QAtomicInteger<quint64> count = 0;
+};
+
+// single writer (the owning thread), read by the probe thread under the registry lock
+struct CounterTable
+{
+    static constexpr int Capacity = 1024; // power of two
+    static constexpr int MaxProbes = 16;
+
+    std::array<Counter, Capacity> counters;
+    QAtomicInteger<quint64> dropped = 0; // emissions not counted since the table is full
+
+    // accessed by the probe thread only
+    std::array<quint64, Capacity> seen = {};
+    quint64 droppedSeen = 0;
+};
+
+struct Registry
+{
+    QMutex mutex;
+    std::vector<std::shared_ptr<CounterTable>> tables;
+};
+}
+
+Q_GLOBAL_STATIC(Registry, s_registry)
+
+static QThreadStorage<std::shared_ptr<CounterTable>> s_localTable;
+static QAtomicInt s_counting = 0;
+
+static CounterTable *localTable()
+{
+    if (s_localTable.hasLocalData())
+        return s_localTable.localData().get();
+
+    if (s_registry.isDestroyed())
+        return nullptr;
+
+    auto table = std::make_shared<CounterTable>();
+    {
+        QMutexLocker lock(&s_registry()->mutex);
+        s_registry()->tables.push_back(table);
+    }
+    s_localTable.setLocalData(table);
+    return table.get();
+}
+
+// only owning thread writes, so a plain load/store pair is enough and avoids a locked instruction
+static void increment(QAtomicInteger<quint64> &value)
+{
+    value.storeRelaxed(value.loadRelaxed() + 1);
+}
+
+/* Dynamic meta objects, as created for QML types, can be created in large numbers and destroyed at
+ * runtime, with their address then being reused for another one. They are therefore counted as the
+ * nearest moc-generated meta object, recognizable by its static metacall function, which lives as
+ * long as the process does. Signals added by dynamic meta objects are counted together.
+ */
+static const QMetaObject *counterMetaObject(const QMetaObject *metaObject)
+{
+    while (!metaObject->d.static_metacall && metaObject->superClass())
+        metaObject = metaObject->superClass();
+    return metaObject;
+}
+
+static void signal_begin_callback(QObject *caller, int method_index, void **argv)
+{
+    Q_UNUSED(argv);
+    if (!s_counting.loadRelaxed())
+        return;
+
+    auto table = localTable();
+    if (!table)
+        return;
+
+    const auto metaObject = counterMetaObject(caller->metaObject());
+    if (method_index >= metaObject->methodCount())
+        method_index = -1;
+    const auto hash = (quintptr(metaObject) >> 4) * 31 + quintptr(method_index);
+    for (int i = 0; i < CounterTable::MaxProbes; ++i) {
+        auto &counter = table->counters[(hash + i) & (CounterTable::Capacity - 1)];
+        const auto key = counter.metaObject.loadRelaxed();
+        if (key == metaObject && counter.methodIndex == method_index) {
+            increment(counter.count);
+            return;
+        }
+        if (!key) {
+            // first emission of this signal in this thread, the only allocating path
+            counter.methodIndex = method_index;
+            counter.className = metaObject->className();
+            counter.signature = method_index < 0 ? QByteArrayLiteral("<dynamic>") : metaObject->method(method_index).methodSignature();
+            counter.count.storeRelaxed(1);
+            counter.metaObject.storeRelease(metaObject);
+            return;
+        }
+    }
+    increment(table->dropped);
+}
+
+SignalProfilerModel::SignalProfilerModel(Probe *probe, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_aggregationTimer(new QTimer(this))
+{
+    SignalSpyCallbackSet spy;
+    spy.signalBeginCallback = signal_begin_callback;
+    probe->registerSignalSpyCallbackSet(spy);
+
+    m_aggregationTimer->setInterval(ProbeSettings::value(QStringLiteral("SignalProfilerInterval"), 1000).toInt());
+    connect(m_aggregationTimer, &QTimer::timeout, this, &SignalProfilerModel::aggregate);
+}
+
+SignalProfilerModel::~SignalProfilerModel()
+{
+    s_counting.storeRelease(0);
+}
+
+int SignalProfilerModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_rows.size();
+}
+
+int SignalProfilerModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return ColumnCount;
+}
+
+QVariant SignalProfilerModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    const auto &row = m_rows[index.row()];
+    switch (index.column()) {
+    case ClassColumn:
+        return QString::fromUtf8(row.className);
+    case SignalColumn:
+        return QString::fromUtf8(row.signature);
+    case RateColumn:
+        return row.rate;
+    case PeakRateColumn:
+        return row.peakRate;
+    case TotalColumn:
+        return row.total;
+    }
+    return QVariant();
+}
+
+QVariant SignalProfilerModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role == Qt::DisplayRole && orientation == Qt::Horizontal) {
+        switch (section) {
+        case ClassColumn:
+            return tr("Class");
+        case SignalColumn:
+            return tr("Signal");
+        case RateColumn:
+            return tr("Emissions/Sec");
+        case PeakRateColumn:
+            return tr("Peak Emissions/Sec");
+        case TotalColumn:
+            return tr("Total Emissions");
+        }
+    }
+    return QVariant();
+}
+
+void SignalProfilerModel::aggregate()
+{
+    const auto elapsed = std::max<qint64>(1, m_intervalTimer.restart());
+
+    struct Delta
+    {
+        QByteArray className;
+        QByteArray signature;
+        quint64 count;
+    };
+    std::vector<Delta> deltas;
+    quint64 dropped = 0;
+
+    if (!s_registry.isDestroyed()) {
+        QMutexLocker lock(&s_registry()->mutex);
+        auto &tables = s_registry()->tables;
+        for (auto it = tables.begin(); it != tables.end();) {
+            auto &table = **it;
+            for (int i = 0; i < CounterTable::Capacity; ++i) {
+                const auto &counter = table.counters[i];
+                if (!counter.metaObject.loadAcquire())
+                    continue;
+                const auto count = counter.count.loadRelaxed();
+                if (count == table.seen[i])
+                    continue;
+                deltas.push_back({ counter.className, counter.signature, count - table.seen[i] });
+                table.seen[i] = count;
+            }
+            const auto tableDropped = table.dropped.loadRelaxed();
+            dropped += tableDropped - table.droppedSeen;
+            table.droppedSeen = tableDropped;
+
+            // the owning thread is gone and everything has been collected
+            if (it->use_count() == 1)
+                it = tables.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // inserting rows emits signals, which must not end up in localTable() while we hold the lock
+    for (auto &row : m_rows)
+        row.intervalCount = 0;
+    for (const auto &delta : deltas)
+        m_rows[rowFor(delta.className, delta.signature)].intervalCount += delta.count;
+    if (dropped)
+        m_rows[rowFor(QByteArrayLiteral("<other>"), QByteArrayLiteral("<untracked>"))].intervalCount += dropped;
+
+    if (m_rows.empty())
+        return;
+    for (auto &row : m_rows) {
+        row.total += row.intervalCount;
+        row.rate = row.intervalCount * 1000 / elapsed;
+        row.peakRate = std::max(row.peakRate, row.rate);
+    }
+    emit dataChanged(index(0, RateColumn), index(rowCount() - 1, TotalColumn));
+}
+
+void SignalProfilerModel::customEvent(QEvent *event)
+{
+    if (event->type() == ModelEvent::eventType())
+        setCounting(static_cast<ModelEvent *>(event)->used());
+    QAbstractTableModel::customEvent(event);
+}
+
+void SignalProfilerModel::setCounting(bool counting)
+{
+    if (counting == bool(s_counting.loadRelaxed()))
+        return;
+
+    s_counting.storeRelease(counting);
+    if (counting) {
+        m_intervalTimer.start();
+        m_aggregationTimer->start();
+    } else {
+        m_aggregationTimer->stop();
+        aggregate(); // otherwise this would be attributed to the next interval we are used in
+    }
+}
+
+int SignalProfilerModel::rowFor(const QByteArray &className, const QByteArray &signature)
+{
+    const auto key = qMakePair(className, signature);
+    const auto it = m_rowIndexes.constFind(key);
+    if (it != m_rowIndexes.cend())
+        return it.value();
+
+    const int row = m_rows.size();
+    beginInsertRows(QModelIndex(), row, row);
+    Row r;
+    r.className = className;
+    r.signature = signature;
+    m_rows.push_back(r);
+    m_rowIndexes.insert(key, row);
+    endInsertRows();
+    return row;
+}
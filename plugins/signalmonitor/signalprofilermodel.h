@@ -0,0 +1,94 @@
+/*
+  signalprofilermodel.h
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#ifndef GAMMARAY_SIGNALPROFILERMODEL_H
+#define GAMMARAY_SIGNALPROFILERMODEL_H
+
+#include <QAbstractTableModel>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPair>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
+
+namespace GammaRay {
+class Probe;
+
+/** @brief Signal emission counts and rates per (class, signal).
+ *
+ *  Unlike SignalHistoryModel, this does not record individual emissions. Each emitting thread
+ *  only increments a counter in its own fixed-size table, without locking or posting anything
+ *  to the probe thread. The tables are aggregated in the probe thread every
+ *  @c SignalProfilerInterval milliseconds (probe setting, 1000 by default).
+ *
+ *  Objects with a dynamic meta object, such as QML types, are counted as their nearest
+ *  moc-generated base class.
+ *
+ *  Counting is only active while the model is in use, see ModelEvent.
+ *
+ *  @since 3.4
+ */
+class SignalProfilerModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit SignalProfilerModel(Probe *probe, QObject *parent = nullptr);
+    ~SignalProfilerModel() override;
+
+    enum Columns
+    {
+        ClassColumn,
+        SignalColumn,
+        RateColumn, ///< emissions per second during the last interval
+        PeakRateColumn,
+        TotalColumn,
+        ColumnCount
+    };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /** Collects the counters of all threads, done periodically while counting is active. */
+    void aggregate();
+
+protected:
+    void customEvent(QEvent *event) override;
+
+private:
+    struct Row
+    {
+        QByteArray className;
+        QByteArray signature;
+        qint64 total = 0;
+        qint64 rate = 0;
+        qint64 peakRate = 0;
+        qint64 intervalCount = 0; // emissions in the current aggregation run
+    };
+
+    void setCounting(bool counting);
+    int rowFor(const QByteArray &className, const QByteArray &signature);
+
+    std::vector<Row> m_rows;
+    QHash<QPair<QByteArray, QByteArray>, int> m_rowIndexes;
+    QElapsedTimer m_intervalTimer;
+    QTimer *m_aggregationTimer;
+};
+}
+
+#endif // GAMMARAY_SIGNALPROFILERMODEL_H
@@ -0,0 +1,103 @@
+/*
+  allocationprofilertest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "baseprobetest.h"
+#include "testhelpers.h"
+
+#include <plugins/allocationprofiler/allocationmodel.h>
+
+#include <common/objectbroker.h>
+
+#include <QAbstractItemModelTester>
+
+#include <memory>
+#include <numeric>
+#include <vector>
+
+using namespace GammaRay;
+using namespace TestHelpers;
+
+class Churner : public QObject
+{
+    Q_OBJECT
+public:
+    using QObject::QObject;
+};
+
+class AllocationProfilerTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    static int sum(const QVector<int> &values)
+    {
+        return std::accumulate(values.begin(), values.end(), 0);
+    }
+
+private slots:
+    void testChurn()
+    {
+        createProbe();
+
+        auto *model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.AllocationModel"));
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        std::vector<std::unique_ptr<Churner>> churners;
+        for (int i = 0; i < 5; ++i)
+            churners.emplace_back(new Churner);
+        QTest::qWait(1);
+
+        const auto idx = searchFixedIndex(model, "Churner");
+        QVERIFY(idx.isValid());
+        QCOMPARE(idx.sibling(idx.row(), AllocationModel::AliveColumn).data().toInt(), 5);
+
+        churners.resize(2);
+        QCOMPARE(idx.sibling(idx.row(), AllocationModel::AliveColumn).data().toInt(), 2);
+
+        // rates and histories only cover complete seconds
+        QTest::qWait(1100);
+        QCOMPARE(idx.sibling(idx.row(), AllocationModel::ChurnColumn).data().toInt(), 3);
+        QVERIFY(idx.sibling(idx.row(), AllocationModel::LifetimeColumn).data().toDouble() >= 0.0);
+
+        const auto history = idx.sibling(idx.row(), AllocationModel::HistoryColumn);
+        const auto created = history.data(AllocationModel::CreationHistoryRole).value<QVector<int>>();
+        const auto destroyed = history.data(AllocationModel::DestructionHistoryRole).value<QVector<int>>();
+        QCOMPARE(created.size(), 60);
+        QCOMPARE(sum(created), 5);
+        QCOMPARE(sum(destroyed), 3);
+
+        const auto lifetimes = idx.sibling(idx.row(), AllocationModel::LifetimeColumn).data(AllocationModel::LifetimeHistogramRole).value<QVector<int>>();
+        QCOMPARE(lifetimes.size(), int(AllocationModel::LifetimeBucketCount));
+        QCOMPARE(sum(lifetimes), 3);
+    }
+
+    void testShortLived()
+    {
+        createProbe();
+
+        auto *model = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.AllocationModel"));
+        QVERIFY(model);
+
+        // destroyed before the probe got to report its creation
+        delete new Churner;
+        QTest::qWait(1100);
+
+        const auto idx = searchFixedIndex(model, "<short-lived>");
+        QVERIFY(idx.isValid());
+        QVERIFY(idx.sibling(idx.row(), AllocationModel::ChurnColumn).data().toInt() >= 1);
+        QCOMPARE(idx.sibling(idx.row(), AllocationModel::LifetimeColumn).data().toDouble(), -1.0);
+    }
+};
+
+QTEST_MAIN(AllocationProfilerTest)
+
+#include "allocationprofilertest.moc"
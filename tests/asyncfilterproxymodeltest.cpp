@@ -0,0 +1,237 @@
+/*
+  asyncfilterproxymodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "core/remote/asyncfilterproxymodel.h"
+
+#include <QAbstractItemModelTester>
+#include <QObject>
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTest>
+#include <QTimer>
+
+using namespace GammaRay;
+
+class AsyncFilterProxyModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void fillList(QStandardItemModel *model, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            model->appendRow(new QStandardItem(QStringLiteral("item%1").arg(i)));
+    }
+
+    static void fillTree(QStandardItemModel *model, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            auto parent = new QStandardItem(QStringLiteral("parent%1").arg(i));
+            for (int j = 0; j < count; ++j)
+                parent->appendRow(new QStandardItem(QStringLiteral("child%1.%2").arg(i).arg(j)));
+            model->appendRow(parent);
+        }
+    }
+
+    static bool waitForSearch(AsyncFilterProxyModel *proxy)
+    {
+        if (!proxy->isSearching())
+            return true;
+        QSignalSpy spy(proxy, &AsyncFilterProxyModel::searchFinished);
+        return spy.wait();
+    }
+
+private slots:
+    void testFilter()
+    {
+        QStandardItemModel source;
+        fillList(&source, 10000);
+
+        AsyncFilterProxyModel proxy;
+        QAbstractItemModelTester modelTest(&proxy);
+        proxy.setSourceModel(&source);
+        QCOMPARE(proxy.rowCount(), 10000);
+
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item99")));
+        QVERIFY(proxy.isSearching());
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 11); // item99, item990-item999
+
+        // stale searches are cancelled, the snapshot is reused
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item1")));
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("ITEM2"), QRegularExpression::CaseInsensitiveOption));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 1111);
+
+        proxy.setFilterPatternCaseSensitivity(Qt::CaseSensitive);
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 0);
+
+        proxy.setFilterPattern(QRegularExpression());
+        QVERIFY(!proxy.isSearching());
+        QCOMPARE(proxy.rowCount(), 10000);
+    }
+
+    void testSourceChanges()
+    {
+        QStandardItemModel source;
+        fillList(&source, 1000);
+
+        AsyncFilterProxyModel proxy;
+        QAbstractItemModelTester modelTest(&proxy);
+        proxy.setSourceModel(&source);
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item99")));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 11);
+
+        // new and changed rows are matched right away
+        source.appendRow(new QStandardItem(QStringLiteral("item99x")));
+        QCOMPARE(proxy.rowCount(), 12);
+        source.item(5)->setText(QStringLiteral("item99y"));
+        QCOMPARE(proxy.rowCount(), 13);
+        source.item(5)->setText(QStringLiteral("item5"));
+        QCOMPARE(proxy.rowCount(), 12);
+
+        // removing rows during a search keeps the results for the others
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item5")));
+        source.removeRows(0, 10);
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 110); // item5, item50-59, item500-599, minus item5
+        QCOMPARE(proxy.index(0, 0).data().toString(), QStringLiteral("item50"));
+    }
+
+    void testInsertDuringSearch()
+    {
+        QStandardItemModel source;
+        fillList(&source, 10000);
+
+        AsyncFilterProxyModel proxy;
+        QAbstractItemModelTester modelTest(&proxy);
+        proxy.setSourceModel(&source);
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item1")));
+        QVERIFY(waitForSearch(&proxy));
+
+        // the snapshot is complete already, so inserted rows are decided right away
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("item99")));
+        QVERIFY(proxy.isSearching());
+        source.insertRow(0, new QStandardItem(QStringLiteral("item99new")));
+        source.insertRow(1, new QStandardItem(QStringLiteral("other")));
+        QVERIFY(proxy.isSearching());
+        QVERIFY(proxy.mapFromSource(source.index(0, 0)).isValid());
+        QVERIFY(!proxy.mapFromSource(source.index(1, 0)).isValid());
+
+        // constant changes must not keep the search from finishing
+        int counter = 0;
+        QTimer churn;
+        churn.setInterval(0);
+        connect(&churn, &QTimer::timeout, &source, [&source, &counter]() {
+            source.insertRow(0, new QStandardItem(QStringLiteral("item99x%1").arg(counter++)));
+            source.removeRow(source.rowCount() - 1);
+        });
+        churn.start();
+        QVERIFY(waitForSearch(&proxy));
+        churn.stop();
+
+        int expected = 0;
+        for (int row = 0; row < source.rowCount(); ++row) {
+            if (source.item(row)->text().contains(QLatin1String("item99")))
+                ++expected;
+        }
+        QCOMPARE(proxy.rowCount(), expected);
+        QVERIFY(proxy.mapFromSource(source.indexFromItem(source.findItems(QStringLiteral("item99new")).value(0))).isValid());
+    }
+
+    void testKeyColumn()
+    {
+        QStandardItemModel source;
+        for (int i = 0; i < 100; ++i)
+            source.appendRow({ new QStandardItem(QStringLiteral("item%1").arg(i)), new QStandardItem(QStringLiteral("value%1").arg(i % 10)) });
+
+        AsyncFilterProxyModel proxy;
+        proxy.setSourceModel(&source);
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("value3")));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 0);
+
+        proxy.setFilterPatternKeyColumn(-1);
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 10);
+
+        proxy.setFilterPatternKeyColumn(1);
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 10);
+    }
+
+    void testTree()
+    {
+        QStandardItemModel source;
+        fillTree(&source, 10);
+
+        AsyncFilterProxyModel proxy;
+        QAbstractItemModelTester modelTest(&proxy);
+        proxy.setRecursiveFilteringEnabled(true);
+        proxy.setSourceModel(&source);
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("child3\\.[45]")));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 1);
+        const auto parent = proxy.index(0, 0);
+        QCOMPARE(parent.data().toString(), QStringLiteral("parent3"));
+        QCOMPARE(proxy.rowCount(parent), 2);
+
+        // moved and inserted children are matched right away
+        source.item(5)->appendRow(source.item(3)->takeRow(4));
+        QCOMPARE(proxy.rowCount(), 2);
+        QCOMPARE(proxy.rowCount(proxy.index(0, 0)), 1);
+        QCOMPARE(proxy.rowCount(proxy.index(1, 0)), 1);
+        source.item(0)->appendRow(new QStandardItem(QStringLiteral("child3.5x")));
+        QCOMPARE(proxy.rowCount(), 3);
+        QCOMPARE(proxy.index(0, 0).data().toString(), QStringLiteral("parent0"));
+    }
+
+    void testRowsAboveCollectedParent()
+    {
+        QStandardItemModel source;
+        fillTree(&source, 10);
+
+        AsyncFilterProxyModel proxy;
+        QAbstractItemModelTester modelTest(&proxy);
+        proxy.setRecursiveFilteringEnabled(true);
+        proxy.setSourceModel(&source);
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("child3\\.[45]")));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 1);
+
+        // shifts the rows of the collected parents, whose children must still be found
+        source.insertRow(0, new QStandardItem(QStringLiteral("parentNew")));
+        source.removeRow(1); // parent0
+        source.insertRow(1, new QStandardItem(QStringLiteral("parentNew2")));
+        auto parent3 = source.item(4);
+        QCOMPARE(parent3->text(), QStringLiteral("parent3"));
+        parent3->child(4)->setText(QStringLiteral("changed"));
+        QCOMPARE(proxy.rowCount(), 1);
+        QCOMPARE(proxy.rowCount(proxy.index(0, 0)), 1);
+        parent3->appendRow(new QStandardItem(QStringLiteral("child3.5b")));
+        QCOMPARE(proxy.rowCount(proxy.index(0, 0)), 2);
+
+        // the snapshot is reused for the next search
+        proxy.setFilterPattern(QRegularExpression(QStringLiteral("child[37]\\.5")));
+        QVERIFY(waitForSearch(&proxy));
+        QCOMPARE(proxy.rowCount(), 2);
+        QCOMPARE(proxy.index(0, 0).data().toString(), QStringLiteral("parent3"));
+        QCOMPARE(proxy.rowCount(proxy.index(0, 0)), 2);
+        QCOMPARE(proxy.index(1, 0).data().toString(), QStringLiteral("parent7"));
+        QCOMPARE(proxy.rowCount(proxy.index(1, 0)), 1);
+    }
+};
+
+QTEST_MAIN(AsyncFilterProxyModelTest)
+
+#include "asyncfilterproxymodeltest.moc"
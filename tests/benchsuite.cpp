@@ -12,14 +12,23 @@
 */
 
 #include "benchsuite.h"
+#include "core/objectset.h"
 #include "core/probe.h"
 #include "core/util.h"
 
+#include <common/message.h>
+
 #include <QtTestGui>
 
+#include <QBuffer>
 #include <QLabel>
+#include <QSet>
+#include <QThread>
 #include <QTreeView>
 
+#include <memory>
+#include <vector>
+
 QTEST_MAIN(GammaRay::BenchSuite)
 
 using namespace GammaRay;
@@ -64,3 +73,334 @@ void BenchSuite::probe_objectAdded()
     qDeleteAll(objects);
     delete Probe::instance();
 }
+
+void BenchSuite::probe_objectTrackingContention_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("lockFree");
+
+    for (int threadCount : { 1, 4, 16 }) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 threads, locked").arg(threadCount))) << threadCount << false;
+        QTest::newRow(qPrintable(QStringLiteral("%1 threads, lock-free").arg(threadCount))) << threadCount << true;
+    }
+}
+
+void BenchSuite::probe_objectTrackingContention()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, lockFree);
+
+    qputenv("GAMMARAY_LockFreeObjectCapture", lockFree ? "true" : "false");
+    Probe::createProbe(false);
+
+    static const int NUM_OBJECTS = 100000;
+    QBENCHMARK_ONCE
+    {
+        std::vector<std::unique_ptr<QThread>> threads;
+        threads.reserve(threadCount);
+        for (int i = 0; i < threadCount; ++i) {
+            // same sequence of calls the ctor/dtor hooks would produce
+            threads.emplace_back(QThread::create([]() {
+                for (int j = 0; j < NUM_OBJECTS; ++j) {
+                    auto *obj = new QObject;
+                    Probe::objectAdded(obj, true);
+                    Probe::objectRemoved(obj);
+                    delete obj;
+                }
+            }));
+            threads.back()->start();
+        }
+        for (const auto &thread : threads)
+            thread->wait();
+        QCoreApplication::processEvents();
+    }
+
+    delete Probe::instance();
+    qunsetenv("GAMMARAY_LockFreeObjectCapture");
+}
+
+void BenchSuite::probe_queuedObjectChurn()
+{
+    Probe::createProbe(false);
+
+    QObject parent;
+    Probe::objectAdded(&parent);
+
+    static const int NUM_OBJECTS = 1000000;
+    QVector<QObject *> objects;
+    objects.reserve(NUM_OBJECTS);
+
+    // all of this happens before the queue is processed, as it would during a startup burst
+    QBENCHMARK_ONCE
+    {
+        for (int i = 0; i < NUM_OBJECTS; ++i) {
+            auto *obj = new QObject(&parent);
+            Probe::objectAdded(obj, true);
+            objects.push_back(obj);
+        }
+        for (auto *obj : std::as_const(objects)) {
+            Probe::objectRemoved(obj);
+            delete obj;
+        }
+    }
+
+    QCoreApplication::processEvents();
+    Probe::objectRemoved(&parent);
+    delete Probe::instance();
+}
+
+void BenchSuite::probe_manyChildren()
+{
+    Probe::createProbe(false);
+
+    QObject parent;
+    Probe::objectAdded(&parent);
+
+    // like the delegates of a large ListView, all below the same parent
+    static const int NUM_OBJECTS = 100000;
+    QVector<QObject *> objects;
+    objects.reserve(NUM_OBJECTS);
+
+    QBENCHMARK_ONCE
+    {
+        for (int i = 0; i < NUM_OBJECTS; ++i) {
+            auto *obj = new QObject(&parent);
+            Probe::objectAdded(obj);
+            objects.push_back(obj);
+        }
+        QCoreApplication::processEvents();
+        // in the order ~QObject destroys its children
+        for (auto *obj : std::as_const(objects)) {
+            Probe::objectRemoved(obj);
+            delete obj;
+        }
+        QCoreApplication::processEvents();
+    }
+
+    Probe::objectRemoved(&parent);
+    delete Probe::instance();
+}
+
+void BenchSuite::probe_findExistingObjects_data()
+{
+    QTest::addColumn<bool>("incremental");
+    QTest::newRow("blocking") << false;
+    QTest::newRow("incremental") << true;
+}
+
+void BenchSuite::probe_findExistingObjects()
+{
+    QFETCH(bool, incremental);
+    qputenv("GAMMARAY_IncrementalObjectDiscovery", incremental ? "true" : "false");
+
+    // a flat list of top-level objects, each with a few children, as found when attaching to a running application
+    static const int NUM_OBJECTS = 100000;
+    std::vector<std::unique_ptr<QObject>> objects;
+    objects.reserve(NUM_OBJECTS);
+    for (int i = 0; i < NUM_OBJECTS; ++i) {
+        objects.emplace_back(new QObject(QCoreApplication::instance()));
+        for (int j = 0; j < 4; ++j)
+            new QObject(objects.back().get());
+    }
+
+    QBENCHMARK_ONCE
+    {
+        Probe::createProbe(true);
+        // time-sliced discovery runs from the event loop
+        QTRY_VERIFY_WITH_TIMEOUT(Probe::instance()->m_discoveryStack.isEmpty(), 60000);
+    }
+
+    QVERIFY(Probe::instance()->allQObjects().size() > NUM_OBJECTS * 5);
+    delete Probe::instance();
+    qunsetenv("GAMMARAY_IncrementalObjectDiscovery");
+}
+
+static void objectSetData()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("1M") << 1000000;
+    QTest::newRow("2M") << 2000000;
+}
+
+// spread like heap allocated QObjects, to get realistic hashing and cache behavior
+static const QObject *fakeObject(int i)
+{
+    return reinterpret_cast<const QObject *>(quintptr(0x10000000) + quintptr(i) * 48);
+}
+
+void BenchSuite::objectSet_contains_data()
+{
+    objectSetData();
+}
+
+void BenchSuite::objectSet_contains()
+{
+    QFETCH(int, count);
+
+    ObjectSet set;
+    for (int i = 0; i < count; ++i)
+        set.insert(fakeObject(i));
+    qDebug() << "ObjectSet:" << count << "entries," << set.memoryUsage() / 1024 << "KiB";
+
+    int found = 0;
+    QBENCHMARK
+    {
+        // half hits, half misses
+        for (int i = 0; i < 2 * count; i += 2)
+            found += set.contains(fakeObject(i));
+    }
+    QVERIFY(found > 0);
+}
+
+void BenchSuite::qset_contains_data()
+{
+    objectSetData();
+}
+
+void BenchSuite::qset_contains()
+{
+    QFETCH(int, count);
+
+    QSet<const QObject *> set;
+    for (int i = 0; i < count; ++i)
+        set.insert(fakeObject(i));
+    qDebug() << "QSet:" << count << "entries," << set.capacity() << "buckets";
+
+    int found = 0;
+    QBENCHMARK
+    {
+        for (int i = 0; i < 2 * count; i += 2)
+            found += set.contains(fakeObject(i));
+    }
+    QVERIFY(found > 0);
+}
+
+void BenchSuite::message_writeRead_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::newRow("16B") << 16;
+    QTest::newRow("4kB") << 4096;
+    QTest::newRow("1MB") << 1024 * 1024;
+}
+
+void BenchSuite::message_writeRead()
+{
+    QFETCH(int, size);
+    // compressible, like most model content
+    QByteArray payload(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        payload[i] = char('a' + i % 23);
+
+    QBuffer device;
+    device.open(QIODevice::ReadWrite);
+    QBENCHMARK
+    {
+        device.buffer().clear();
+        device.seek(0);
+        {
+            Message msg(1, 2);
+            msg << payload;
+            msg.write(&device);
+        }
+        device.seek(0);
+        QVERIFY(Message::canReadMessage(&device));
+        const auto msg = Message::readMessage(&device);
+        QByteArray result;
+        msg >> result;
+        QCOMPARE(result.size(), size);
+    }
+}
+
+void BenchSuite::message_batch_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("individual") << false;
+    QTest::newRow("batched") << true;
+}
+
+void BenchSuite::message_batch()
+{
+    QFETCH(bool, batched);
+    // lots of tiny messages, like model change notifications
+    static const int NUM_MESSAGES = 1000;
+
+    QBuffer device;
+    device.open(QIODevice::ReadWrite);
+    QBENCHMARK
+    {
+        device.buffer().clear();
+        device.seek(0);
+        Message batch(1, Protocol::MessageBatch);
+        for (int i = 0; i < NUM_MESSAGES; ++i) {
+            Message msg(2, Protocol::ModelContentChanged);
+            msg << Protocol::ModelIndex() << Protocol::ModelIndex() << QVector<int>({ i });
+            if (batched)
+                msg.appendTo(batch);
+            else
+                msg.write(&device);
+        }
+        if (batched)
+            batch.write(&device);
+
+        device.seek(0);
+        int count = 0;
+        while (Message::canReadMessage(&device)) {
+            const auto msg = Message::readMessage(&device);
+            if (msg.type() != Protocol::MessageBatch) {
+                ++count;
+                continue;
+            }
+            while (msg.canReadBatchedMessage()) {
+                msg.readBatchedMessage();
+                ++count;
+            }
+        }
+        QCOMPARE(count, NUM_MESSAGES);
+    }
+    qDebug() << "bytes written:" << device.size();
+}
+
+void BenchSuite::message_streamCompression_data()
+{
+    QTest::addColumn<bool>("streamed");
+    QTest::newRow("independent") << false;
+    QTest::newRow("streamed") << true;
+}
+
+void BenchSuite::message_streamCompression()
+{
+    QFETCH(bool, streamed);
+    // small messages repeating the same names, like property syncing or model content replies
+    static const int NUM_MESSAGES = 1000;
+
+    MessageStream sendStream;
+    MessageStream receiveStream;
+    QBuffer device;
+    device.open(QIODevice::ReadWrite);
+    QBENCHMARK
+    {
+        sendStream.reset();
+        receiveStream.reset();
+        device.buffer().clear();
+        device.seek(0);
+        for (int i = 0; i < NUM_MESSAGES; ++i) {
+            Message msg(2, Protocol::PropertyValuesChanged);
+            msg << QStringLiteral("com.kdab.GammaRay.ObjectInspector.properties") << QStringLiteral("objectName") << i;
+            msg.write(&device, streamed ? &sendStream : nullptr);
+        }
+
+        device.seek(0);
+        for (int i = 0; i < NUM_MESSAGES; ++i) {
+            QVERIFY(Message::canReadMessage(&device));
+            const auto msg = Message::readMessage(&device, &receiveStream);
+            QString objectName;
+            QString propertyName;
+            int value;
+            msg >> objectName >> propertyName >> value;
+            QCOMPARE(value, i);
+        }
+    }
+    qDebug() << "bytes written:" << device.size();
+}
+
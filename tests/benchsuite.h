@@ -24,6 +24,22 @@ class BenchSuite : public QObject
 private slots:
     void iconForObject();
     static void probe_objectAdded();
+    static void probe_objectTrackingContention_data();
+    static void probe_objectTrackingContention();
+    static void probe_queuedObjectChurn();
+    static void probe_manyChildren();
+    static void probe_findExistingObjects_data();
+    static void probe_findExistingObjects();
+    static void objectSet_contains_data();
+    static void objectSet_contains();
+    static void qset_contains_data();
+    static void qset_contains();
+    static void message_writeRead_data();
+    static void message_writeRead();
+    static void message_batch_data();
+    static void message_batch();
+    static void message_streamCompression_data();
+    static void message_streamCompression();
 };
 }
 
@@ -0,0 +1,251 @@
+/*
+  eventmonitortest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "baseprobetest.h"
+
+#include <plugins/eventmonitor/eventmodelroles.h>
+#include <plugins/eventmonitor/eventmonitorinterface.h>
+
+#include <core/probesettings.h>
+
+#include <common/objectbroker.h>
+#include <common/objectid.h>
+
+#include <QAbstractItemModelTester>
+#include <QAbstractProxyModel>
+#include <QMouseEvent>
+#include <QThread>
+#include <QTime>
+
+#include <functional>
+#include <memory>
+
+using namespace GammaRay;
+
+static const auto HistorySize = 5000;
+static const auto CustomEvent = QEvent::Type(QEvent::User + 1);
+static const auto WorkerEvent = QEvent::Type(QEvent::User + 2);
+static const auto OverflowEvent = QEvent::Type(QEvent::User + 3);
+
+class EventMonitorTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    void createProbe() override
+    {
+        qputenv("GAMMARAY_EventMonitorHistorySize", QByteArray::number(HistorySize));
+        BaseProbeTest::createProbe();
+    }
+
+    static bool compactCapture()
+    {
+        return ProbeSettings::value(QStringLiteral("EventMonitorCompactCapture"), false).toBool();
+    }
+
+    // the unsorted and unfiltered events, oldest first
+    static QAbstractItemModel *eventModel()
+    {
+        auto proxy = qobject_cast<QAbstractProxyModel *>(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.EventModel")));
+        return proxy ? proxy->sourceModel() : nullptr;
+    }
+
+    static void sendEvents(QObject *receiver, QEvent::Type type, int count)
+    {
+        for (int i = 0; i < count; ++i) {
+            QEvent event(type);
+            QCoreApplication::sendEvent(receiver, &event);
+        }
+    }
+
+    static int eventCount(QAbstractItemModel *model, QEvent::Type type)
+    {
+        int count = 0;
+        for (int row = 0; row < model->rowCount(); ++row) {
+            if (model->index(row, 0).data(EventModelRole::EventTypeRole).value<QEvent::Type>() == type)
+                ++count;
+        }
+        return count;
+    }
+
+    static QModelIndex findEvent(QAbstractItemModel *model, QEvent::Type type, QObject *receiver)
+    {
+        for (int row = model->rowCount() - 1; row >= 0; --row) {
+            const auto index = model->index(row, EventModelColumn::Receiver);
+            if (index.data(EventModelRole::EventTypeRole).value<QEvent::Type>() == type
+                && index.data(EventModelRole::ReceiverIdRole).value<ObjectId>() == ObjectId(receiver))
+                return index.sibling(row, 0);
+        }
+        return {};
+    }
+
+    static QObject *receiverOf(const QModelIndex &index)
+    {
+        return index.sibling(index.row(), EventModelColumn::Receiver).data(EventModelRole::ReceiverIdRole).value<ObjectId>().asQObject();
+    }
+
+    // a mouse event delivered to @p receiver first and then propagated to @p child
+    static void sendPropagatedEvent(QObject *receiver, QObject *child)
+    {
+        QMouseEvent event(QEvent::MouseMove, QPointF(), QPointF(), Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        QCoreApplication::sendEvent(receiver, &event);
+        QCoreApplication::sendEvent(child, &event);
+    }
+
+private slots:
+    void testHistoryBound()
+    {
+        createProbe();
+        if (compactCapture())
+            QSKIP("propagated events are not recorded in compact mode");
+        auto model = eventModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        QObject receiver;
+        QObject child;
+        sendEvents(&receiver, CustomEvent, HistorySize);
+        QTRY_COMPARE(eventCount(model, CustomEvent), HistorySize);
+        QCOMPARE(model->rowCount(), HistorySize);
+
+        sendPropagatedEvent(&receiver, &child);
+        QTRY_VERIFY(findEvent(model, QEvent::MouseMove, &receiver).isValid());
+        const QPersistentModelIndex eventIndex = findEvent(model, QEvent::MouseMove, &receiver);
+        QCOMPARE(model->rowCount(eventIndex), 1);
+        const QPersistentModelIndex childIndex = model->index(0, 0, eventIndex);
+        QCOMPARE(receiverOf(childIndex), &child);
+
+        // the rows in front of it are removed, the propagated event still resolves to the right parent
+        const auto row = eventIndex.row();
+        sendEvents(&receiver, CustomEvent, 100);
+        QTRY_VERIFY(eventIndex.row() < row);
+        QCOMPARE(model->rowCount(), HistorySize);
+        QVERIFY(childIndex.isValid());
+        QCOMPARE(childIndex.parent(), QModelIndex(eventIndex));
+        QCOMPARE(receiverOf(childIndex), &child);
+        QCOMPARE(receiverOf(childIndex.parent()), &receiver);
+        QCOMPARE(receiverOf(model->index(0, 0, eventIndex)), &child);
+
+        // and when it is removed itself, so is everything below it
+        sendEvents(&receiver, CustomEvent, HistorySize);
+        QTRY_VERIFY(!eventIndex.isValid());
+        QVERIFY(!childIndex.isValid());
+        QCOMPARE(model->rowCount(), HistorySize);
+    }
+
+    void testClear()
+    {
+        createProbe();
+        if (compactCapture())
+            QSKIP("propagated events are not recorded in compact mode");
+        auto model = eventModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+        auto iface = ObjectBroker::object<EventMonitorInterface *>();
+        QVERIFY(iface);
+
+        QObject receiver;
+        QObject child;
+        sendPropagatedEvent(&receiver, &child);
+        QTRY_VERIFY(findEvent(model, QEvent::MouseMove, &receiver).isValid());
+        const QPersistentModelIndex eventIndex = findEvent(model, QEvent::MouseMove, &receiver);
+        const QPersistentModelIndex childIndex = model->index(0, 0, eventIndex);
+        QVERIFY(childIndex.isValid());
+
+        // events not inserted yet are gone as well
+        sendEvents(&receiver, CustomEvent, 10);
+        iface->clearHistory();
+        QCOMPARE(model->rowCount(), 0);
+        QVERIFY(!eventIndex.isValid());
+        QVERIFY(!childIndex.isValid());
+        QTest::qWait(500);
+        QCOMPARE(eventCount(model, CustomEvent), 0);
+
+        // propagated events of events recorded afterwards resolve to the right parent
+        sendEvents(&receiver, CustomEvent, 10);
+        sendPropagatedEvent(&receiver, &child);
+        QTRY_VERIFY(findEvent(model, QEvent::MouseMove, &receiver).isValid());
+        const auto newEventIndex = findEvent(model, QEvent::MouseMove, &receiver);
+        QCOMPARE(model->rowCount(newEventIndex), 1);
+        const auto newChildIndex = model->index(0, 0, newEventIndex);
+        QCOMPARE(newChildIndex.parent(), newEventIndex);
+        QCOMPARE(receiverOf(newChildIndex), &child);
+    }
+
+    void testCompactRecords()
+    {
+        createProbe();
+        if (!compactCapture())
+            QSKIP("only applies to compact mode");
+        auto model = eventModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        QThread thread;
+        thread.setObjectName(QStringLiteral("eventmonitortest worker"));
+        QObject context;
+        context.moveToThread(&thread);
+        thread.start();
+        // blocks the probe thread, so nothing is collected meanwhile
+        const auto runInThread = [&context](const std::function<void()> &func) {
+            QMetaObject::invokeMethod(&context, func, Qt::BlockingQueuedConnection);
+        };
+
+        // interleaved with events in the probe thread, those are compact records as well
+        QObject receiver;
+        for (int i = 0; i < 5; ++i) {
+            runInThread([&context]() {
+                sendEvents(&context, WorkerEvent, 2);
+            });
+            sendEvents(&receiver, CustomEvent, 1);
+            QTest::qWait(10);
+        }
+        QTRY_COMPARE(eventCount(model, WorkerEvent), 10);
+        QTRY_COMPARE(eventCount(model, CustomEvent), 5);
+        const auto index = findEvent(model, WorkerEvent, &context);
+        QVERIFY(index.isValid());
+        const auto attributes = index.data(EventModelRole::AttributesRole).toMap();
+        QVERIFY(attributes.value(QStringLiteral("[thread]")).toString().contains(QStringLiteral("eventmonitortest worker")));
+        QVERIFY(!findEvent(model, CustomEvent, &receiver).data(EventModelRole::AttributesRole).toMap().value(QStringLiteral("[thread]")).toString().isEmpty());
+
+        // collected in time order across threads
+        QTime lastTime;
+        for (int row = 0; row < model->rowCount(); ++row) {
+            const auto time = QTime::fromString(model->index(row, EventModelColumn::Time).data().toString(), QStringLiteral("hh:mm:ss.zzz"));
+            QVERIFY(time.isValid());
+            QVERIFY(!lastTime.isValid() || lastTime <= time);
+            lastTime = time;
+        }
+
+        // a full buffer drops records, rather than blocking or allocating
+        runInThread([&context]() {
+            sendEvents(&context, OverflowEvent, 10000);
+        });
+        QTRY_VERIFY(eventCount(model, OverflowEvent) > 0);
+        QTest::qWait(500);
+        const auto recorded = eventCount(model, OverflowEvent);
+        QVERIFY(recorded < 10000);
+        QVERIFY(recorded > 4000);
+
+        // and recording resumes once it has been collected
+        runInThread([&context]() {
+            sendEvents(&context, WorkerEvent, 10);
+        });
+        QTRY_COMPARE(eventCount(model, WorkerEvent), 20);
+
+        thread.quit();
+        QVERIFY(thread.wait());
+    }
+};
+
+QTEST_MAIN(EventMonitorTest)
+
+#include "eventmonitortest.moc"
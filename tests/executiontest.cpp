@@ -14,6 +14,7 @@
 #include <config-gammaray.h>
 
 #include <core/execution.h>
+#include <core/tracestore.h>
 
 #include <QDebug>
 #include <QObject>
@@ -55,6 +56,52 @@ private slots:
         }
     }
 
+    void testResolveAsync()
+    {
+        if (!Execution::stackTracingAvailable())
+            return;
+        const auto trace = Execution::stackTrace(32);
+        QVector<Execution::ResolvedFrame> frames;
+        bool done = false;
+        Execution::resolveAllAsync(trace, this, [&](const QVector<Execution::ResolvedFrame> &result) {
+            frames = result;
+            done = true;
+        });
+        QTRY_VERIFY(done);
+        QCOMPARE(frames.size(), trace.size());
+
+        // everything is cached now
+        QVector<Execution::ResolvedFrame> cached;
+        QVERIFY(Execution::resolveAllCached(trace, cached));
+        QCOMPARE(cached.size(), frames.size());
+        for (int i = 0; i < frames.size(); ++i)
+            QCOMPARE(cached.at(i).name, frames.at(i).name);
+    }
+
+    static void testTraceStore()
+    {
+        TraceStore store;
+        QCOMPARE(store.intern(Execution::Trace()), TraceStore::InvalidTraceId);
+        QVERIFY(store.trace(TraceStore::InvalidTraceId).empty());
+        if (!Execution::hasFastStackTrace())
+            return;
+
+        QVector<Execution::Trace> traces;
+        for (int i = 0; i < 2; ++i)
+            traces.push_back(Execution::stackTrace(32));
+        const auto otherTrace = Execution::stackTrace(32);
+        QVERIFY(traces.at(0) == traces.at(1));
+        QVERIFY(traces.at(0) != otherTrace);
+
+        const auto id = store.intern(traces.at(0));
+        QVERIFY(id != TraceStore::InvalidTraceId);
+        QCOMPARE(store.intern(traces.at(1)), id);
+        QVERIFY(store.intern(otherTrace) != id);
+        QCOMPARE(store.size(), 2);
+        QVERIFY(store.trace(id) == traces.at(0));
+        QVERIFY(store.trace(id + 2).empty());
+    }
+
     static void benchmarkStackTrace()
     {
         if (!Execution::stackTracingAvailable())
@@ -0,0 +1,64 @@
+/*
+  scenegraphdifftest.qml
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+import QtQuick 2.0
+
+Rectangle {
+  property int count: 2
+
+  color: "lightsteelblue"
+  width: 320
+  height: width/2
+
+  Rectangle {
+    objectName: "left"
+    x: 20
+    y: 20
+    color: "yellow"
+    width: 120
+    height: 120
+
+    Rectangle {
+      objectName: "moving"
+      color: "red"
+      width: 40
+      height: 40
+
+      Rectangle {
+        color: "blue"
+        anchors.fill: parent
+        anchors.margins: 5
+      }
+    }
+  }
+
+  Rectangle {
+    objectName: "right"
+    x: 180
+    y: 20
+    color: "green"
+    width: 120
+    height: 120
+
+    Row {
+      spacing: 2
+      Repeater {
+        model: count
+        Rectangle {
+          color: "black"
+          width: 10
+          height: 10
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,284 @@
+/*
+  messagetest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <common/endpoint.h>
+#include <common/message.h>
+
+#include <QBuffer>
+#include <QHostAddress>
+#include <QObject>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QUrl>
+
+#include <numeric>
+
+using namespace GammaRay;
+
+namespace {
+struct MessageContent
+{
+    Protocol::ObjectAddress address;
+    Protocol::MessageType type;
+    QByteArray data;
+
+    bool operator==(const MessageContent &other) const
+    {
+        return address == other.address && type == other.type && data == other.data;
+    }
+};
+
+MessageContent contentOf(const Message &msg)
+{
+    MessageContent content { msg.address(), msg.type(), {} };
+    msg >> content.data;
+    return content;
+}
+
+// every batched message ends up as a separate entry in @p contents, and so does every batch
+void readAll(QIODevice *device, MessageStream *stream, QVector<MessageContent> &contents, int *batchCount = nullptr)
+{
+    while (Message::canReadMessage(device)) {
+        const auto msg = Message::readMessage(device, stream);
+        if (msg.type() != Protocol::MessageBatch) {
+            contents.push_back(contentOf(msg));
+            continue;
+        }
+        if (batchCount)
+            ++*batchCount;
+        while (msg.canReadBatchedMessage())
+            contents.push_back(contentOf(msg.readBatchedMessage()));
+    }
+}
+}
+
+QT_BEGIN_NAMESPACE
+namespace QTest {
+template<>
+inline char *toString(const MessageContent &content)
+{
+    return qstrdup(QByteArray("address ") + QByteArray::number(content.address) + " type " + QByteArray::number(content.type)
+                   + " size " + QByteArray::number(content.data.size()));
+}
+}
+QT_END_NAMESPACE
+
+namespace GammaRay {
+class TestEndpoint : public Endpoint
+{
+    Q_OBJECT
+public:
+    explicit TestEndpoint(QIODevice *device, QObject *parent = nullptr)
+        : Endpoint(parent)
+    {
+        setDevice(device);
+    }
+
+    using Endpoint::setMessageBatchingEnabled;
+    using Endpoint::setStreamCompressionEnabled;
+
+    bool isRemoteClient() const override
+    {
+        return false;
+    }
+    QUrl serverAddress() const override
+    {
+        return {};
+    }
+
+    QVector<MessageContent> received;
+
+protected:
+    void messageReceived(const Message &msg) override
+    {
+        received.push_back(contentOf(msg));
+    }
+    void handlerDestroyed(Protocol::ObjectAddress, const QString &) override
+    {
+    }
+    void objectDestroyed(Protocol::ObjectAddress, const QString &, QObject *) override
+    {
+    }
+};
+}
+
+class MessageTest : public QObject
+{
+    Q_OBJECT
+private:
+    // similar names and values repeated across messages, like most of our traffic
+    static QByteArray compressiblePayload(int size, int seed)
+    {
+        QByteArray data;
+        data.reserve(size);
+        while (data.size() < size)
+            data += "QObject objectName=\"item" + QByteArray::number(seed++ % 100) + "\" visible=true; ";
+        data.resize(size);
+        return data;
+    }
+
+    static QByteArray randomPayload(int size, int seed)
+    {
+        QRandomGenerator rng(seed);
+        QByteArray data(size, Qt::Uninitialized);
+        for (auto &c : data)
+            c = char(rng.bounded(256));
+        return data;
+    }
+
+    static QVector<MessageContent> createMessages(const QVector<int> &sizes, bool random)
+    {
+        QVector<MessageContent> contents;
+        for (int i = 0; i < sizes.size(); ++i) {
+            contents.push_back({ Protocol::ObjectAddress(42 + i % 3), Protocol::MessageType(Protocol::MethodCall + i % 2),
+                                 random ? randomPayload(sizes.at(i), i) : compressiblePayload(sizes.at(i), i) });
+        }
+        return contents;
+    }
+
+    static Message toMessage(const MessageContent &content)
+    {
+        Message msg(content.address, content.type);
+        msg << content.data;
+        return msg;
+    }
+
+private slots:
+    static void initTestCase()
+    {
+        qputenv("GAMMARAY_LZ4_STREAMING", "1");
+    }
+
+    static void testRoundTrip_data()
+    {
+        QTest::addColumn<QVector<int>>("sizes");
+        QTest::addColumn<bool>("random");
+        QTest::addColumn<bool>("streamed");
+
+        // small ones are sent uncompressed, unless streamed, large ones are compressed independently
+        // and the repetition wraps around the ring buffer of the stream history
+        QVector<int> sizes;
+        for (int i = 0; i < 5; ++i)
+            sizes += { 0, 1, 20, 100, 1000, 40000, 100, 300000, 5 };
+
+        QTest::newRow("compressible") << sizes << false << false;
+        QTest::newRow("compressible streamed") << sizes << false << true;
+        QTest::newRow("random") << sizes << true << false;
+        QTest::newRow("random streamed") << sizes << true << true;
+    }
+
+    static void testRoundTrip()
+    {
+        QFETCH(QVector<int>, sizes);
+        QFETCH(bool, random);
+        QFETCH(bool, streamed);
+
+        const auto messages = createMessages(sizes, random);
+        QByteArray ba;
+        QBuffer buffer(&ba);
+        buffer.open(QIODevice::ReadWrite);
+        MessageStream sendStream;
+        for (const auto &content : messages)
+            toMessage(content).write(&buffer, streamed ? &sendStream : nullptr);
+        if (!random)
+            QVERIFY(ba.size() < std::accumulate(sizes.cbegin(), sizes.cend(), 0));
+
+        buffer.seek(0);
+        MessageStream receiveStream;
+        QVector<MessageContent> received;
+        readAll(&buffer, &receiveStream, received);
+        QCOMPARE(received, messages);
+        QVERIFY(buffer.atEnd());
+    }
+
+    static void testBatchRoundTrip()
+    {
+        QVector<int> sizes;
+        for (int i = 0; i < 200; ++i)
+            sizes.push_back((i * 37) % 500);
+        const auto messages = createMessages(sizes, false);
+
+        Message batch(1, Protocol::MessageBatch);
+        for (const auto &content : messages)
+            toMessage(content).appendTo(batch);
+
+        QByteArray ba;
+        QBuffer buffer(&ba);
+        buffer.open(QIODevice::ReadWrite);
+        batch.write(&buffer);
+        QVERIFY(ba.size() < batch.size()); // compressed as a whole
+        buffer.seek(0);
+
+        QVector<MessageContent> received;
+        int batchCount = 0;
+        readAll(&buffer, nullptr, received, &batchCount);
+        QCOMPARE(batchCount, 1);
+        QCOMPARE(received, messages);
+    }
+
+    static void testEndpointRoundTrip_data()
+    {
+        QTest::addColumn<bool>("streamed");
+        QTest::newRow("batched") << false;
+        QTest::newRow("batched and streamed") << true;
+    }
+
+    void testEndpointRoundTrip()
+    {
+        QFETCH(bool, streamed);
+
+        QTcpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        QTcpSocket socket;
+        socket.connectToHost(server.serverAddress(), server.serverPort());
+        QVERIFY(socket.waitForConnected());
+        QVERIFY(server.waitForNewConnection(5000));
+        auto peer = server.nextPendingConnection();
+        QVERIFY(peer);
+
+        TestEndpoint endpoint(&socket);
+        endpoint.setMessageBatchingEnabled(true);
+        endpoint.setStreamCompressionEnabled(streamed);
+
+        // more than the batch size limit in one event loop iteration, with one message above it in between
+        QVector<int> sizes;
+        for (int i = 0; i < 300; ++i)
+            sizes.push_back(i == 150 ? 100000 : 100 + (i * 53) % 900);
+        const auto messages = createMessages(sizes, false);
+        for (const auto &content : messages)
+            Endpoint::send(toMessage(content));
+
+        MessageStream receiveStream;
+        QVector<MessageContent> received;
+        int batchCount = 0;
+        QTRY_COMPARE_WITH_TIMEOUT((readAll(peer, &receiveStream, received, &batchCount), received.size()), messages.size(), 10000);
+        QCOMPARE(received, messages);
+        QVERIFY(batchCount >= 3); // flushed when exceeding the limit, before the large message, and at the end
+
+        // and the other way around, batches are unpacked before being handed to messageReceived()
+        MessageStream sendStream;
+        Message batch(endpoint.objectAddress(QStringLiteral("com.kdab.GammaRay.Server")), Protocol::MessageBatch);
+        for (int i = 0; i < 100; ++i)
+            toMessage(messages.at(i)).appendTo(batch);
+        batch.write(peer, streamed ? &sendStream : nullptr);
+        toMessage(messages.at(150)).write(peer, streamed ? &sendStream : nullptr);
+        QTRY_COMPARE(endpoint.received.size(), 101);
+        QCOMPARE(endpoint.received.mid(0, 100), messages.mid(0, 100));
+        QCOMPARE(endpoint.received.at(100), messages.at(150));
+    }
+};
+
+QTEST_MAIN(MessageTest)
+
+#include "messagetest.moc"
@@ -14,9 +14,14 @@
 #include "baseprobetest.h"
 
 #include <QDebug>
+#include <QMutexLocker>
 #include <QThread>
 #include <QSignalSpy>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 using namespace GammaRay;
 
 class Thread : public QThread
@@ -80,6 +85,61 @@ private slots:
         t.start();
         QVERIFY(spy.wait(30000));
     }
+
+    static void testCrossThreadDestroy_data()
+    {
+        QTest::addColumn<bool>("destroyInWorker", nullptr);
+
+        QTest::newRow("probe thread") << false;
+        QTest::newRow("other thread") << true;
+    }
+
+    void testCrossThreadDestroy()
+    {
+        QFETCH(bool, destroyInWorker);
+
+        createProbe();
+        QSignalSpy createdSpy(Probe::instance(), &Probe::objectCreated);
+        QVERIFY(createdSpy.isValid());
+
+        // constructed in place, so no other object can get one of these addresses before we are done
+        struct alignas(QObject) Storage
+        {
+            char data[sizeof(QObject)];
+        };
+        static const int Count = 100;
+        std::vector<Storage> storage(Count);
+        std::vector<QObject *> objects;
+
+        // no event loop re-entry until after the destruction, so nothing got published yet
+        std::unique_ptr<QThread> creator(QThread::create([&]() {
+            for (auto &s : storage)
+                objects.push_back(new (s.data) QObject);
+        }));
+        creator->start();
+        QVERIFY(creator->wait(30000));
+
+        const auto destroy = [&objects]() {
+            for (auto obj : objects)
+                obj->~QObject();
+        };
+        if (destroyInWorker) {
+            std::unique_ptr<QThread> destroyer(QThread::create(destroy));
+            destroyer->start();
+            QVERIFY(destroyer->wait(30000));
+        } else {
+            destroy();
+        }
+
+        QTest::qWait(1); // drain whatever is left
+        {
+            QMutexLocker lock(Probe::objectLock());
+            for (auto obj : objects)
+                QVERIFY(!Probe::instance()->isValidObject(obj));
+        }
+        for (const auto &args : std::as_const(createdSpy))
+            QVERIFY(std::find(objects.cbegin(), objects.cend(), args.at(0).value<QObject *>()) == objects.cend());
+    }
 };
 
 QTEST_MAIN(MultiThreadingTest)
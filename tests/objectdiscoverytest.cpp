@@ -0,0 +1,80 @@
+/*
+  objectdiscoverytest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "baseprobetest.h"
+
+#include <common/objectbroker.h>
+#include <common/probecontrollerinterface.h>
+
+#include <QMutexLocker>
+
+#include <memory>
+#include <vector>
+
+using namespace GammaRay;
+
+class ObjectDiscoveryTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    void createProbe() override
+    {
+        qputenv("GAMMARAY_IncrementalObjectDiscovery", "true");
+        qputenv("GAMMARAY_ObjectDiscoveryTimeSlice", "1");
+        Paths::setRelativeRootPath(GAMMARAY_INVERSE_BIN_DIR);
+        qputenv("GAMMARAY_ProbePath", Paths::probePath(GAMMARAY_PROBE_ABI).toUtf8());
+        qputenv("GAMMARAY_ServerAddress", GAMMARAY_DEFAULT_LOCAL_TCP_URL);
+        Hooks::installHooks();
+        Probe::startupHookReceived();
+        new ProbeCreator(ProbeCreator::Create | ProbeCreator::FindExistingObjects);
+        QTest::qWait(1); // event loop re-entry
+    }
+
+    static bool isTracked(QObject *obj)
+    {
+        QMutexLocker lock(Probe::objectLock());
+        return Probe::instance()->isValidObject(obj);
+    }
+
+private slots:
+    void testChildOfUndiscoveredParent()
+    {
+        // existing before the probe, enough to keep the discovery busy for a while
+        std::vector<std::unique_ptr<QObject>> objects;
+        for (int i = 0; i < 50000; ++i)
+            objects.emplace_back(new QObject(QCoreApplication::instance()));
+        // discovered last, as the last child of the application
+        std::unique_ptr<QObject> parent(new QObject(QCoreApplication::instance()));
+        auto existingChild = new QObject(parent.get());
+        auto existingGrandChild = new QObject(existingChild);
+
+        createProbe();
+        auto controller = ObjectBroker::object<ProbeControllerInterface *>();
+        QVERIFY(controller);
+        QVERIFY(controller->objectDiscoveryRunning());
+        QVERIFY(!isTracked(parent.get()));
+
+        // tracks the parent along with it, before the discovery reaches it
+        auto newChild = new QObject(parent.get());
+        QTRY_VERIFY(isTracked(newChild));
+        QVERIFY(isTracked(parent.get()));
+
+        QTRY_VERIFY_WITH_TIMEOUT(!controller->objectDiscoveryRunning(), 30000);
+        QVERIFY(isTracked(existingChild));
+        QVERIFY(isTracked(existingGrandChild));
+        QVERIFY(isTracked(objects.back().get()));
+    }
+};
+
+QTEST_MAIN(ObjectDiscoveryTest)
+
+#include "objectdiscoverytest.moc"
@@ -0,0 +1,115 @@
+/*
+  objectsettest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "core/objectset.h"
+
+#include <QObject>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QTest>
+
+using namespace GammaRay;
+
+class ObjectSetTest : public QObject
+{
+    Q_OBJECT
+private:
+    static const QObject *fakeObject(quint32 i)
+    {
+        return reinterpret_cast<const QObject *>(quintptr(i + 1) * 16);
+    }
+
+private slots:
+    static void testEmpty()
+    {
+        ObjectSet set;
+        QVERIFY(set.isEmpty());
+        QCOMPARE(set.size(), 0);
+        QCOMPARE(set.capacity(), 0);
+        QVERIFY(!set.contains(fakeObject(0)));
+        QVERIFY(!set.remove(fakeObject(0)));
+    }
+
+    static void testInsertRemove()
+    {
+        ObjectSet set;
+        QVERIFY(set.insert(fakeObject(1)));
+        QVERIFY(!set.insert(fakeObject(1)));
+        QVERIFY(set.contains(fakeObject(1)));
+        QVERIFY(!set.contains(fakeObject(2)));
+        QCOMPARE(set.size(), 1);
+
+        QVERIFY(set.remove(fakeObject(1)));
+        QVERIFY(!set.remove(fakeObject(1)));
+        QVERIFY(!set.contains(fakeObject(1)));
+        QVERIFY(set.isEmpty());
+    }
+
+    static void testNullptr()
+    {
+        ObjectSet set;
+        QVERIFY(!set.contains(nullptr));
+
+        // nullptr marks empty buckets, which are plenty right after inserting one entry
+        set.insert(fakeObject(1));
+        QVERIFY(!set.contains(nullptr));
+        QVERIFY(!set.remove(nullptr));
+        QCOMPARE(set.size(), 1);
+        QVERIFY(set.contains(fakeObject(1)));
+    }
+
+    static void testGrowShrink()
+    {
+        ObjectSet set;
+        for (quint32 i = 0; i < 100000; ++i)
+            set << fakeObject(i);
+        QCOMPARE(set.size(), 100000);
+        QVERIFY(set.capacity() >= 100000);
+        for (quint32 i = 0; i < 100000; ++i)
+            QVERIFY(set.contains(fakeObject(i)));
+
+        for (quint32 i = 0; i < 100000; i += 2)
+            QVERIFY(set.remove(fakeObject(i)));
+        for (quint32 i = 0; i < 100000; ++i)
+            QCOMPARE(set.contains(fakeObject(i)), i % 2 == 1);
+
+        for (quint32 i = 1; i < 100000; i += 2)
+            QVERIFY(set.remove(fakeObject(i)));
+        QVERIFY(set.isEmpty());
+        QVERIFY(set.capacity() < 1000);
+    }
+
+    static void testRandomOperations()
+    {
+        ObjectSet set;
+        QSet<const QObject *> reference;
+        QRandomGenerator rng(42);
+
+        for (int i = 0; i < 200000; ++i) {
+            const auto obj = fakeObject(rng.bounded(5000));
+            if (rng.bounded(3) < 2) {
+                const bool isNew = !reference.contains(obj);
+                reference.insert(obj);
+                QCOMPARE(set.insert(obj), isNew);
+            } else {
+                QCOMPARE(set.remove(obj), reference.remove(obj));
+            }
+            QCOMPARE(set.size(), reference.size());
+        }
+        for (quint32 i = 0; i < 5000; ++i)
+            QCOMPARE(set.contains(fakeObject(i)), reference.contains(fakeObject(i)));
+    }
+};
+
+QTEST_MAIN(ObjectSetTest)
+
+#include "objectsettest.moc"
@@ -0,0 +1,215 @@
+/*
+  objecttreemodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "baseprobetest.h"
+
+#include <common/objectbroker.h>
+#include <common/objectmodel.h>
+
+#include <QAbstractItemModelTester>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+using namespace GammaRay;
+
+class ObjectTreeModelTest : public BaseProbeTest
+{
+    Q_OBJECT
+private:
+    static QAbstractItemModel *objectTreeModel()
+    {
+        return ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.ObjectTree"));
+    }
+
+    static QObject *objectAt(const QModelIndex &index)
+    {
+        return index.data(ObjectModel::ObjectRole).value<QObject *>();
+    }
+
+    static QModelIndex indexOf(QAbstractItemModel *model, QObject *obj)
+    {
+        return model->match(model->index(0, 0), ObjectModel::ObjectRole, QVariant::fromValue(obj), 1,
+                            Qt::MatchExactly | Qt::MatchRecursive)
+            .value(0);
+    }
+
+    static QVector<QObject *> childObjects(QAbstractItemModel *model, QObject *parent)
+    {
+        const auto parentIndex = indexOf(model, parent);
+        if (!parentIndex.isValid())
+            return {};
+        QVector<QObject *> children;
+        for (int row = 0; row < model->rowCount(parentIndex); ++row)
+            children.push_back(objectAt(model->index(row, 0, parentIndex)));
+        return children;
+    }
+
+private slots:
+    void testAddRemove()
+    {
+        createProbe();
+        auto model = objectTreeModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        std::unique_ptr<QObject> root(new QObject);
+        QVector<QObject *> children;
+        for (int i = 0; i < 5; ++i)
+            children.push_back(new QObject(root.get()));
+        auto grandChild = new QObject(children.at(3));
+        QTest::qWait(1); // event loop re-entry
+
+        const QPersistentModelIndex rootIndex = indexOf(model, root.get());
+        QVERIFY(rootIndex.isValid());
+        QCOMPARE(childObjects(model, root.get()), children);
+        QCOMPARE(childObjects(model, children.at(3)), QVector<QObject *>({ grandChild }));
+        const QPersistentModelIndex grandChildIndex = indexOf(model, grandChild);
+        QVERIFY(grandChildIndex.isValid());
+
+        delete children.takeFirst();
+        QTest::qWait(1);
+        QCOMPARE(childObjects(model, root.get()), children);
+        // the rows of the remaining siblings are renumbered lazily
+        QCOMPARE(grandChildIndex.parent().row(), 2);
+        QCOMPARE(objectAt(grandChildIndex.parent()), children.at(2));
+
+        // along with everything below it
+        root.reset();
+        QTest::qWait(1);
+        QVERIFY(!rootIndex.isValid());
+        QVERIFY(!grandChildIndex.isValid());
+    }
+
+    void testReparent()
+    {
+        createProbe();
+        auto model = objectTreeModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        std::unique_ptr<QObject> root1(new QObject);
+        std::unique_ptr<QObject> root2(new QObject);
+        auto child = new QObject(root1.get());
+        auto sibling = new QObject(root1.get());
+        auto grandChild = new QObject(child);
+        QTest::qWait(1); // event loop re-entry
+        QCOMPARE(childObjects(model, root1.get()), QVector<QObject *>({ child, sibling }));
+
+        child->setParent(root2.get());
+        QTRY_COMPARE(childObjects(model, root2.get()), QVector<QObject *>({ child }));
+        QCOMPARE(childObjects(model, root1.get()), QVector<QObject *>({ sibling }));
+        QCOMPARE(indexOf(model, child).parent(), indexOf(model, root2.get()));
+        QCOMPARE(childObjects(model, child), QVector<QObject *>({ grandChild }));
+
+        std::unique_ptr<QObject> topLevel(child);
+        topLevel->setParent(nullptr);
+        QTRY_VERIFY(childObjects(model, root2.get()).isEmpty());
+        const auto topLevelIndex = indexOf(model, topLevel.get());
+        QVERIFY(topLevelIndex.isValid());
+        QVERIFY(!topLevelIndex.parent().isValid());
+        QCOMPARE(childObjects(model, topLevel.get()), QVector<QObject *>({ grandChild }));
+    }
+
+    void testNodeReuse()
+    {
+        createProbe();
+        auto model = objectTreeModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        std::unique_ptr<QObject> root1(new QObject);
+        std::unique_ptr<QObject> root2(new QObject);
+        auto removed = new QObject(root1.get());
+        for (int i = 0; i < 10; ++i)
+            new QObject(removed);
+        QTest::qWait(1); // event loop re-entry
+
+        QSet<quintptr> freedNodes = { indexOf(model, removed).internalId() };
+        for (QObject *obj : removed->children())
+            freedNodes.insert(indexOf(model, obj).internalId());
+        delete removed;
+        QTest::qWait(1);
+        QVERIFY(childObjects(model, root1.get()).isEmpty());
+
+        // freed nodes are reused, without anything left over from the objects they were used for
+        QVector<QObject *> children;
+        for (int i = 0; i < 5; ++i)
+            children.push_back(new QObject(root2.get()));
+        QTest::qWait(1);
+        QCOMPARE(childObjects(model, root2.get()), children);
+        QVERIFY(std::any_of(children.cbegin(), children.cend(), [model, &freedNodes](QObject *obj) {
+            return freedNodes.contains(indexOf(model, obj).internalId());
+        }));
+        for (QObject *obj : std::as_const(children)) {
+            const auto index = indexOf(model, obj);
+            QCOMPARE(model->rowCount(index), 0);
+            QCOMPARE(objectAt(index.parent()), root2.get());
+        }
+        QVERIFY(childObjects(model, root1.get()).isEmpty());
+    }
+
+    void testBatchedRemoval()
+    {
+        createProbe();
+        auto model = objectTreeModel();
+        QVERIFY(model);
+        QAbstractItemModelTester modelTest(model);
+
+        // destructions in other threads reach the model in one batch per event loop iteration
+        QThread thread;
+        QObject context;
+        context.moveToThread(&thread);
+        thread.start();
+        const auto runInThread = [&context](const std::function<void()> &func) {
+            QMetaObject::invokeMethod(&context, func, Qt::BlockingQueuedConnection);
+        };
+
+        QObject *root = nullptr;
+        QVector<QObject *> children;
+        runInThread([&root, &children]() {
+            root = new QObject;
+            for (int i = 0; i < 10; ++i)
+                children.push_back(new QObject(root));
+            new QObject(children.at(7));
+        });
+        QTRY_COMPARE(childObjects(model, root), children);
+        QCOMPARE(childObjects(model, children.at(7)).size(), 1);
+        const QPersistentModelIndex rootIndex = indexOf(model, root);
+
+        // a contiguous range, single rows and a subtree, not in row order
+        const QVector<QObject *> removed = { children.at(9), children.at(2), children.at(7), children.at(3),
+                                             children.at(4), children.at(0) };
+        runInThread([&removed]() {
+            qDeleteAll(removed);
+        });
+        const QVector<QObject *> remaining = { children.at(1), children.at(5), children.at(6), children.at(8) };
+        QTRY_COMPARE(childObjects(model, root), remaining);
+        for (int row = 0; row < remaining.size(); ++row)
+            QCOMPARE(indexOf(model, remaining.at(row)).row(), row);
+
+        runInThread([root]() {
+            delete root;
+        });
+        QTRY_VERIFY(!rootIndex.isValid());
+
+        thread.quit();
+        QVERIFY(thread.wait());
+    }
+};
+
+QTEST_MAIN(ObjectTreeModelTest)
+
+#include "objecttreemodeltest.moc"
@@ -0,0 +1,176 @@
+/*
+  quickscenegraphmodeltest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "basequicktest.h"
+
+#include <plugins/quickinspector/quickscenegraphmodel.h>
+
+#include <QAbstractItemModelTester>
+#include <QDebug>
+#include <QMap>
+#include <QQuickItem>
+#include <QSGNode>
+
+#include <algorithm>
+#include <memory>
+
+using namespace GammaRay;
+
+class QuickSceneGraphModelTest : public BaseQuickTest
+{
+    Q_OBJECT
+protected:
+    bool ignoreNonExposedView() const override
+    {
+        return true;
+    }
+
+private:
+    // the children of every node, in row order
+    using Tree = QMap<QSGNode *, QVector<QSGNode *>>;
+
+    static void collectRows(const QAbstractItemModel *model, const QModelIndex &parent, Tree &tree)
+    {
+        QVector<QSGNode *> children;
+        for (int row = 0; row < model->rowCount(parent); ++row) {
+            const auto index = model->index(row, 0, parent);
+            children.push_back(static_cast<QSGNode *>(index.internalPointer()));
+            collectRows(model, index, tree);
+        }
+        tree.insert(static_cast<QSGNode *>(parent.internalPointer()), children);
+    }
+
+    static Tree rowsOf(const QAbstractItemModel *model)
+    {
+        Tree tree;
+        collectRows(model, QModelIndex(), tree);
+        return tree;
+    }
+
+    QQuickItem *item(const char *name) const
+    {
+        return view()->rootObject()->findChild<QQuickItem *>(QString::fromLatin1(name));
+    }
+
+    Tree rebuiltRows() const
+    {
+        QuickSceneGraphModel rebuilt;
+        rebuilt.setWindow(view());
+        return rowsOf(&rebuilt);
+    }
+
+    // applies the changes of the next frame to m_model, and compares it to a model built from scratch
+    bool matchesRebuild()
+    {
+        QSignalSpy renderSpy(view(), &QQuickWindow::frameSwapped);
+        view()->update();
+        if (!renderSpy.wait())
+            return false;
+
+        // creating items can take another frame, the incremental update picks that up as well
+        Tree rows;
+        Tree expected;
+        QTest::qWaitFor([&]() {
+            m_model->updatePendingChanges();
+            rows = rowsOf(m_model.get());
+            expected = rebuiltRows();
+            return rows == expected;
+        });
+        if (rows != expected) {
+            qWarning() << "incremental:" << rows;
+            qWarning() << "rebuilt:" << expected;
+            return false;
+        }
+
+        QuickSceneGraphModel rebuilt;
+        rebuilt.setWindow(view());
+        const auto items = view()->contentItem()->findChildren<QQuickItem *>();
+        return std::all_of(items.cbegin(), items.cend(), [this, &rebuilt](QQuickItem *item) {
+            return m_model->sgNodeForItem(item) == rebuilt.sgNodeForItem(item)
+                && m_model->itemForSgNode(m_model->sgNodeForItem(item)) == rebuilt.itemForSgNode(rebuilt.sgNodeForItem(item));
+        });
+    }
+
+private slots:
+    void init() override
+    {
+        BaseQuickTest::init();
+
+        QVERIFY(showSource(QStringLiteral("qrc:/manual/scenegraphdifftest.qml")));
+        if (!isViewExposed())
+            QSKIP("the scene graph is only populated when rendering");
+
+        m_model.reset(new QuickSceneGraphModel);
+        m_model->setWindow(view());
+        new QAbstractItemModelTester(m_model.get(), m_model.get());
+        QVERIFY(m_model->rowCount() > 0);
+    }
+
+    void cleanup() override
+    {
+        m_model.reset();
+        BaseQuickTest::cleanup();
+    }
+
+    void testChange()
+    {
+        // an opacity node is inserted above the item's subtree, and removed again
+        item("left")->setOpacity(0.5);
+        QVERIFY(matchesRebuild());
+        item("left")->setOpacity(1.0);
+        QVERIFY(matchesRebuild());
+
+        // hidden items are taken out of the scene graph
+        item("right")->setVisible(false);
+        QVERIFY(matchesRebuild());
+        item("right")->setVisible(true);
+        QVERIFY(matchesRebuild());
+
+        item("moving")->setClip(true);
+        QVERIFY(matchesRebuild());
+    }
+
+    void testAddRemove()
+    {
+        view()->rootObject()->setProperty("count", 10);
+        QVERIFY(matchesRebuild());
+        view()->rootObject()->setProperty("count", 1);
+        QVERIFY(matchesRebuild());
+
+        auto newItem = new QQuickItem(item("moving"));
+        newItem->setOpacity(0.5);
+        QVERIFY(matchesRebuild());
+        delete newItem;
+        QVERIFY(matchesRebuild());
+    }
+
+    void testReparent()
+    {
+        item("moving")->setParentItem(item("right"));
+        QVERIFY(matchesRebuild());
+        item("moving")->setParentItem(item("left"));
+        QVERIFY(matchesRebuild());
+
+        // all of it within the same frame
+        item("moving")->setParentItem(item("right"));
+        item("left")->setOpacity(0.5);
+        view()->rootObject()->setProperty("count", 5);
+        QVERIFY(matchesRebuild());
+    }
+
+private:
+    std::unique_ptr<QuickSceneGraphModel> m_model;
+};
+
+QTEST_MAIN(QuickSceneGraphModelTest)
+
+#include "quickscenegraphmodeltest.moc"
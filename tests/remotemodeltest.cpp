@@ -314,6 +314,316 @@ private slots:
         // QEXPECT_FAIL("", "QSFPM misbehavior, no idea yet where this is coming from", Continue);
         QCOMPARE(proxy.rowCount(pi1), 2);
     }
+
+    void testCacheEviction()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.CacheEviction"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.CacheEviction"), this);
+        client.setCacheCapacity(10);
+        client.setPrefetchRows(0);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 100);
+        for (int row = 0; row < 30; ++row) {
+            QVERIFY(waitForData(client.index(row, 0)));
+            if (row > 1)
+                client.index(1, 0).data(); // keeps row 1 in use
+        }
+
+        const auto stateOf = [&client](int row) {
+            return client.index(row, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        };
+        int cachedRows = 0;
+        for (int row = 0; row < 100; ++row) {
+            if (stateOf(row) == RemoteModelNodeState::NoState)
+                ++cachedRows;
+        }
+        QVERIFY(cachedRows >= 10);
+        QVERIFY(cachedRows <= 10 + 10 / 4);
+        QCOMPARE(stateOf(29), RemoteModelNodeState::NoState);
+        QCOMPARE(stateOf(1), RemoteModelNodeState::NoState);
+        QVERIFY(stateOf(0) & RemoteModelNodeState::Outdated);
+
+        // evicted rows are fetched again on demand
+        const auto index = client.index(0, 0);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("entry0"));
+    }
+
+    void testPrefetch()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int i = 0; i < 100; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.Prefetch"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.Prefetch"), this);
+        client.setCacheCapacity(0);
+        client.setPrefetchRows(5);
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        const auto stateOf = [&client](int row) {
+            return client.index(row, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        };
+        const auto requestRows = [&client](int first, int last) {
+            for (int row = first; row <= last; ++row)
+                client.index(row, 0).data();
+        };
+
+        QTRY_COMPARE(client.rowCount(), 100);
+        requestRows(10, 12);
+        QTRY_COMPARE(stateOf(12), RemoteModelNodeState::NoState);
+        QVERIFY(stateOf(13) & RemoteModelNodeState::Empty);
+
+        // scrolling down
+        requestRows(13, 15);
+        QTRY_COMPARE(stateOf(20), RemoteModelNodeState::NoState);
+        QVERIFY(stateOf(21) & RemoteModelNodeState::Empty);
+
+        // scrolling up
+        requestRows(7, 9);
+        QTRY_COMPARE(stateOf(2), RemoteModelNodeState::NoState);
+        QVERIFY(stateOf(1) & RemoteModelNodeState::Empty);
+    }
+
+    void testRequestedRoles()
+    {
+        QScopedPointer<QStandardItemModel> tableModel(new QStandardItemModel(this));
+        for (int row = 0; row < 10; ++row) {
+            QList<QStandardItem *> items;
+            for (int column = 0; column < 3; ++column) {
+                auto item = new QStandardItem(QStringLiteral("%1/%2").arg(row).arg(column));
+                item->setToolTip(QStringLiteral("tooltip"));
+                item->setData(row, Qt::UserRole);
+                items.push_back(item);
+            }
+            tableModel->appendRow(items);
+        }
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.RequestedRoles"), this);
+        server.setModel(tableModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.RequestedRoles"), this);
+        QVERIFY(client.setProperty("requestedRoles", QVariant::fromValue(QVector<QVector<int>> { { Qt::DisplayRole, Qt::UserRole }, { Qt::DisplayRole } })));
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 10);
+        auto index = client.index(2, 0);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("2/0"));
+        QCOMPARE(index.data(Qt::UserRole).toInt(), 2);
+        QVERIFY(!index.data(Qt::ToolTipRole).isValid());
+        QVERIFY(index.flags() & Qt::ItemIsEnabled);
+
+        // columns beyond the last entry use the last entry
+        index = client.index(2, 2);
+        QVERIFY(waitForData(index));
+        QCOMPARE(index.data().toString(), QStringLiteral("2/2"));
+        QVERIFY(!index.data(Qt::UserRole).isValid());
+
+        // narrowing down keeps the cache
+        client.setRequestedRoles({ { Qt::DisplayRole } });
+        QCOMPARE(client.index(2, 0).data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>(), RemoteModelNodeState::NoState);
+
+        // widening triggers a refetch, empty requests all roles
+        client.setRequestedRoles({});
+        index = client.index(2, 1);
+        QVERIFY(index.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>() & RemoteModelNodeState::Outdated);
+        index.data();
+        QTRY_COMPARE(index.data(Qt::ToolTipRole).toString(), QStringLiteral("tooltip"));
+    }
+
+    void testRequestedRolesWhileLoading()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int row = 0; row < 10; ++row) {
+            auto item = new QStandardItem(QStringLiteral("entry%1").arg(row));
+            item->setToolTip(QStringLiteral("tooltip"));
+            listModel->appendRow(item);
+        }
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.RequestedRolesWhileLoading"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.RequestedRolesWhileLoading"), this);
+        client.setRequestedRoles({ { Qt::DisplayRole } });
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 10);
+        const auto index = client.index(3, 0);
+        const auto stateOf = [&index]() {
+            return index.data(RemoteModelRole::LoadingState).value<RemoteModelNodeState::NodeStates>();
+        };
+
+        // widen the roles after the request has been sent, but before its reply arrives
+        QSignalSpy dataChangedSpy(&client, &QAbstractItemModel::dataChanged);
+        bool widened = false;
+        auto conn = connect(&client, &FakeRemoteModel::message, this, [&](const Message &msg) {
+            if (widened || msg.type() != Protocol::ModelContentRequest)
+                return;
+            client.setRequestedRoles({});
+            widened = true;
+        });
+        index.data();
+        QTRY_VERIFY(widened);
+        disconnect(conn);
+        QVERIFY(dataChangedSpy.size() >= 1);
+        QCOMPARE(dataChangedSpy.at(0).at(0).toModelIndex(), client.index(0, 0));
+        QCOMPARE(dataChangedSpy.at(0).at(1).toModelIndex(), client.index(9, 0));
+
+        // the reply lacks the new roles, so the cell stays outdated and is fetched again
+        QTRY_VERIFY((stateOf() & RemoteModelNodeState::Loading) == 0);
+        QCOMPARE(index.data().toString(), QStringLiteral("entry3"));
+        QVERIFY(stateOf() & RemoteModelNodeState::Outdated);
+        QTRY_COMPARE(index.data(Qt::ToolTipRole).toString(), QStringLiteral("tooltip"));
+        QCOMPARE(stateOf(), RemoteModelNodeState::NoState);
+    }
+
+    static void testRelativeModelIndexEncoding()
+    {
+        const QVector<Protocol::ModelIndex> indexes = {
+            {},
+            { Protocol::ModelIndexData(1, 0) },
+            { Protocol::ModelIndexData(1, 0), Protocol::ModelIndexData(2, 0) },
+            { Protocol::ModelIndexData(1, 0), Protocol::ModelIndexData(2, 1) },
+            { Protocol::ModelIndexData(1, 0), Protocol::ModelIndexData(2, 1) },
+            { Protocol::ModelIndexData(1, 0), Protocol::ModelIndexData(2, 1), Protocol::ModelIndexData(0, 0) },
+            { Protocol::ModelIndexData(3, 0) },
+            {},
+        };
+
+        QByteArray ba;
+        {
+            QDataStream stream(&ba, QIODevice::WriteOnly);
+            Protocol::ModelIndexEncoder encoder;
+            for (const auto &index : indexes)
+                stream << encoder.encode(index);
+        }
+
+        QDataStream stream(ba);
+        Protocol::ModelIndexDecoder decoder;
+        for (const auto &index : indexes) {
+            Protocol::RelativeModelIndex relativeIndex;
+            stream >> relativeIndex;
+            QVERIFY(decoder.decode(relativeIndex) == index);
+        }
+        QVERIFY(stream.atEnd());
+    }
+
+    static void benchmarkModelIndexEncoding_data()
+    {
+        QTest::addColumn<int>("depth");
+        QTest::addColumn<bool>("relative");
+        for (int depth : { 1, 4, 16 }) {
+            QTest::addRow("depth %d, absolute", depth) << depth << false;
+            QTest::addRow("depth %d, relative", depth) << depth << true;
+        }
+    }
+
+    static void benchmarkModelIndexEncoding()
+    {
+        QFETCH(int, depth);
+        QFETCH(bool, relative);
+
+        // one content request batch for the visible part of a view, 50 rows x 4 columns below the same parent
+        Protocol::ModelIndex parent;
+        for (int i = 1; i < depth; ++i)
+            parent.push_back(Protocol::ModelIndexData(i % 3, 0));
+        QVector<Protocol::ModelIndex> indexes;
+        for (int row = 0; row < 50; ++row) {
+            for (int column = 0; column < 4; ++column)
+                indexes.push_back(parent + Protocol::ModelIndex { Protocol::ModelIndexData(row, column) });
+        }
+
+        QByteArray ba;
+        QBENCHMARK {
+            ba.clear();
+            QDataStream stream(&ba, QIODevice::WriteOnly);
+            stream << quint32(indexes.size());
+            Protocol::ModelIndexEncoder encoder;
+            for (const auto &index : std::as_const(indexes)) {
+                if (relative)
+                    stream << encoder.encode(index);
+                else
+                    stream << index;
+            }
+        }
+        qDebug() << "bytes per fetched cell:" << double(ba.size()) / indexes.size();
+    }
+
+    void testDataChangedCoalescing()
+    {
+        QScopedPointer<QStandardItemModel> listModel(new QStandardItemModel(this));
+        for (int i = 0; i < 4; ++i)
+            listModel->appendRow(new QStandardItem(QStringLiteral("entry%1").arg(i)));
+
+        FakeRemoteModelServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.DataChanged"), this);
+        server.setModel(listModel.data());
+        server.modelMonitored(true);
+
+        FakeRemoteModel client(QStringLiteral("com.kdab.GammaRay.UnitTest.DataChanged"), this);
+        int changeMessages = 0;
+        connect(&server, &FakeRemoteModelServer::message, this, [&changeMessages](const Message &msg) {
+            if (msg.type() == Protocol::ModelContentChanged)
+                ++changeMessages;
+        });
+        connect(&server, &FakeRemoteModelServer::message, &client,
+                &RemoteModel::newMessage);
+        connect(&client, &FakeRemoteModel::message, &server,
+                &RemoteModelServer::newRequest);
+
+        QTRY_COMPARE(client.rowCount(), 4);
+        const auto i1 = client.index(1, 0);
+        const auto i2 = client.index(2, 0);
+        QVERIFY(waitForData(i1));
+        QVERIFY(waitForData(i2));
+
+        // rows 1 and 2 are merged into one range, rows 0 and 3 have never been fetched
+        listModel->item(1)->setText(QStringLiteral("changed1"));
+        listModel->item(2)->setText(QStringLiteral("changed2"));
+        listModel->item(1)->setText(QStringLiteral("changed1b"));
+        listModel->item(0)->setText(QStringLiteral("changed0"));
+        listModel->item(3)->setText(QStringLiteral("changed3"));
+        QTRY_COMPARE(changeMessages, 1);
+        QTest::qWait(50);
+        QCOMPARE(changeMessages, 1);
+        QTRY_COMPARE(i1.data().toString(), QStringLiteral("changed1b"));
+        QTRY_COMPARE(i2.data().toString(), QStringLiteral("changed2"));
+
+        // the fetched rows follow structural changes
+        listModel->insertRow(0, new QStandardItem(QStringLiteral("entry")));
+        QTRY_COMPARE(client.rowCount(), 5);
+        listModel->item(1)->setText(QStringLiteral("changed0b"));
+        QTest::qWait(50);
+        QCOMPARE(changeMessages, 1);
+        listModel->item(2)->setText(QStringLiteral("changed1c"));
+        QTRY_COMPARE(changeMessages, 2);
+        QTRY_COMPARE(client.index(2, 0).data().toString(), QStringLiteral("changed1c"));
+    }
 };
 
 QTEST_MAIN(RemoteModelTest)
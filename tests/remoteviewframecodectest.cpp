@@ -0,0 +1,164 @@
+/*
+  remoteviewframecodectest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <common/remoteviewframe.h>
+#include <common/remoteviewframecodec.h>
+
+#include <QBuffer>
+#include <QObject>
+#include <QPainter>
+#include <QTest>
+
+using namespace GammaRay;
+
+class RemoteViewFrameCodecTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QImage createImage(const QSize &size)
+    {
+        QImage img(size, QImage::Format_ARGB32_Premultiplied);
+        QPainter p(&img);
+        QLinearGradient gradient(0, 0, size.width(), size.height());
+        gradient.setColorAt(0, Qt::red);
+        gradient.setColorAt(1, Qt::blue);
+        p.fillRect(img.rect(), gradient);
+        return img;
+    }
+
+private slots:
+    void testDelta()
+    {
+        RemoteViewFrameEncoder encoder;
+        RemoteViewFrameDecoder decoder;
+
+        auto img = createImage(QSize(300, 200));
+        const auto keyFrame = encoder.encode(img);
+        QVERIFY(!keyFrame.isEmpty());
+        QCOMPARE(decoder.decode(keyFrame), img);
+
+        // nothing changed
+        const auto emptyFrame = encoder.encode(img);
+        QVERIFY(emptyFrame.size() < 64);
+        QCOMPARE(decoder.decode(emptyFrame), img);
+
+        // a small change only transfers the affected tile
+        {
+            QPainter p(&img);
+            p.fillRect(QRect(260, 150, 30, 30), Qt::green);
+        }
+        const auto deltaFrame = encoder.encode(img);
+        QVERIFY(deltaFrame.size() < keyFrame.size() / 4);
+        QCOMPARE(decoder.decode(deltaFrame), img);
+
+        // size changes result in a key frame
+        img = createImage(QSize(100, 100));
+        QCOMPARE(decoder.decode(encoder.encode(img)), img);
+    }
+
+    void testMissedFrame()
+    {
+        RemoteViewFrameEncoder encoder;
+        RemoteViewFrameDecoder decoder;
+
+        auto img = createImage(QSize(128, 128));
+        QVERIFY(!decoder.decode(encoder.encode(img)).isNull());
+        img.setPixel(0, 0, qRgb(0, 255, 0));
+        encoder.encode(img); // lost
+        img.setPixel(1, 1, qRgb(0, 255, 0));
+        QVERIFY(decoder.decode(encoder.encode(img)).isNull());
+
+        encoder.reset();
+        QCOMPARE(decoder.decode(encoder.encode(img)), img);
+
+        QVERIFY(decoder.decode(QByteArray("garbage")).isNull());
+    }
+
+    void testUnsupportedFormat()
+    {
+        RemoteViewFrameEncoder encoder;
+        QImage img(32, 32, QImage::Format_Mono);
+        QVERIFY(encoder.encode(img).isEmpty());
+
+        // frames fall back to sending the image as is
+        RemoteViewFrame frame;
+        frame.setImage(img);
+        frame.encodeImage(&encoder);
+        QVERIFY(!frame.isEncoded());
+        QVERIFY(frame.isValid());
+    }
+
+    void testFrameSerialization()
+    {
+        RemoteViewFrameEncoder encoder;
+        RemoteViewFrameDecoder decoder;
+
+        const auto img = createImage(QSize(200, 100));
+        RemoteViewFrame frame;
+        frame.setImage(img, QTransform::fromTranslate(10, 20));
+        frame.encodeImage(&encoder);
+        QVERIFY(frame.isEncoded());
+        QVERIFY(!frame.isValid());
+
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        QDataStream stream(&buffer);
+        stream << frame;
+        buffer.seek(0);
+        RemoteViewFrame received;
+        stream >> received;
+
+        QVERIFY(received.isEncoded());
+        QVERIFY(received.decodeImage(&decoder));
+        QVERIFY(!received.isEncoded());
+        QCOMPARE(received.image(), img);
+        QCOMPARE(received.transform(), QTransform::fromTranslate(10, 20));
+    }
+
+    void testDownscale()
+    {
+        QImage img(5, 3, QImage::Format_ARGB32_Premultiplied);
+        img.fill(qRgb(0, 0, 0));
+        img.setPixel(0, 0, qRgb(200, 100, 40));
+        img.setPixel(1, 1, qRgb(200, 100, 40));
+        img.setPixel(4, 2, qRgb(10, 20, 30));
+        img.setDevicePixelRatio(2.0);
+
+        RemoteViewFrame frame;
+        frame.setImage(img, QTransform::fromTranslate(10, 20));
+        frame.downscaleImage(2);
+        const auto scaled = frame.image();
+        QCOMPARE(scaled.size(), QSize(3, 2));
+        QCOMPARE(scaled.devicePixelRatio(), 1.0);
+        QCOMPARE(scaled.format(), img.format());
+        QCOMPARE(frame.transform(), QTransform::fromTranslate(10, 20));
+
+        QCOMPARE(scaled.pixel(0, 0), qRgb(100, 50, 20));
+        QCOMPARE(scaled.pixel(1, 0), qRgb(0, 0, 0));
+        QCOMPARE(scaled.pixel(2, 1), qRgb(10, 20, 30)); // partial block at the corner
+
+        // non byte-channel formats take the generic path
+        QImage gray(8, 8, QImage::Format_Grayscale8);
+        gray.fill(128);
+        frame.setImage(gray);
+        frame.downscaleImage(4);
+        QCOMPARE(frame.image().size(), QSize(2, 2));
+        QCOMPARE(qGray(frame.image().pixel(1, 1)), 128);
+
+        frame.downscaleImage(1);
+        QCOMPARE(frame.image().size(), QSize(2, 2));
+    }
+};
+
+QTEST_MAIN(RemoteViewFrameCodecTest)
+
+#include "remoteviewframecodectest.moc"
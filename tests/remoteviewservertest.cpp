@@ -0,0 +1,126 @@
+/*
+  remoteviewservertest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include <core/remote/server.h>
+#include <core/remoteviewserver.h>
+
+#include <common/remoteviewframe.h>
+#include <common/remoteviewframecodec.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QLocalSocket>
+#include <QObject>
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace GammaRay;
+
+class RemoteViewServerTest : public QObject
+{
+    Q_OBJECT
+private:
+    static RemoteViewFrame createFrame(const QSize &size)
+    {
+        QImage img(size, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::red);
+        RemoteViewFrame frame;
+        frame.setImage(img);
+        frame.setViewRect(QRectF(QPointF(), size));
+        frame.setSceneRect(QRectF(QPointF(), size));
+        return frame;
+    }
+
+    static QImage lastImage(const QSignalSpy &spy)
+    {
+        return spy.last().at(0).value<RemoteViewFrame>().image();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        // downscaling only happens for remote clients
+        const auto socketPath = QDir::temp().filePath(QStringLiteral("gammaray-remoteviewservertest-%1").arg(QCoreApplication::applicationPid()));
+        qputenv("GAMMARAY_ServerAddress", "local://" + socketPath.toUtf8());
+        auto server = new Server(this);
+        QVERIFY(server->listen());
+
+        m_socket = new QLocalSocket(this);
+        m_socket->connectToServer(socketPath);
+        QTRY_VERIFY(Endpoint::isConnected());
+    }
+
+    void testCompleteFrame()
+    {
+        RemoteViewServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.RemoteView"));
+        QSignalSpy frameSpy(&server, &RemoteViewInterface::frameUpdated);
+        QVERIFY(frameSpy.isValid());
+        QVERIFY(QMetaObject::invokeMethod(&server, "setViewActive", Q_ARG(bool, true)));
+        QVERIFY(QMetaObject::invokeMethod(&server, "sendUserScale", Q_ARG(double, 0.5)));
+
+        // not evenly divisible, so a downscaled frame can't be mistaken for a complete one
+        const auto frame = createFrame(QSize(101, 51));
+        server.sendFrame(frame);
+        QCOMPARE(frameSpy.size(), 1);
+        QCOMPARE(lastImage(frameSpy).size(), QSize(51, 26));
+
+        server.requestCompleteFrame();
+        server.sendFrame(frame);
+        QCOMPARE(frameSpy.size(), 2);
+        const auto completeImage = lastImage(frameSpy);
+        QCOMPARE(completeImage.size(), QSize(101, 51));
+        QCOMPARE(completeImage.devicePixelRatio(), 1.0);
+
+        // back to the client's zoom level afterwards
+        server.sendFrame(frame);
+        QCOMPARE(frameSpy.size(), 3);
+        QCOMPARE(lastImage(frameSpy).size(), QSize(51, 26));
+    }
+
+    void testKeyFrameRequest()
+    {
+        RemoteViewServer server(QStringLiteral("com.kdab.GammaRay.UnitTest.RemoteViewKeyFrame"));
+        QSignalSpy frameSpy(&server, &RemoteViewInterface::frameUpdated);
+        QSignalSpy updateSpy(&server, &RemoteViewServer::requestUpdate);
+        server.setGrabberReady(true);
+        server.setFrameCodec(RemoteViewInterface::TileDeltaFrames);
+        QVERIFY(QMetaObject::invokeMethod(&server, "setViewActive", Q_ARG(bool, true)));
+        QTRY_COMPARE(updateSpy.size(), 1);
+
+        const auto frame = createFrame(QSize(64, 64));
+        server.sendFrame(frame);
+        server.sendFrame(frame);
+        QCOMPARE(frameSpy.size(), 2);
+
+        // relative to the first one, which we pretend to have missed
+        RemoteViewFrameDecoder decoder;
+        auto deltaFrame = frameSpy.last().at(0).value<RemoteViewFrame>();
+        QVERIFY(deltaFrame.isEncoded());
+        QVERIFY(!deltaFrame.decodeImage(&decoder));
+
+        // the scene is static, so nothing else would trigger the next frame
+        server.requestKeyFrame();
+        QTRY_COMPARE(updateSpy.size(), 2);
+        server.sendFrame(frame);
+        QCOMPARE(frameSpy.size(), 3);
+        auto keyFrame = frameSpy.last().at(0).value<RemoteViewFrame>();
+        QVERIFY(keyFrame.decodeImage(&decoder));
+        QCOMPARE(keyFrame.image().size(), QSize(64, 64));
+    }
+
+private:
+    QLocalSocket *m_socket = nullptr;
+};
+
+QTEST_MAIN(RemoteViewServerTest)
+
+#include "remoteviewservertest.moc"
@@ -0,0 +1,133 @@
+/*
+  signalprofilertest.cpp
+
+  This file is part of GammaRay, the Qt application inspection and manipulation tool.
+
+  SPDX-FileCopyrightText: 2026 Klarälvdalens Datakonsult AB, a KDAB Group company <info@kdab.com>
+
+  SPDX-License-Identifier: GPL-2.0-or-later
+
+  Contact KDAB at <info@kdab.com> for commercial licensing options.
+*/
+
+#include "baseprobetest.h"
+#include "testhelpers.h"
+
+#include <plugins/signalmonitor/signalprofilermodel.h>
+
+#include <common/modelevent.h>
+
+#include <QAbstractItemModelTester>
+#include <QThread>
+#include <private/qmetaobjectbuilder_p.h>
+
+#include <cstdlib>
+#include <memory>
+
+using namespace GammaRay;
+using namespace TestHelpers;
+
+class Pinger : public QObject
+{
+    Q_OBJECT
+public:
+    void ping(int count)
+    {
+        for (int i = 0; i < count; ++i)
+            emit pinged();
+    }
+
+signals:
+    void pinged();
+};
+
+// stands in for QML types, which have a dynamic meta object per type
+class DynamicPinger : public Pinger
+{
+public:
+    explicit DynamicPinger(const QMetaObject *metaObject)
+        : m_metaObject(metaObject)
+    {
+    }
+
+    const QMetaObject *metaObject() const override
+    {
+        return m_metaObject;
+    }
+
+private:
+    const QMetaObject *m_metaObject;
+};
+
+class SignalProfilerTest : public BaseProbeTest
+{
+    Q_OBJECT
+private slots:
+    void testCounting()
+    {
+        createProbe();
+
+        SignalProfilerModel model(Probe::instance());
+        QAbstractItemModelTester modelTest(&model);
+        Pinger pinger;
+
+        // not counted while nobody uses the model
+        pinger.ping(3);
+        model.aggregate();
+        QVERIFY(!searchFixedIndex(&model, "Pinger").isValid());
+
+        Model::used(&model);
+        pinger.ping(10);
+        std::unique_ptr<QThread> thread(QThread::create([&pinger]() {
+            pinger.ping(5);
+        }));
+        thread->start();
+        QVERIFY(thread->wait());
+        model.aggregate();
+
+        auto idx = searchFixedIndex(&model, "Pinger");
+        QVERIFY(idx.isValid());
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::SignalColumn).data().toString(), QStringLiteral("pinged()"));
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::TotalColumn).data().toLongLong(), 15);
+        QVERIFY(idx.sibling(idx.row(), SignalProfilerModel::RateColumn).data().toLongLong() > 0);
+
+        pinger.ping(2);
+        Model::unused(&model); // collects what has been counted until then
+        pinger.ping(7);
+        model.aggregate();
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::TotalColumn).data().toLongLong(), 17);
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::RateColumn).data().toLongLong(), 0);
+        QVERIFY(idx.sibling(idx.row(), SignalProfilerModel::PeakRateColumn).data().toLongLong() > 0);
+    }
+
+    void testDynamicMetaObjects()
+    {
+        createProbe();
+
+        SignalProfilerModel model(Probe::instance());
+        Model::used(&model);
+
+        // more than fit into the counter table, destroyed ones are likely to get their address reused
+        for (int i = 0; i < 2000; ++i) {
+            QMetaObjectBuilder builder;
+            builder.setClassName("Pinger_QMLTYPE_" + QByteArray::number(i));
+            builder.setSuperClass(&Pinger::staticMetaObject);
+            std::unique_ptr<QMetaObject, void (*)(void *)> metaObject(builder.toMetaObject(), &std::free);
+            DynamicPinger pinger(metaObject.get());
+            pinger.ping(1);
+        }
+        model.aggregate();
+
+        const auto idx = searchFixedIndex(&model, "Pinger");
+        QVERIFY(idx.isValid());
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::SignalColumn).data().toString(), QStringLiteral("pinged()"));
+        QCOMPARE(idx.sibling(idx.row(), SignalProfilerModel::TotalColumn).data().toLongLong(), 2000);
+        QVERIFY(!searchContainsIndex(&model, "QMLTYPE").isValid());
+        QVERIFY(!searchFixedIndex(&model, "<other>").isValid());
+        Model::unused(&model);
+    }
+};
+
+QTEST_MAIN(SignalProfilerTest)
+
+#include "signalprofilertest.moc"
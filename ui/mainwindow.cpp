@@ -303,6 +303,12 @@ MainWindow::MainWindow(QWidget *parent)
         ui->menu_Diagnostics->menuAction()->setVisible(false);
     }
 
+    auto probeController = ObjectBroker::object<ProbeControllerInterface *>();
+    connect(probeController, &ProbeControllerInterface::objectDiscoveryRunningChanged,
+            this, &MainWindow::updateObjectDiscoveryProgress);
+    connect(probeController, &ProbeControllerInterface::discoveredObjectCountChanged,
+            this, &MainWindow::updateObjectDiscoveryProgress);
+
     connect(this, &MainWindow::targetQuitRequested, &m_stateManager, &UIStateManager::saveState);
 }
 
@@ -560,6 +566,20 @@ void MainWindow::logTransmissionRate(quint64 bytesRead, quint64 bytesWritten)
         tr("Transmission rate: RX %1 Mbps, TX %2 Mbps").arg(transmissionRateRX, 7, 'f', 3).arg(transmissionRateTX, 7, 'f', 3));
 }
 
+void MainWindow::updateObjectDiscoveryProgress()
+{
+    const auto probeController = ObjectBroker::object<ProbeControllerInterface *>();
+    const bool developerModeEnabled = !qEnvironmentVariableIsEmpty("GAMMARAY_DEVELOPERMODE");
+    if (probeController->objectDiscoveryRunning()) {
+        ui->statusBar->show();
+        ui->statusBar->showMessage(tr("Discovering objects: %1 found so far...").arg(probeController->discoveredObjectCount()));
+    } else {
+        ui->statusBar->clearMessage();
+        if (!developerModeEnabled)
+            ui->statusBar->hide();
+    }
+}
+
 void GammaRay::MainWindow::setCodeNavigationIDE(QAction *action)
 {
     QSettings settings;
@@ -79,6 +79,7 @@ private slots:
     void detachProbe();
     void navigateToCode(const QUrl &url, int lineNumber, int columnNumber);
     void logTransmissionRate(quint64 bytesRead, quint64 bytesWritten);
+    void updateObjectDiscoveryProgress();
     void setCodeNavigationIDE(QAction *action);
 
 protected:
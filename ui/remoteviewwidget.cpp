@@ -128,6 +128,9 @@ void RemoteViewWidget::setName(const QString &name)
             this, &RemoteViewWidget::elementsAtReceived);
     connect(m_interface.data(), &RemoteViewInterface::frameUpdated,
             this, &RemoteViewWidget::frameUpdated);
+    m_frameDecoder.reset();
+    m_userScale = -1.0;
+    m_interface->setFrameCodec(RemoteViewInterface::TileDeltaFrames);
     if (isVisible()) {
         m_interface->setViewActive(true);
     }
@@ -228,11 +231,26 @@ void RemoteViewWidget::enableFPS(const bool showFPS)
     m_showFps = showFPS;
 }
 
+void RemoteViewWidget::updateUserScale()
+{
+    if (!m_interface)
+        return;
+
+    // picked colors need to match the source pixels exactly
+    const auto scale = m_interactionMode == ColorPicking ? 0.0 : m_zoom * devicePixelRatioF();
+    if (scale == m_userScale)
+        return;
+    m_userScale = scale;
+    m_interface->sendUserScale(scale);
+}
+
 void RemoteViewWidget::updateUserViewport()
 {
     if (!isVisible())
         return;
 
+    updateUserScale();
+
     const auto userViewport = QRectF(QPointF(std::floor(-m_x / m_zoom), std::floor(-m_y / m_zoom)),
                                      QSizeF(std::ceil(width() / m_zoom) + 1, std::ceil(height() / m_zoom) + 1));
 
@@ -298,6 +316,17 @@ void RemoteViewWidget::elementsAtReceived(const GammaRay::ObjectIds &ids, int be
 
 void RemoteViewWidget::frameUpdated(const RemoteViewFrame &frame)
 {
+    if (frame.isEncoded()) {
+        auto decodedFrame = frame;
+        if (decodedFrame.decodeImage(&m_frameDecoder)) {
+            frameUpdated(decodedFrame);
+        } else {
+            // relative to a frame we didn't see, start over with a key frame
+            m_interface->requestKeyFrame();
+        }
+        return;
+    }
+
     if (!m_frame.isValid()) {
         m_frame = frame;
         if (m_initialZoomDone)
@@ -366,6 +395,7 @@ void RemoteViewWidget::setPickSourceModel(QAbstractItemModel *sourceModel)
 void RemoteViewWidget::reset()
 {
     m_frame = RemoteViewFrame();
+    m_frameDecoder.reset();
     m_hasMeasurement = false;
     update();
     emit frameChanged();
@@ -540,6 +570,7 @@ void RemoteViewWidget::setInteractionMode(RemoteViewWidget::InteractionMode mode
     }
 
     m_interactionMode = mode;
+    updateUserScale();
     foreach (auto action, m_interactionModeActions->actions()) {
         if (action->data() == mode)
             action->setChecked(true);
@@ -18,6 +18,7 @@
 
 #include <common/objectid.h>
 #include <common/remoteviewframe.h>
+#include <common/remoteviewframecodec.h>
 
 #include <QElapsedTimer>
 #include <QPointer>
@@ -198,9 +199,12 @@ private slots:
     void frameUpdated(const GammaRay::RemoteViewFrame &frame);
     void enableFPS(const bool showFPS);
     void updateUserViewport();
+    void updateUserScale();
 
 private:
     RemoteViewFrame m_frame;
+    RemoteViewFrameDecoder m_frameDecoder;
+    double m_userScale = -1.0; // last one sent, -1 if none yet
     QBrush m_activeBackgroundBrush;
     QBrush m_inactiveBackgroundBrush;
     QVector<double> m_zoomLevels;
@@ -42,7 +42,10 @@ MetaTypeBrowserWidget::MetaTypeBrowserWidget(QWidget *parent)
     ui->setupUi(this);
 
     auto mtm = new MetaTypesClientModel(this);
-    mtm->setSourceModel(ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.MetaTypeModel")));
+    auto metaTypeModel = ObjectBroker::model(QStringLiteral("com.kdab.GammaRay.MetaTypeModel"));
+    // everything but the meta object id for the context menu is display only
+    metaTypeModel->setProperty("requestedRoles", QVariant::fromValue(QVector<QVector<int>> { { Qt::DisplayRole, MetaTypeRoles::MetaObjectIdRole }, { Qt::DisplayRole } }));
+    mtm->setSourceModel(metaTypeModel);
 
     ui->metaTypeView->header()->setObjectName("metaTypeViewHeader");
     ui->metaTypeView->setDeferredResizeMode(0, QHeaderView::ResizeToContents);